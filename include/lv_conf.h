@@ -606,17 +606,19 @@
  *===================*/
 
 /* Montserrat fonts with ASCII range and some symbols using bpp = 4
- * https://fonts.google.com/specimen/Montserrat */
+ * https://fonts.google.com/specimen/Montserrat
+ * 16, 24, 26 and 48 are used as subsets with only the characters the weather screen
+ * shows (weather_font_<size>, generated by resources/compile_fonts.py from these sources) */
 #define LV_FONT_MONTSERRAT_8  0
 #define LV_FONT_MONTSERRAT_10 0
 #define LV_FONT_MONTSERRAT_12 0
 #define LV_FONT_MONTSERRAT_14 1
-#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_MONTSERRAT_16 0
 #define LV_FONT_MONTSERRAT_18 0
 #define LV_FONT_MONTSERRAT_20 0
 #define LV_FONT_MONTSERRAT_22 0
-#define LV_FONT_MONTSERRAT_24 1
-#define LV_FONT_MONTSERRAT_26 1
+#define LV_FONT_MONTSERRAT_24 0
+#define LV_FONT_MONTSERRAT_26 0
 #define LV_FONT_MONTSERRAT_28 0
 #define LV_FONT_MONTSERRAT_30 0
 #define LV_FONT_MONTSERRAT_32 0
@@ -627,7 +629,7 @@
 #define LV_FONT_MONTSERRAT_42 0
 #define LV_FONT_MONTSERRAT_44 0
 #define LV_FONT_MONTSERRAT_46 0
-#define LV_FONT_MONTSERRAT_48 1
+#define LV_FONT_MONTSERRAT_48 0
 
 /* Demonstrate special features */
 #define LV_FONT_MONTSERRAT_28_COMPRESSED    0  /**< bpp = 3 */
@@ -962,8 +964,9 @@
 /** GStreamer library */
 #define LV_USE_GSTREAMER 0
 
-/** Decode bin images to RAM */
-#define LV_BIN_DECODER_RAM_LOAD 0
+/** Decode bin images to RAM
+ *  (ICON_SOURCE_BIN: a 64x64 RGB565A8 icon is read from LittleFS in one go) */
+#define LV_BIN_DECODER_RAM_LOAD 1
 
 /** RLE decompress library */
 #define LV_USE_RLE 0
@@ -1044,7 +1047,7 @@
 /* Documentation for several of the below items can be found here: https://docs.lvgl.io/master/details/auxiliary-modules/index.html . */
 
 /** 1: Enable API to take snapshot for object */
-#define LV_USE_SNAPSHOT 0
+#define LV_USE_SNAPSHOT 1
 
 /** 1: Enable system monitor component */
 #define LV_USE_SYSMON   0
@@ -1078,11 +1081,16 @@
     #endif
 #endif /*LV_USE_SYSMON*/
 
-/** 1: Enable runtime performance profiler */
-#define LV_USE_PROFILER 0
+/** 1: Enable runtime performance profiler
+ *  Follows TRACE_ENABLED (build flag) and feeds the project's trace ring, see include/trace.h */
+#if defined(TRACE_ENABLED) && TRACE_ENABLED
+    #define LV_USE_PROFILER 1
+#else
+    #define LV_USE_PROFILER 0
+#endif
 #if LV_USE_PROFILER
     /** 1: Enable the built-in profiler */
-    #define LV_USE_PROFILER_BUILTIN 1
+    #define LV_USE_PROFILER_BUILTIN 0
     #if LV_USE_PROFILER_BUILTIN
         /** Default profiler trace buffer size */
         #define LV_PROFILER_BUILTIN_BUF_SIZE (16 * 1024)     /**< [bytes] */
@@ -1091,19 +1099,22 @@
     #endif
 
     /** Header to include for profiler */
-    #define LV_PROFILER_INCLUDE "lvgl/src/misc/lv_profiler_builtin.h"
+    #define LV_PROFILER_INCLUDE "trace.h"
 
     /** Profiler start point function */
-    #define LV_PROFILER_BEGIN    LV_PROFILER_BUILTIN_BEGIN
+    #define LV_PROFILER_BEGIN    trace_begin(__func__)
 
     /** Profiler end point function */
-    #define LV_PROFILER_END      LV_PROFILER_BUILTIN_END
+    #define LV_PROFILER_END      trace_end(__func__)
 
     /** Profiler start point function with custom tag */
-    #define LV_PROFILER_BEGIN_TAG LV_PROFILER_BUILTIN_BEGIN_TAG
+    #define LV_PROFILER_BEGIN_TAG(tag) trace_begin(tag)
 
     /** Profiler end point function with custom tag */
-    #define LV_PROFILER_END_TAG   LV_PROFILER_BUILTIN_END_TAG
+    #define LV_PROFILER_END_TAG(tag)   trace_end(tag)
+
+    /* Per-draw-task, per-glyph and per-event spans would flood the ring:
+     * keep the frame-level ones */
 
     /*Enable layout profiler*/
     #define LV_PROFILER_LAYOUT 1
@@ -1112,16 +1123,16 @@
     #define LV_PROFILER_REFR 1
 
     /*Enable draw profiler*/
-    #define LV_PROFILER_DRAW 1
+    #define LV_PROFILER_DRAW 0
 
     /*Enable indev profiler*/
-    #define LV_PROFILER_INDEV 1
+    #define LV_PROFILER_INDEV 0
 
     /*Enable decoder profiler*/
     #define LV_PROFILER_DECODER 1
 
     /*Enable font profiler*/
-    #define LV_PROFILER_FONT 1
+    #define LV_PROFILER_FONT 0
 
     /*Enable fs profiler*/
     #define LV_PROFILER_FS 1
@@ -1133,10 +1144,10 @@
     #define LV_PROFILER_TIMER 1
 
     /*Enable cache profiler*/
-    #define LV_PROFILER_CACHE 1
+    #define LV_PROFILER_CACHE 0
 
     /*Enable event profiler*/
-    #define LV_PROFILER_EVENT 1
+    #define LV_PROFILER_EVENT 0
 #endif
 
 /** 1: Enable Monkey test */
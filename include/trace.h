@@ -0,0 +1,81 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Frame-level trace profiler
+// Begin/end spans are timestamped (esp_timer_get_time() on the board) and
+// written into a fixed-size lock-free ring that keeps the newest events. The
+// ring can be dumped as Chrome trace JSON (chrome://tracing, Perfetto).
+// LVGL's profiler hooks (LV_PROFILER_*) feed the same ring, see lv_conf.h.
+//
+// Enable with -DTRACE_ENABLED=1 in build_flags (not config.h): LVGL is
+// compiled separately and has to see the same setting.
+// This header is also included from LVGL's C sources.
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+// Number of begin/end events kept (16 bytes each)
+#define TRACE_RING_SIZE 1024
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // `name` must stay valid until the ring is dumped (string literals, __func__)
+  void trace_begin(const char *name);
+  void trace_end(const char *name);
+
+#ifdef __cplusplus
+}
+
+// Closes the span when leaving the scope (early returns included)
+class TraceScope
+{
+public:
+  explicit TraceScope(const char *name) : name(name) { trace_begin(name); }
+  ~TraceScope() { trace_end(name); }
+
+private:
+  const char *name;
+};
+
+#if TRACE_ENABLED
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_BEGIN(name) trace_begin(name)
+#define TRACE_END(name) trace_end(name)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#endif
+
+// Receives the dump text piece by piece
+typedef void (*TraceWriter)(const char *text, void *ctx);
+
+// Write the kept events as Chrome trace JSON, returns the number of events.
+// otherData.open_spans holds, per core, the spans already open at its first
+// kept event (begun before an overwrite or trace_reset()).
+uint32_t trace_dump_chrome(TraceWriter writer, void *ctx);
+
+// Dump to Serial between "=== TRACE BEGIN ===" / "=== TRACE END ===" lines
+// (resources/trace_to_chrome.py extracts it from a monitor log)
+void trace_dump_serial();
+
+// Check that the kept spans nest properly per core. Spans still open, and the
+// ends of spans open before a core's first kept event, are not errors; any
+// other end without its begin is. Returns the error count.
+uint32_t trace_check_nesting(uint32_t *spans);
+
+// Events recorded since trace_reset(), including overwritten ones
+uint32_t trace_recorded();
+void trace_reset();
+
+#endif // __cplusplus
+
+#endif // TRACE_H
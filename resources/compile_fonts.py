@@ -0,0 +1,463 @@
+#!/usr/bin/env python3
+"""
+Subset LVGL's Montserrat fonts to the characters the weather screen shows
+
+WeatherUI uses Montserrat 16, 24, 26 and 48 for a few labels only: numbers
+(temperature, range, humidity, PM2.5) and the titles (condition names,
+refresh time, symbols). This script copies just those glyphs, with their
+kerning, out of LVGL's own font sources into
+
+  src/ui/generated/weather_fonts.h            weather_font_<size> declarations
+  src/ui/generated/weather_font_<size>.c      lv_font_t with the subset glyphs
+
+and include/lv_conf.h leaves the full fonts out (LV_FONT_MONTSERRAT_<size> 0).
+Montserrat 14 stays complete, it is LVGL's default font.
+
+The number fonts get a fixed set (SUBSETS). The text font gets every character
+of the string literals and LV_SYMBOL_* names in the UI sources, of the
+condition names in resources/weather_conditions.csv and of the names
+WeatherIcons::getConditionDisplayName returns otherwise, and the digits.
+Labels showing a character outside their subset draw nothing for it; the
+native runner checks every string the UI produces.
+
+Runs as a PlatformIO pre-build script (extra_scripts) after the libraries are
+installed, and regenerates when an input is newer than the outputs. Files
+whose content did not change are not rewritten.
+
+Usage:
+    python resources/compile_fonts.py                    # LVGL from .pio/libdeps/*/lvgl
+    python resources/compile_fonts.py --lvgl PATH        # LVGL source tree
+    python resources/compile_fonts.py --force
+"""
+
+import argparse
+import csv
+import re
+import sys
+from pathlib import Path
+
+DIGITS = "0123456789"
+
+# Montserrat size -> characters; None = the UI text (ui_text())
+SUBSETS = {
+    48: DIGITS + "-°",    # temperature_label
+    26: DIGITS + "-",     # AQI and humidity values (vertical)
+    24: DIGITS + " -%°",  # temperature range, AQI and humidity values (horizontal)
+    16: None,             # titles, condition names, refresh time (vertical), symbols
+}
+
+UI_SOURCES = [Path("src/ui/ui_weather.cpp"), Path("src/ui/label_icons.h")]
+ICONS_SOURCE = Path("src/ui/weather_icons.cpp")  # getConditionDisplayName
+CONDITIONS_CSV = Path("resources/weather_conditions.csv")
+OUT_DIR = Path("src/ui/generated")
+OUT_H = OUT_DIR / "weather_fonts.h"
+
+GENERATED_NOTE = "Generated by resources/compile_fonts.py - do not edit"
+
+# sizeof(lv_font_fmt_txt_glyph_dsc_t) with LV_FONT_FMT_TXT_LARGE 0
+GLYPH_DSC_BYTES = 8
+
+# lv_font_fmt_txt_cmap_type_t
+CMAP_FORMAT0_FULL = "LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL"
+CMAP_SPARSE_FULL = "LV_FONT_FMT_TXT_CMAP_SPARSE_FULL"
+CMAP_FORMAT0_TINY = "LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY"
+CMAP_SPARSE_TINY = "LV_FONT_FMT_TXT_CMAP_SPARSE_TINY"
+
+# Fields of the font descriptors written by this script rather than copied
+OWN_DSC_FIELDS = {"glyph_bitmap", "glyph_dsc", "cmaps", "kern_dsc", "cmap_num", "kern_classes", "cache"}
+OWN_FONT_FIELDS = {"dsc", "fallback", "user_data"}
+
+
+def font_path(size):
+    return OUT_DIR / f"weather_font_{size}.c"
+
+
+def find_lvgl(hint=None):
+    """LVGL source tree: `hint`, else the first .pio/libdeps/<env>/lvgl"""
+    candidates = [Path(hint)] if hint else sorted(Path(".pio/libdeps").glob("*/lvgl"))
+    for path in candidates:
+        if (path / "src").is_dir():
+            return path
+    return None
+
+
+def find_source(lvgl, name):
+    found = sorted(lvgl.glob(f"src/**/{name}"))
+    if not found:
+        raise ValueError(f"{name} not found in {lvgl.as_posix()}")
+    return found[0]
+
+
+def strip_comments(text):
+    return re.sub(r"/\*.*?\*/|//[^\n]*", "", text, flags=re.S)
+
+
+def c_string(body):
+    """Characters of a C string literal body (UTF-8, with \\x, \\n, ... escapes)"""
+    raw = body.encode("utf-8")
+    data = bytearray()
+    pos = 0
+    while pos < len(raw):
+        if raw[pos] == ord("\\") and pos + 1 < len(raw):
+            hex_digits = re.match(rb"x([0-9A-Fa-f]{1,2})", raw[pos + 1:])
+            if hex_digits:
+                data.append(int(hex_digits.group(1), 16))
+                pos += 1 + len(hex_digits.group(0))
+                continue
+            data += {ord("n"): b"\n", ord("t"): b"\t", ord("0"): b"\0"}.get(raw[pos + 1], raw[pos + 1:pos + 2])
+            pos += 2
+            continue
+        data.append(raw[pos])
+        pos += 1
+    return data.decode("utf-8", errors="ignore")
+
+
+def read_symbols(lvgl):
+    """LV_SYMBOL_* name -> character, from lv_symbol_def.h"""
+    text = find_source(lvgl, "lv_symbol_def.h").read_text(encoding="utf-8")
+    return {name: c_string(value)
+            for name, value in re.findall(r"#define\s+(LV_SYMBOL_\w+)\s+\"((?:\\x[0-9A-Fa-f]{2})+)\"", text)}
+
+
+def literal_chars(text, symbols):
+    """Characters of the string literals and LV_SYMBOL_* names in C++ source,
+    leaving out includes, log and trace messages and static_assert"""
+    text = strip_comments(text)
+    text = re.sub(r"^\s*#\s*include[^\n]*", "", text, flags=re.M)
+    text = re.sub(r"\b(?:\w*LOG\w*|TRACE\w*|static_assert)\s*\((?:[^;\"]|\"(?:[^\"\\]|\\.)*\")*\);", "", text)
+    chars = set()
+    for body in re.findall(r"\"((?:[^\"\\\n]|\\.)*)\"", text):
+        chars.update(c_string(body))
+    for name in re.findall(r"\bLV_SYMBOL_\w+\b", text):
+        if name in symbols:
+            chars.update(symbols[name])
+    return chars
+
+
+def ui_text(symbols):
+    """Every character the text labels can show"""
+    chars = set(DIGITS)
+    for path in UI_SOURCES:
+        chars |= literal_chars(path.read_text(encoding="utf-8"), symbols)
+
+    with CONDITIONS_CSV.open(newline="", encoding="utf-8") as f:
+        for row in csv.DictReader(f):
+            chars.update(row["description"])
+
+    match = re.search(r"WeatherIcons::getConditionDisplayName\(.*?\n\}", ICONS_SOURCE.read_text(encoding="utf-8"),
+                      flags=re.S)
+    if match is None:
+        raise ValueError(f"getConditionDisplayName not found in {ICONS_SOURCE.as_posix()}")
+    chars |= literal_chars(match.group(0), symbols)
+    return "".join(sorted(c for c in chars if ord(c) >= 0x20))
+
+
+def c_block(text, pattern):
+    """Initializer body of the declaration matching `pattern`, None if absent"""
+    match = re.search(pattern + r"\s*=\s*\{", text)
+    if match is None:
+        return None
+    depth = 1
+    pos = match.end()
+    while depth:
+        if text[pos] == "{":
+            depth += 1
+        elif text[pos] == "}":
+            depth -= 1
+        pos += 1
+    return text[match.end():pos - 1]
+
+
+def c_ints(body):
+    return [int(v, 0) for v in re.split(r"[,\s]+", strip_comments(body)) if v]
+
+
+def c_fields(body):
+    """.name = value pairs of a struct initializer, preprocessor lines dropped"""
+    body = "\n".join(line for line in strip_comments(body).splitlines() if not line.strip().startswith("#"))
+    return dict(re.findall(r"\.(\w+)\s*=\s*([^,\n]+?)\s*(?:,|\n|$)", body))
+
+
+class Font:
+    """Parsed lv_font_fmt_txt source as written by lv_font_conv"""
+
+    def __init__(self, path, size):
+        # Only the first branch of #if/#else (LVGL 8+ declarations)
+        text = re.sub(r"^[ \t]*#[ \t]*else\b.*?^[ \t]*#[ \t]*endif[^\n]*", "", path.read_text(encoding="utf-8"),
+                      flags=re.M | re.S)
+        self.path = path
+        self.bitmap = c_ints(c_block(text, r"glyph_bitmap\[\]"))
+        self.glyphs = [{k: int(v, 0) for k, v in re.findall(r"\.(\w+)\s*=\s*(-?\w+)", entry)}
+                       for entry in re.findall(r"\{([^{}]*)\}", strip_comments(c_block(text, r"glyph_dsc\[\]")))]
+        self.dsc = c_fields(c_block(text, r"font_dsc"))
+        self.font = c_fields(c_block(text, rf"lv_font_montserrat_{size}"))
+        if int(self.dsc.get("bitmap_format", "0"), 0) != 0:
+            raise ValueError(f"{path.name}: compressed bitmaps are not supported")
+
+        # Codepoint -> glyph id
+        self.gids = {}
+        for entry in re.findall(r"\{([^{}]*)\}", strip_comments(c_block(text, r"cmaps\[\]"))):
+            cmap = c_fields(entry)
+            start = int(cmap["range_start"], 0)
+            first = int(cmap["glyph_id_start"], 0)
+            kind = cmap["type"]
+            ofs = self.array(text, cmap["glyph_id_ofs_list"])
+            if kind in (CMAP_FORMAT0_TINY, CMAP_FORMAT0_FULL):
+                for i in range(int(cmap["range_length"], 0)):
+                    self.gids[start + i] = first + (ofs[i] if kind == CMAP_FORMAT0_FULL else i)
+            else:
+                for i, delta in enumerate(self.array(text, cmap["unicode_list"])):
+                    self.gids[start + delta] = first + (ofs[i] if kind == CMAP_SPARSE_FULL else i)
+
+        # Kerning classes (LVGL's fonts are converted with --force-fast-kern-format):
+        # left and right class per glyph, value per class pair
+        self.kern = None
+        if re.search(r"lv_font_fmt_txt_kern_pair_t\s+kern_pairs", text):
+            raise ValueError(f"{path.name}: kerning pairs are not supported")
+        classes = c_block(text, r"lv_font_fmt_txt_kern_classes_t\s+kern_classes")
+        if classes is not None:
+            fields = c_fields(classes)
+            self.kern = (self.array(text, fields["left_class_mapping"]), self.array(text, fields["right_class_mapping"]),
+                         self.array(text, fields["class_pair_values"]), int(fields["right_class_cnt"], 0))
+
+    @staticmethod
+    def array(text, name):
+        if name == "NULL":
+            return []
+        return c_ints(c_block(text, rf"\b{name}\[\]"))
+
+    def glyph_bytes(self, gid):
+        """The glyph's bitmap: up to the next glyph's bitmap"""
+        start = self.glyphs[gid]["bitmap_index"]
+        ends = [g["bitmap_index"] for g in self.glyphs[gid + 1:] if g["bitmap_index"] > start]
+        return self.bitmap[start:ends[0] if ends else len(self.bitmap)]
+
+    def size(self):
+        """Bytes of glyph data, descriptors, character maps and kerning"""
+        total = len(self.bitmap) + GLYPH_DSC_BYTES * len(self.glyphs) + 4 * len(self.gids)
+        if self.kern:
+            total += len(self.kern[0]) + len(self.kern[1]) + len(self.kern[2])
+        return total
+
+
+def subset(font, size, chars):
+    """C source of `font` reduced to `chars` and its byte count"""
+    missing = [c for c in chars if ord(c) not in font.gids]
+    if missing:
+        raise ValueError(f"{font.path.name}: no glyph for {', '.join(repr(c) for c in missing)}")
+
+    # New glyph ids in the old order (id 0 stays reserved), so the codepoint
+    # order and the kerning pair order are kept
+    kept = sorted({font.gids[ord(c)] for c in chars})
+    new_gid = {old: new for new, old in enumerate(kept, 1)}
+    codepoints = sorted(ord(c) for c in chars)
+    codepoint_of = {new_gid[font.gids[cp]]: cp for cp in codepoints}
+
+    bitmap = []
+    glyphs = [dict(font.glyphs[0], bitmap_index=0)]
+    for old in kept:
+        glyphs.append(dict(font.glyphs[old], bitmap_index=len(bitmap)))
+        bitmap += font.glyph_bytes(old)
+
+    name = f"weather_font_{size}"
+    out = [f"// {GENERATED_NOTE}",
+           f"// {name}: {len(kept)} glyphs of {font.path.name}",
+           f"// {''.join(chars)!r}",
+           "#include <lvgl.h>",
+           "",
+           "#ifndef LV_ATTRIBUTE_LARGE_CONST",
+           "#define LV_ATTRIBUTE_LARGE_CONST",
+           "#endif",
+           "",
+           "static LV_ATTRIBUTE_LARGE_CONST const uint8_t glyph_bitmap[] = {"]
+    out += ["    " + ", ".join(f"0x{b:02x}" for b in bitmap[i:i + 16]) + "," for i in range(0, len(bitmap), 16)]
+    out += ["};",
+            "",
+            "static const lv_font_fmt_txt_glyph_dsc_t glyph_dsc[] = {"]
+    for gid, g in enumerate(glyphs):
+        note = f" // U+{codepoint_of[gid]:04X}" if gid else " // id 0 reserved"
+        out.append(f"    {{.bitmap_index = {g['bitmap_index']}, .adv_w = {g['adv_w']}, .box_w = {g['box_w']}, "
+                   f".box_h = {g['box_h']}, .ofs_x = {g['ofs_x']}, .ofs_y = {g['ofs_y']}}},{note}")
+    out += ["};", ""]
+
+    # One sparse map over all characters, ids by list position if they follow
+    # the codepoint order
+    start = codepoints[0]
+    ids = [new_gid[font.gids[cp]] for cp in codepoints]
+    tiny = ids == list(range(1, len(ids) + 1))
+    out += ["static const uint16_t unicode_list[] = {",
+            "    " + ", ".join(f"0x{cp - start:x}" for cp in codepoints) + ",",
+            "};",
+            ""]
+    if not tiny:
+        out += ["static const uint16_t glyph_id_ofs_list[] = {",
+                "    " + ", ".join(str(gid - 1) for gid in ids) + ",",
+                "};",
+                ""]
+    out += ["static const lv_font_fmt_txt_cmap_t cmaps[] = {",
+            f"    {{.range_start = {start}, .range_length = {codepoints[-1] - start + 1}, .glyph_id_start = 1,",
+            f"     .unicode_list = unicode_list, .glyph_id_ofs_list = {'NULL' if tiny else 'glyph_id_ofs_list'}, "
+            f".list_length = {len(codepoints)}, .type = {CMAP_SPARSE_TINY if tiny else CMAP_SPARSE_FULL}}},",
+            "};",
+            ""]
+    size_bytes = len(bitmap) + GLYPH_DSC_BYTES * len(glyphs) + (2 if tiny else 4) * len(codepoints)
+
+    kern_dsc = "NULL"
+    kern_classes = 0
+    if font.kern:
+        left, right, values, right_cnt = font.kern
+        # Only the classes of the kept glyphs, renumbered from 1
+        used_left = sorted({left[old] for old in kept} - {0})
+        used_right = sorted({right[old] for old in kept} - {0})
+        new_left = {c: i for i, c in enumerate(used_left, 1)}
+        new_right = {c: i for i, c in enumerate(used_right, 1)}
+        pair_values = [values[(l - 1) * right_cnt + (r - 1)] for l in used_left for r in used_right]
+        if any(pair_values):
+            out += ["static const uint8_t kern_left_class_mapping[] = {",
+                    "    " + ", ".join(["0"] + [str(new_left.get(left[old], 0)) for old in kept]) + ",",
+                    "};",
+                    "",
+                    "static const uint8_t kern_right_class_mapping[] = {",
+                    "    " + ", ".join(["0"] + [str(new_right.get(right[old], 0)) for old in kept]) + ",",
+                    "};",
+                    "",
+                    "static const int8_t kern_class_values[] = {",
+                    "    " + ", ".join(str(v) for v in pair_values) + ",",
+                    "};",
+                    "",
+                    "static const lv_font_fmt_txt_kern_classes_t kern_classes = {",
+                    "    .class_pair_values = kern_class_values,",
+                    "    .left_class_mapping = kern_left_class_mapping,",
+                    "    .right_class_mapping = kern_right_class_mapping,",
+                    f"    .left_class_cnt = {len(used_left)},",
+                    f"    .right_class_cnt = {len(used_right)},",
+                    "};",
+                    ""]
+            kern_dsc = "&kern_classes"
+            kern_classes = 1
+            size_bytes += 2 * len(glyphs) + len(pair_values)
+
+    out += ["static const lv_font_fmt_txt_dsc_t font_dsc = {",
+            "    .glyph_bitmap = glyph_bitmap,",
+            "    .glyph_dsc = glyph_dsc,",
+            "    .cmaps = cmaps,",
+            f"    .kern_dsc = {kern_dsc},",
+            "    .cmap_num = 1,",
+            f"    .kern_classes = {kern_classes},"]
+    out += [f"    .{k} = {v}," for k, v in font.dsc.items() if k not in OWN_DSC_FIELDS]
+    out += ["};",
+            "",
+            f"const lv_font_t {name} = {{"]
+    out += [f"    .{k} = {v}," for k, v in font.font.items() if k not in OWN_FONT_FIELDS]
+    out += ["    .dsc = &font_dsc,",
+            "    .fallback = NULL,",
+            "    .user_data = NULL,",
+            "};",
+            ""]
+    return "\n".join(out), size_bytes
+
+
+def write_if_changed(path, text):
+    if path.exists() and path.read_text(encoding="utf-8") == text:
+        return
+    path.write_text(text, encoding="utf-8")
+
+
+def write_header(sizes, full, saved):
+    h = [f"// {GENERATED_NOTE}",
+         "#ifndef WEATHER_FONTS_H",
+         "#define WEATHER_FONTS_H",
+         "",
+         "#include <lvgl.h>",
+         "",
+         "// Flash of the full fonts and of the subsets (glyphs, maps, kerning)",
+         f"#define WEATHER_FONTS_FULL_BYTES {full}",
+         f"#define WEATHER_FONTS_SUBSET_BYTES {full - saved}",
+         "",
+         "#ifdef __cplusplus",
+         'extern "C"',
+         "{",
+         "#endif",
+         ""]
+    h += [f"  extern const lv_font_t weather_font_{size};" for size in sizes]
+    h += ["",
+          "#ifdef __cplusplus",
+          "}",
+          "#endif",
+          "",
+          "#endif // WEATHER_FONTS_H",
+          ""]
+    write_if_changed(OUT_H, "\n".join(h))
+
+
+def compile_fonts(lvgl_hint=None, force=False):
+    lvgl = find_lvgl(lvgl_hint)
+    if lvgl is None:
+        print("✗ LVGL sources not found (.pio/libdeps/<env>/lvgl; install the libraries or pass --lvgl)")
+        return 1
+
+    script = Path("resources/compile_fonts.py")
+    try:
+        sources = {size: find_source(lvgl, f"lv_font_montserrat_{size}.c") for size in SUBSETS}
+    except ValueError as e:
+        print(f"✗ {e}")
+        return 1
+    inputs = list(sources.values()) + UI_SOURCES + [ICONS_SOURCE, CONDITIONS_CSV] + \
+        ([script] if script.exists() else [])
+    outputs = [OUT_H] + [font_path(size) for size in SUBSETS]
+    if not force and all(p.exists() for p in outputs) and \
+            max(p.stat().st_mtime for p in inputs) <= min(p.stat().st_mtime for p in outputs):
+        return 0
+
+    OUT_DIR.mkdir(parents=True, exist_ok=True)
+    full_total = 0
+    saved_total = 0
+    try:
+        symbols = read_symbols(lvgl)
+        text = ui_text(symbols)
+        for size, chars in SUBSETS.items():
+            font = Font(sources[size], size)
+            source, subset_bytes = subset(font, size, chars if chars is not None else text)
+            write_if_changed(font_path(size), source)
+            full = font.size()
+            full_total += full
+            saved_total += full - subset_bytes
+            print(f"✓ weather_font_{size}: {len(chars if chars is not None else text)} glyphs, "
+                  f"{subset_bytes} B (Montserrat {size}: {len(font.glyphs) - 1} glyphs, {full} B)")
+    except (OSError, ValueError, KeyError, IndexError, SyntaxError) as e:
+        print(f"✗ Fonts: {e}")
+        return 1
+
+    write_header(SUBSETS, full_total, saved_total)
+    # Keep the outputs newer than the inputs even when unchanged
+    for path in outputs:
+        path.touch()
+    print(f"✓ Fonts: {saved_total} B of flash saved ({full_total} B -> {full_total - saved_total} B)")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--lvgl", help="LVGL source tree (default: .pio/libdeps/<env>/lvgl)")
+    parser.add_argument("--force", action="store_true", help="Regenerate even if up to date")
+    args = parser.parse_args()
+    return compile_fonts(args.lvgl, args.force)
+
+
+try:
+    Import("env")  # noqa: F821 - defined when run by PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    import os
+
+    os.chdir(env.subst("$PROJECT_DIR"))
+    libdeps = Path(env.subst("$PROJECT_LIBDEPS_DIR")) / env.subst("$PIOENV") / "lvgl"
+    if compile_fonts(str(libdeps) if libdeps.exists() else None) != 0:
+        env.Exit(1)
+elif __name__ == "__main__":
+    import os
+
+    os.chdir(Path(__file__).resolve().parent.parent)
+    sys.exit(main())
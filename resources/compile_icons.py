@@ -0,0 +1,829 @@
+#!/usr/bin/env python3
+"""
+Compile the weather icons into native LVGL images
+
+Reads data/icons/*.png (or renders resources/icons/*.svg with --svg) and
+writes RGB565A8 images that LVGL draws without decoding. The compiled icons
+come in sets of SET_SIZES pixels: data/icons/*.png is the 64 px set, the
+others are rasterized from resources/icons/*.svg.
+
+  src/ui/generated/weather_icon_images.c/.h   lv_image_dsc_t arrays in flash, and
+                                              opaque RGB565 copies composited on
+                                              the card color (MAIN_CARD_BG_COLOR
+                                              in src/ui/ui_weather.cpp); the 64 px
+                                              set, the ICON_SIZE_* sets of the
+                                              layouts in the same file, and every
+                                              set with WEATHER_ICON_ALL_SETS
+  src/ui/generated/weather_conditions.inc     condition map rows, from
+                                              resources/weather_conditions.csv
+  data/icons.atlas                            all icons in one file with an
+                                              offset index (PNG or .bin entries)
+  .pio/assets/assets.bin                      .bin atlas for the "assets" flash
+                                              partition (partitions.csv), flashed
+                                              by `pio run --target upload`
+  data/icons/*.qoi                            QOI images for LittleFS (lossless,
+                                              decoded by src/lvgl/lvgl_qoi.cpp)
+  data/icons/*.bin (--bin)                    LVGL binary images for LittleFS
+
+Runs as a PlatformIO pre-build script (extra_scripts) and regenerates only
+when an input is newer than the outputs. Needs nothing beyond the Python
+standard library for the 8-bit RGB/RGBA PNGs in data/icons and the SVGs
+(single-color filled paths, M/L/H/V/C/Z); Pillow is used when installed.
+--svg needs cairosvg or an inkscape executable on PATH.
+
+Usage:
+    python resources/compile_icons.py            # C arrays + condition map
+    python resources/compile_icons.py --bin      # also data/icons/*.bin
+    python resources/compile_icons.py --svg      # re-render PNGs from SVG first
+    python resources/compile_icons.py --atlas-format bin   # undecoded atlas entries
+    python resources/compile_icons.py --atlas-format qoi   # QOI atlas entries
+    python resources/compile_icons.py --png-window 10      # recompress PNGs, 1 KB window
+
+Atlas layout (little-endian, see src/lvgl/lvgl_fs_atlas.h):
+    header  16 B   magic "WIA1", u16 version, u16 count, u32 index offset, u32 data offset
+    index   16 B   per icon: u32 offset, u32 size, u8 format (0 PNG, 1 LVGL .bin, 2 QOI),
+                   u8 reserved, u16 w, u16 h, u16 reserved
+    data           entries in index order, 4-byte aligned
+Icon i is the i-th name of the sorted icon list (WEATHER_ICON_INDEX_* in the
+generated header). The files on LittleFS and the atlases hold the 64 px set;
+a set of each size would take another 256 KB of 4 KB LittleFS blocks.
+
+--png-window rewrites the IDAT data of data/icons/*.png with a smaller deflate
+window (2^BITS bytes, stored in the zlib header). The pixels do not change;
+the streaming decoder (src/lvgl/lvgl_png_stream.cpp) allocates only that
+window instead of up to 32 KB.
+
+The opaque icons are blended the way LVGL blends RGB565A8 onto an RGB565
+screen (lv_color_16_16_mix), so they draw the same pixels as the alpha icons
+on the card. The build compares MAIN_CARD_BG_COLOR with the color in the
+generated header, so changing it regenerates them; other edits to the UI file
+do not. The same goes for the layout icon sizes.
+"""
+
+import argparse
+import csv
+import re
+import xml.etree.ElementTree as ET
+import shutil
+import struct
+import subprocess
+import sys
+import zlib
+from pathlib import Path
+
+SIZE = 64  # data/icons/*.png, the atlases and the default set
+SET_SIZES = (32, 48, 64, 96)
+
+# Built-in SVG rasterizer: coverage samples per pixel row, lines per curve
+SVG_SUBROWS = 16
+SVG_CURVE_STEPS = 12
+# Largest mean alpha difference of an icon rasterized at SIZE from its PNG,
+# so the rasterized sets draw like the one from the PNGs
+SVG_MAX_ALPHA_ERROR = 1.0
+SVG_NS = "{http://www.w3.org/2000/svg}"
+
+# LVGL 9 image header (lv_image_header_t)
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_COLOR_FORMAT_RGB565A8 = 0x14
+
+PNG_DIR = Path("data/icons")
+SVG_DIR = Path("resources/icons")
+CONDITIONS_CSV = Path("resources/weather_conditions.csv")
+UI_SOURCE = Path("src/ui/ui_weather.cpp")  # MAIN_CARD_BG_COLOR, under the icon; ICON_SIZE_*
+OUT_DIR = Path("src/ui/generated")
+OUT_C = OUT_DIR / "weather_icon_images.c"
+OUT_H = OUT_DIR / "weather_icon_images.h"
+OUT_MAP = OUT_DIR / "weather_conditions.inc"
+OUT_ATLAS = Path("data/icons.atlas")
+OUT_ASSETS = Path(".pio/assets/assets.bin")
+PARTITIONS_CSV = Path("partitions.csv")
+ASSETS_PARTITION = "assets"
+
+ATLAS_MAGIC = b"WIA1"
+ATLAS_VERSION = 1
+ATLAS_FORMATS = {"png": 0, "bin": 1, "qoi": 2}
+
+# LittleFS block size on the board, for the footprint estimate
+FS_BLOCK = 4096
+
+GENERATED_NOTE = "Generated by resources/compile_icons.py - do not edit"
+
+
+def read_png_stdlib(path):
+    """Decode an 8-bit, non-interlaced RGB or RGBA PNG into (w, h, RGBA bytes)"""
+    data = path.read_bytes()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG file")
+
+    pos = 8
+    idat = b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            w, h, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"IDAT":
+            idat += chunk
+        elif kind == b"IEND":
+            break
+
+    if depth != 8 or color not in (2, 6) or interlace != 0:
+        raise ValueError("only 8-bit non-interlaced RGB/RGBA is supported without Pillow")
+
+    bpp = 4 if color == 6 else 3
+    stride = w * bpp
+    raw = zlib.decompress(idat)
+    rows = []
+    prev = bytearray(stride)
+    for y in range(h):
+        start = y * (stride + 1)
+        ftype = raw[start]
+        row = bytearray(raw[start + 1:start + 1 + stride])
+        for x in range(stride):
+            a = row[x - bpp] if x >= bpp else 0
+            b = prev[x]
+            c = prev[x - bpp] if x >= bpp else 0
+            if ftype == 1:
+                row[x] = (row[x] + a) & 0xFF
+            elif ftype == 2:
+                row[x] = (row[x] + b) & 0xFF
+            elif ftype == 3:
+                row[x] = (row[x] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                row[x] = (row[x] + pred) & 0xFF
+        rows.append(row)
+        prev = row
+
+    rgba = bytearray()
+    for row in rows:
+        if bpp == 4:
+            rgba += row
+        else:
+            for x in range(0, stride, 3):
+                rgba += row[x:x + 3] + b"\xff"
+    return w, h, bytes(rgba)
+
+
+def repack_png(path, window_bits):
+    """Recompress the IDAT data of `path` with a 2^window_bits deflate window"""
+    data = path.read_bytes()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG file")
+
+    chunks = []
+    idat = b""
+    pos = 8
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IDAT":
+            if not idat:
+                chunks.append((b"IDAT", None))
+            idat += chunk
+        else:
+            chunks.append((kind, chunk))
+
+    packer = zlib.compressobj(9, zlib.DEFLATED, window_bits)
+    packed = packer.compress(zlib.decompress(idat)) + packer.flush()
+    out = bytearray(data[:8])
+    for kind, chunk in chunks:
+        if chunk is None:
+            chunk = packed
+        out += struct.pack(">I", len(chunk)) + kind + chunk
+        out += struct.pack(">I", zlib.crc32(kind + chunk) & 0xFFFFFFFF)
+    path.write_bytes(bytes(out))
+    return len(data), len(out)
+
+
+def read_png(path):
+    """(w, h, RGBA bytes), resized to SIZE x SIZE if needed"""
+    try:
+        from PIL import Image
+    except ImportError:
+        w, h, rgba = read_png_stdlib(path)
+        if (w, h) != (SIZE, SIZE):
+            raise ValueError(f"{w}x{h}, resizing to {SIZE}x{SIZE} needs Pillow")
+        return w, h, rgba
+
+    with Image.open(path) as img:
+        img = img.convert("RGBA")
+        if img.size != (SIZE, SIZE):
+            img = img.resize((SIZE, SIZE), Image.LANCZOS)
+        return SIZE, SIZE, img.tobytes()
+
+
+def svg_color(value):
+    if value == "white":
+        return 0xFFFFFF
+    if value == "black":
+        return 0x000000
+    match = re.fullmatch(r"#([0-9a-fA-F]{6})", value)
+    if match is None:
+        raise ValueError(f"fill {value!r} not supported")
+    return int(match.group(1), 16)
+
+
+def svg_path_edges(d, scale, vx, vy):
+    """Line segments (x0, y0, x1, y1) in pixels of SVG path data (M/L/H/V/C/Z, absolute or relative)"""
+    tokens = re.findall(r"[A-Za-z]|[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?", d)
+    edges = []
+    x = y = start_x = start_y = 0.0
+    cmd = None
+    i = 0
+
+    def number():
+        nonlocal i
+        i += 1
+        return float(tokens[i - 1])
+
+    def line_to(nx, ny):
+        nonlocal x, y
+        edges.append(((x - vx) * scale, (y - vy) * scale, (nx - vx) * scale, (ny - vy) * scale))
+        x, y = nx, ny
+
+    while i < len(tokens):
+        if tokens[i].isalpha():
+            cmd = tokens[i]
+            i += 1
+            if cmd in "Zz":
+                line_to(start_x, start_y)
+                continue
+        if cmd is None or cmd in "Zz":
+            raise ValueError(f"path data {tokens[i]!r} without a command")
+        ox, oy = (x, y) if cmd.islower() else (0.0, 0.0)
+        op = cmd.upper()
+        if op == "M":
+            x, y = ox + number(), oy + number()
+            start_x, start_y = x, y
+            cmd = "l" if cmd == "m" else "L"  # Further pairs are lines
+        elif op == "L":
+            line_to(ox + number(), oy + number())
+        elif op == "H":
+            line_to(ox + number(), y)
+        elif op == "V":
+            line_to(x, oy + number())
+        elif op == "C":
+            x1, y1, x2, y2 = ox + number(), oy + number(), ox + number(), oy + number()
+            x3, y3 = ox + number(), oy + number()
+            x0, y0 = x, y
+            for step in range(1, SVG_CURVE_STEPS + 1):
+                t = step / SVG_CURVE_STEPS
+                u = 1 - t
+                line_to(u * u * u * x0 + 3 * u * u * t * x1 + 3 * u * t * t * x2 + t * t * t * x3,
+                        u * u * u * y0 + 3 * u * u * t * y1 + 3 * u * t * t * y2 + t * t * t * y3)
+        else:
+            raise ValueError(f"path command {cmd!r} not supported")
+    return edges
+
+
+def add_span(cover, start, end):
+    """Add the coverage of [start, end) on one sample line to the row"""
+    size = len(cover)
+    start, end = min(max(start, 0.0), size), min(max(end, 0.0), size)
+    if end <= start:
+        return
+    first, last = int(start), int(end)
+    if first == last:
+        cover[first] += end - start
+        return
+    cover[first] += first + 1 - start
+    for px in range(first + 1, min(last, size)):
+        cover[px] += 1.0
+    if last < size:
+        cover[last] += end - last
+
+
+def rasterize_svg(path, size):
+    """(size, size, RGBA bytes) of an SVG of filled paths in one color (nonzero rule;
+    clip paths are ignored, the icons clip to their own viewBox)"""
+    root = ET.parse(path).getroot()
+    vx, vy, vw, vh = (float(v) for v in root.get("viewBox").split())
+    if vw != vh:
+        raise ValueError("viewBox is not square")
+    scale = size / vw
+
+    edges = []
+    color = None
+    for element in root.iter(f"{SVG_NS}path"):
+        fill = element.get("fill", "black")
+        if fill == "none":
+            continue
+        if color is not None and svg_color(fill) != color:
+            raise ValueError("more than one fill color, render with --svg")
+        color = svg_color(fill)
+        edges += [e for e in svg_path_edges(element.get("d", ""), scale, vx, vy) if e[1] != e[3]]
+
+    # Nonzero winding spans on SVG_SUBROWS lines per row, exact coverage along x
+    edges.sort(key=lambda e: min(e[1], e[3]))
+    next_edge = 0
+    active = []
+    alpha = bytearray(size * size)
+    for row in range(size):
+        cover = [0.0] * size
+        for sub in range(SVG_SUBROWS):
+            sy = row + (sub + 0.5) / SVG_SUBROWS
+            while next_edge < len(edges) and min(edges[next_edge][1], edges[next_edge][3]) <= sy:
+                active.append(edges[next_edge])
+                next_edge += 1
+            active = [e for e in active if max(e[1], e[3]) > sy]
+
+            crossings = sorted((x0 + (sy - y0) * (x1 - x0) / (y1 - y0), 1 if y1 > y0 else -1)
+                               for x0, y0, x1, y1 in active)
+            winding = 0
+            span_start = 0.0
+            for cx, direction in crossings:
+                if winding == 0:
+                    span_start = cx
+                winding += direction
+                if winding == 0:
+                    add_span(cover, span_start, cx)
+        for px in range(size):
+            alpha[row * size + px] = min(255, round(cover[px] * 255 / SVG_SUBROWS))
+
+    rgb = struct.pack(">I", color or 0)[1:]
+    return size, size, b"".join(rgb + bytes((a,)) if a else b"\0\0\0\0" for a in alpha)
+
+
+def alpha_error(rgba, other):
+    """Mean absolute alpha difference of two RGBA images of the same size"""
+    return sum(abs(a - b) for a, b in zip(rgba[3::4], other[3::4])) / (len(rgba) // 4)
+
+
+def to_rgb565a8(w, h, rgba):
+    """RGB565 plane (little-endian) followed by the A8 plane"""
+    colors = bytearray()
+    alpha = bytearray()
+    for i in range(0, w * h * 4, 4):
+        r, g, b, a = rgba[i:i + 4]
+        if a == 0:
+            value = 0  # Invisible, keep the plane compressible
+        else:
+            value = ((r * 31 + 127) // 255) << 11 | ((g * 63 + 127) // 255) << 5 | (b * 31 + 127) // 255
+        colors += struct.pack("<H", value)
+        alpha.append(a)
+    return bytes(colors + alpha)
+
+
+def qoi_encode(w, h, rgba):
+    """QOI image (qoiformat.org) of 8-bit RGBA pixels"""
+    out = bytearray(struct.pack(">4sIIBB", b"qoif", w, h, 4, 0))
+    index = [(0, 0, 0, 0)] * 64
+    prev = (0, 0, 0, 255)
+    run = 0
+    count = w * h
+    for i in range(count):
+        px = tuple(rgba[i * 4:i * 4 + 4])
+        if px == prev:
+            run += 1
+            if run == 62 or i == count - 1:
+                out.append(0xC0 | (run - 1))
+                run = 0
+            continue
+        if run > 0:
+            out.append(0xC0 | (run - 1))
+            run = 0
+
+        r, g, b, a = px
+        slot = (r * 3 + g * 5 + b * 7 + a * 11) % 64
+        if index[slot] == px:
+            out.append(slot)
+        else:
+            index[slot] = px
+            if a != prev[3]:
+                out += bytes((0xFF, r, g, b, a))
+            else:
+                # Wrapping channel differences, -128..127
+                dr = (r - prev[0] + 128) % 256 - 128
+                dg = (g - prev[1] + 128) % 256 - 128
+                db = (b - prev[2] + 128) % 256 - 128
+                dr_dg = dr - dg
+                db_dg = db - dg
+                if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                    out.append(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))
+                elif -32 <= dg <= 31 and -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+                    out += bytes((0x80 | (dg + 32), (dr_dg + 8) << 4 | (db_dg + 8)))
+                else:
+                    out += bytes((0xFE, r, g, b))
+        prev = px
+    out += b"\0" * 7 + b"\1"
+    return bytes(out)
+
+
+def bin_header(w, h):
+    """12-byte lv_image_header_t: magic, cf, flags / w, h / stride, reserved"""
+    return struct.pack("<BBHHHHH", LV_IMAGE_HEADER_MAGIC, LV_COLOR_FORMAT_RGB565A8, 0, w, h, w * 2, 0)
+
+
+def render_svgs():
+    """Render resources/icons/*.svg to data/icons/*.png (cairosvg or inkscape)"""
+    try:
+        import cairosvg
+    except ImportError:
+        cairosvg = None
+    inkscape = shutil.which("inkscape")
+    if cairosvg is None and inkscape is None:
+        print("✗ --svg needs cairosvg (pip install cairosvg) or inkscape on PATH")
+        return False
+
+    PNG_DIR.mkdir(parents=True, exist_ok=True)
+    ok = True
+    for svg in sorted(SVG_DIR.glob("*.svg")):
+        png = PNG_DIR / f"{svg.stem}.png"
+        if cairosvg is not None:
+            cairosvg.svg2png(url=str(svg), write_to=str(png), output_width=SIZE, output_height=SIZE)
+        else:
+            result = subprocess.run([inkscape, str(svg), "--export-type=png", f"--export-filename={png}",
+                                     f"--export-width={SIZE}", f"--export-height={SIZE}",
+                                     "--export-background-opacity=0"],
+                                    capture_output=True, text=True, timeout=30)
+            if result.returncode != 0:
+                print(f"✗ {svg.name} - {result.stderr[:100]}")
+                ok = False
+                continue
+        print(f"✓ {svg.name} -> {png.name}")
+    return ok
+
+
+def read_conditions():
+    with CONDITIONS_CSV.open(newline="", encoding="utf-8") as f:
+        return [row for row in csv.DictReader(f)]
+
+
+def c_array(name, data):
+    lines = [f"static const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST uint8_t {name}_map[] = {{"]
+    for i in range(0, len(data), 24):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + 24]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def read_card_color():
+    """MAIN_CARD_BG_COLOR from UI_SOURCE as 0xRRGGBB"""
+    match = re.search(r"#define\s+MAIN_CARD_BG_COLOR\s+0x([0-9a-fA-F]{6})\b",
+                      UI_SOURCE.read_text(encoding="utf-8"))
+    if match is None:
+        raise ValueError(f"no MAIN_CARD_BG_COLOR 0xRRGGBB in {UI_SOURCE.as_posix()}")
+    return int(match.group(1), 16)
+
+
+def read_layout_sizes():
+    """ICON_SIZE_<layout> values in UI_SOURCE, the sets compiled into flash"""
+    sizes = {int(v) for v in re.findall(r"#define\s+ICON_SIZE_\w+\s+(\d+)\b", UI_SOURCE.read_text(encoding="utf-8"))}
+    unknown = sorted(sizes - set(SET_SIZES))
+    if unknown:
+        raise ValueError(f"icon size {unknown[0]} in {UI_SOURCE.as_posix()} is not one of {SET_SIZES}")
+    return sizes
+
+
+def mix_rgb565(fg, bg, mix):
+    """LVGL's lv_color_16_16_mix: fg over bg with opacity mix (0..255)"""
+    if mix == 255 or fg == bg:
+        return fg
+    if mix == 0:
+        return bg
+    mix = (mix + 4) >> 3
+    bg32 = (bg | bg << 16) & 0x7E0F81F
+    fg32 = (fg | fg << 16) & 0x7E0F81F
+    result = (((((fg32 - bg32) & 0xFFFFFFFF) * mix & 0xFFFFFFFF) >> 5) + bg32) & 0x7E0F81F
+    return (result >> 16 | result) & 0xFFFF
+
+
+def to_opaque_rgb565(rgb565a8, background):
+    """RGB565A8 image composited on a 0xRRGGBB background, little-endian RGB565"""
+    r, g, b = background >> 16 & 0xFF, background >> 8 & 0xFF, background & 0xFF
+    bg = (r >> 3) << 11 | (g >> 2) << 5 | b >> 3
+    count = len(rgb565a8) // 3
+    colors = struct.unpack(f"<{count}H", rgb565a8[:count * 2])
+    alpha = rgb565a8[count * 2:]
+    return struct.pack(f"<{count}H", *(mix_rgb565(c, bg, a) for c, a in zip(colors, alpha)))
+
+
+def image_dsc(name, cf, size, stride, static=False):
+    return [f"{'static ' if static else ''}const lv_image_dsc_t {name} = {{",
+            "    .header = {",
+            "        .magic = LV_IMAGE_HEADER_MAGIC,",
+            f"        .cf = {cf},",
+            "        .flags = 0,",
+            f"        .w = {size},",
+            f"        .h = {size},",
+            f"        .stride = {stride},",
+            "    },",
+            f"    .data_size = sizeof({name}_map),",
+            f"    .data = {name}_map,",
+            "};",
+            ""]
+
+
+def write_sources(sets, flash_sizes, background, conditions):
+    """sets: {size: (RGB565A8 images, RGB565 images by name)}; the sets not in
+    flash_sizes are compiled with WEATHER_ICON_ALL_SETS only"""
+    OUT_DIR.mkdir(parents=True, exist_ok=True)
+    names = list(sets[SIZE][0])
+
+    h = [f"// {GENERATED_NOTE}",
+         "#ifndef WEATHER_ICON_IMAGES_H",
+         "#define WEATHER_ICON_IMAGES_H",
+         "",
+         "#include <lvgl.h>",
+         "",
+         f"#define WEATHER_ICON_SIZE {SIZE}",
+         f"#define WEATHER_ICON_COUNT {len(names)}",
+         "",
+         "// Icon sets, smallest first. The ICON_SIZE_* sets of ui_weather.cpp and",
+         "// WEATHER_ICON_SIZE are always in flash, the others with WEATHER_ICON_ALL_SETS.",
+         f"#define WEATHER_ICON_SET_COUNT {len(SET_SIZES)}",
+         f"#define WEATHER_ICON_FLASH_SIZES {', '.join(str(size) for size in sorted(flash_sizes))}",
+         "#ifndef WEATHER_ICON_ALL_SETS",
+         "#define WEATHER_ICON_ALL_SETS 0",
+         "#endif",
+         "",
+         "// Background of the weather_icon_opaque_* images (MAIN_CARD_BG_COLOR)",
+         f"#define WEATHER_ICON_OPAQUE_BG 0x{background:06x}",
+         "",
+         "#ifdef __cplusplus",
+         'extern "C"',
+         "{",
+         "#endif",
+         ""]
+    h += [f"  extern const lv_image_dsc_t weather_icon_{name};" for name in names]
+    h += ["",
+          "  // RGB565, composited on WEATHER_ICON_OPAQUE_BG"]
+    h += [f"  extern const lv_image_dsc_t weather_icon_opaque_{name};" for name in names]
+    h += ["",
+          "  // By WEATHER_ICON_INDEX_*",
+          "  extern const lv_image_dsc_t *const weather_icon_images[WEATHER_ICON_COUNT];",
+          "  extern const lv_image_dsc_t *const weather_icon_opaque_images[WEATHER_ICON_COUNT];",
+          "",
+          "  // All icons in one size",
+          "  typedef struct",
+          "  {",
+          "    uint16_t size;",
+          "    const lv_image_dsc_t *const *images; // By WEATHER_ICON_INDEX_*, NULL if not compiled",
+          "    const lv_image_dsc_t *const *opaque; // RGB565, as weather_icon_opaque_images",
+          "  } weather_icon_set_t;",
+          "",
+          "  extern const weather_icon_set_t weather_icon_sets[WEATHER_ICON_SET_COUNT];",
+          "",
+          "  // File names without extension, by WEATHER_ICON_INDEX_*",
+          "  extern const char *const weather_icon_names[WEATHER_ICON_COUNT];"]
+    h += ["",
+          "  // Position in data/icons.atlas and in the sets",
+          "  enum",
+          "  {"]
+    h += [f"    WEATHER_ICON_INDEX_{name} = {i}," for i, name in enumerate(names)]
+    h += ["  };",
+          "",
+          "#ifdef __cplusplus",
+          "}",
+          "#endif",
+          "",
+          "#endif // WEATHER_ICON_IMAGES_H",
+          ""]
+    OUT_H.write_text("\n".join(h), encoding="utf-8")
+
+    c = [f"// {GENERATED_NOTE}",
+         f"// {len(names)} RGB565A8 icons in {', '.join(f'{size}x{size}' for size in SET_SIZES)} from "
+         f"{PNG_DIR.as_posix()} ({SIZE}) and {SVG_DIR.as_posix()},",
+         f"// and RGB565 copies composited on 0x{background:06x}",
+         '#include "weather_icon_images.h"',
+         "",
+         "#ifndef LV_ATTRIBUTE_MEM_ALIGN",
+         "#define LV_ATTRIBUTE_MEM_ALIGN",
+         "#endif",
+         "",
+         "#ifndef LV_ATTRIBUTE_LARGE_CONST",
+         "#define LV_ATTRIBUTE_LARGE_CONST",
+         "#endif",
+         ""]
+    for size in SET_SIZES:
+        # The default set keeps its names, the others are reached through weather_icon_sets
+        default = size == SIZE
+        infix = "" if default else f"{size}_"
+        if size not in flash_sizes:
+            c += ["#if WEATHER_ICON_ALL_SETS", ""]
+        for variant, (prefix, cf) in enumerate((("weather_icon", "LV_COLOR_FORMAT_RGB565A8"),
+                                                ("weather_icon_opaque", "LV_COLOR_FORMAT_RGB565"))):
+            for name, data in sets[size][variant].items():
+                c += [c_array(f"{prefix}_{infix}{name}", data), ""]
+                c += image_dsc(f"{prefix}_{infix}{name}", cf, size, size * 2, static=not default)
+            table = f"{prefix}_images" + ("" if default else f"_{size}")
+            c += [f"{'' if default else 'static '}const lv_image_dsc_t *const {table}[WEATHER_ICON_COUNT] = {{"]
+            c += [f"    &{prefix}_{infix}{name}," for name in names]
+            c += ["};", ""]
+        if size not in flash_sizes:
+            c += ["#endif", ""]
+    c += ["const weather_icon_set_t weather_icon_sets[WEATHER_ICON_SET_COUNT] = {"]
+    for size in SET_SIZES:
+        suffix = "" if size == SIZE else f"_{size}"
+        entry = f"    {{{size}, weather_icon_images{suffix}, weather_icon_opaque_images{suffix}}},"
+        if size in flash_sizes:
+            c.append(entry)
+        else:
+            c += ["#if WEATHER_ICON_ALL_SETS", entry, "#else", f"    {{{size}, NULL, NULL}},", "#endif"]
+    c += ["};", ""]
+    c += ["const char *const weather_icon_names[WEATHER_ICON_COUNT] = {"]
+    c += [f'    "{name}",' for name in names]
+    c += ["};", ""]
+    OUT_C.write_text("\n".join(c), encoding="utf-8")
+
+    # Rows of WeatherIcons::weatherConditionMap; WEATHER_ICON() is defined by the includer
+    m = [f"// {GENERATED_NOTE}",
+         f"// From {CONDITIONS_CSV.as_posix()}: code, description, day icon, night icon"]
+    for row in conditions:
+        m.append(f'{{{int(row["code"])}, "{row["description"]}", '
+                 f'WEATHER_ICON({row["day"]}), WEATHER_ICON({row["night"]})}},')
+    OUT_MAP.write_text("\n".join(m) + "\n", encoding="utf-8")
+
+
+def write_atlas(path, pngs, images, qois, fmt):
+    """Pack all icons into one file; returns its size"""
+    count = len(pngs)
+    index_offset = 16
+    data_offset = index_offset + 16 * count
+    index = b""
+    data = b""
+    for png in pngs:
+        if fmt == "png":
+            blob = png.read_bytes()
+        elif fmt == "qoi":
+            blob = qois[png.stem]
+        else:
+            blob = bin_header(SIZE, SIZE) + images[png.stem]
+        offset = data_offset + len(data)
+        index += struct.pack("<IIBBHHH", offset, len(blob), ATLAS_FORMATS[fmt], 0, SIZE, SIZE, 0)
+        data += blob + b"\0" * (-len(blob) % 4)
+
+    header = struct.pack("<4sHHII", ATLAS_MAGIC, ATLAS_VERSION, count, index_offset, data_offset)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_bytes(header + index + data)
+    return path.stat().st_size
+
+
+def find_partition(name):
+    """(offset, size) of partition `name` in partitions.csv, None if absent"""
+    if not PARTITIONS_CSV.exists():
+        return None
+    for line in PARTITIONS_CSV.read_text(encoding="utf-8").splitlines():
+        fields = [f.strip() for f in line.split("#")[0].split(",")]
+        if len(fields) >= 5 and fields[0] == name:
+            return int(fields[3], 0), int(fields[4], 0)
+    return None
+
+
+def fs_footprint(sizes):
+    """Bytes taken in whole LittleFS blocks"""
+    return sum((size + FS_BLOCK - 1) // FS_BLOCK * FS_BLOCK for size in sizes)
+
+
+def generated_settings():
+    """(WEATHER_ICON_OPAQUE_BG, WEATHER_ICON_FLASH_SIZES) of the current header, None if missing"""
+    if not OUT_H.exists():
+        return None
+    header = OUT_H.read_text(encoding="utf-8")
+    background = re.search(r"#define WEATHER_ICON_OPAQUE_BG 0x([0-9a-f]{6})", header)
+    sizes = re.search(r"#define WEATHER_ICON_FLASH_SIZES ([\d, ]+)", header)
+    if background is None or sizes is None:
+        return None
+    return int(background.group(1), 16), {int(v) for v in sizes.group(1).split(",")}
+
+
+def up_to_date(inputs, outputs):
+    if not all(p.exists() for p in outputs):
+        return False
+    newest_input = max(p.stat().st_mtime for p in inputs)
+    return newest_input <= min(p.stat().st_mtime for p in outputs)
+
+
+def compile_icons(write_bin=False, from_svg=False, force=False, atlas_format="png", png_window=None):
+    if from_svg and not render_svgs():
+        return 1
+
+    conditions = read_conditions()
+    used = sorted({row[key] for row in conditions for key in ("day", "night")})
+    missing = [name for name in used if not (PNG_DIR / f"{name}.png").exists()]
+    if missing:
+        print(f"✗ Missing icons in {PNG_DIR}: {', '.join(missing)}")
+        return 1
+
+    pngs = [PNG_DIR / f"{name}.png" for name in used]
+    svgs = [SVG_DIR / f"{name}.svg" for name in used]
+    missing = [svg.name for svg in svgs if not svg.exists()]
+    if missing:
+        print(f"✗ Missing icons in {SVG_DIR}: {', '.join(missing)}")
+        return 1
+    if png_window is not None:
+        try:
+            sizes = [repack_png(png, png_window) for png in pngs]
+        except (ValueError, zlib.error) as e:
+            print(f"✗ --png-window: {e}")
+            return 1
+        print(f"✓ {len(pngs)} PNGs recompressed with a {1 << png_window} B window: "
+              f"{sum(new for _, new in sizes)} B (was {sum(old for old, _ in sizes)} B)")
+    script = Path("resources/compile_icons.py")
+    inputs = pngs + svgs + [CONDITIONS_CSV] + ([script] if script.exists() else [])
+    outputs = [OUT_C, OUT_H, OUT_MAP, OUT_ATLAS, OUT_ASSETS] + [png.with_suffix(".qoi") for png in pngs]
+    try:
+        background = read_card_color()
+        flash_sizes = read_layout_sizes() | {SIZE}
+    except (OSError, ValueError) as e:
+        print(f"✗ {e}")
+        return 1
+    if (not force and not write_bin and atlas_format == "png" and up_to_date(inputs, outputs)
+            and generated_settings() == (background, flash_sizes)):
+        return 0
+
+    # The PNGs for SIZE, the SVGs for the other sets
+    sets = {}
+    qois = {}
+    for size in SET_SIZES:
+        images = {}
+        for png, svg in zip(pngs, svgs):
+            try:
+                w, h, rgba = read_png(png) if size == SIZE else rasterize_svg(svg, size)
+            except (ValueError, ET.ParseError) as e:
+                print(f"✗ {(png if size == SIZE else svg).name} - {e}")
+                return 1
+            images[png.stem] = to_rgb565a8(w, h, rgba)
+            if size == SIZE:
+                error = alpha_error(rgba, rasterize_svg(svg, SIZE)[2])
+                if error > SVG_MAX_ALPHA_ERROR:
+                    print(f"✗ {svg.name} - rasterized {SIZE}x{SIZE} is {error:.2f} alpha levels off {png.name}")
+                    return 1
+                qois[png.stem] = qoi_encode(w, h, rgba)
+                (PNG_DIR / f"{png.stem}.qoi").write_bytes(qois[png.stem])
+                if write_bin:
+                    (PNG_DIR / f"{png.stem}.bin").write_bytes(bin_header(w, h) + images[png.stem])
+        sets[size] = (images, {name: to_opaque_rgb565(data, background) for name, data in images.items()})
+
+    write_sources(sets, flash_sizes, background, conditions)
+    for size in SET_SIZES:
+        images, opaque = sets[size]
+        total = sum(len(data) for data in images.values())
+        opaque_total = sum(len(data) for data in opaque.values())
+        place = "in flash" if size in flash_sizes else "WEATHER_ICON_ALL_SETS only"
+        print(f"✓ {len(images)} {size}x{size} icons, {place} ({total} B RGB565A8, "
+              f"{opaque_total} B RGB565 on 0x{background:06x})")
+    print(f"✓ {len(conditions)} conditions -> {OUT_DIR.as_posix()}")
+    if write_bin:
+        print(f"✓ {len(pngs)} .bin files in {PNG_DIR.as_posix()} (pio run --target uploadfs)")
+
+    png_sizes = [png.stat().st_size for png in pngs]
+    qoi_sizes = [len(data) for data in qois.values()]
+    print(f"✓ {len(qois)} .qoi files in {PNG_DIR.as_posix()}: {sum(qoi_sizes)} B "
+          f"(PNG {sum(png_sizes)} B)")
+
+    images = sets[SIZE][0]
+    atlas_size = write_atlas(OUT_ATLAS, pngs, images, qois, atlas_format)
+    print(f"✓ {OUT_ATLAS.as_posix()}: {len(pngs)} {atlas_format} entries, {atlas_size} B "
+          f"(~{fs_footprint([atlas_size])} B on LittleFS); per-file PNGs {sum(png_sizes)} B "
+          f"(~{fs_footprint(png_sizes)} B in {FS_BLOCK} B blocks)")
+
+    # Undecoded entries, so the mapped partition is drawn from without a copy
+    assets_size = write_atlas(OUT_ASSETS, pngs, images, qois, "bin")
+    partition = find_partition(ASSETS_PARTITION)
+    if partition is not None and assets_size > partition[1]:
+        print(f"✗ {OUT_ASSETS.as_posix()}: {assets_size} B, partition {ASSETS_PARTITION} holds {partition[1]} B")
+        return 1
+    print(f"✓ {OUT_ASSETS.as_posix()}: {len(pngs)} bin entries, {assets_size} B for partition {ASSETS_PARTITION}")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--bin", action="store_true", help="Also write LVGL .bin files to data/icons")
+    parser.add_argument("--svg", action="store_true", help="Render resources/icons/*.svg to PNG first")
+    parser.add_argument("--force", action="store_true", help="Regenerate even if up to date")
+    parser.add_argument("--atlas-format", choices=sorted(ATLAS_FORMATS), default="png",
+                        help="Atlas entries: PNG files as-is or undecoded LVGL .bin images")
+    parser.add_argument("--png-window", type=int, choices=range(9, 16), metavar="BITS",
+                        help="Recompress data/icons/*.png with a 2^BITS byte deflate window (9-15)")
+    args = parser.parse_args()
+    return compile_icons(args.bin, args.svg, args.force, args.atlas_format, args.png_window)
+
+
+try:
+    Import("env")  # noqa: F821 - defined when run by PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    import os
+
+    os.chdir(env.subst("$PROJECT_DIR"))
+    if compile_icons() != 0:
+        env.Exit(1)
+
+    # Flash the asset partition image together with the firmware
+    partition = find_partition(ASSETS_PARTITION)
+    if partition is not None and env.subst("$PIOPLATFORM") == "espressif32":
+        env.Append(FLASH_EXTRA_IMAGES=[(hex(partition[0]), str(Path.cwd() / OUT_ASSETS))])
+elif __name__ == "__main__":
+    import os
+
+    os.chdir(Path(__file__).resolve().parent.parent)
+    sys.exit(main())
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Extract a trace dump from a serial monitor log and write Chrome trace JSON
+
+The firmware (built with -DTRACE_ENABLED=1) prints the trace ring between
+"=== TRACE BEGIN ===" and "=== TRACE END ===" when it receives 't' on serial.
+The last dump in the log is validated (spans must nest per core) and written
+out for chrome://tracing or https://ui.perfetto.dev. Only the spans the dump
+reports as open before the kept events (otherData.open_spans, begun before the
+ring wrapped or was reset) may end without their begin.
+
+Usage:
+    pio device monitor | tee monitor.log      # press 't'
+    python resources/trace_to_chrome.py monitor.log -o trace.json
+    python resources/trace_to_chrome.py native_trace.json --check
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+BEGIN_MARKER = "=== TRACE BEGIN ==="
+END_MARKER = "=== TRACE END ==="
+
+
+def extract_dump(text):
+    """Return the JSON text of the last dump in a monitor log (or the text itself)"""
+    end = text.rfind(END_MARKER)
+    begin = text.rfind(BEGIN_MARKER, 0, end) if end >= 0 else -1
+    if begin < 0:
+        return text
+    return text[begin + len(BEGIN_MARKER):end]
+
+
+def check_nesting(events, open_spans):
+    """Return (errors, closed spans, truncated ends). open_spans[tid] ends with
+    no span open are truncation, their begins were not kept; any further one
+    is an error."""
+    stacks = {}
+    unmatched = dict(enumerate(open_spans))
+    errors = []
+    closed = 0
+    truncated = 0
+    for i, ev in enumerate(events):
+        tid = ev.get("tid", 0)
+        stack = stacks.setdefault(tid, [])
+        if ev["ph"] == "B":
+            stack.append(ev["name"])
+        elif ev["ph"] == "E":
+            if not stack:
+                if unmatched.get(tid, 0) > 0:
+                    unmatched[tid] -= 1
+                    truncated += 1
+                else:
+                    errors.append(f"event {i}: '{ev['name']}' ends with no span open")
+                continue
+            name = stack.pop()
+            if name != ev["name"]:
+                errors.append(f"event {i}: '{ev['name']}' ends while '{name}' is open")
+            closed += 1
+    return errors, closed, truncated
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log", type=Path, help="Serial monitor log or trace JSON")
+    parser.add_argument("-o", "--output", type=Path, help="Chrome trace JSON to write")
+    parser.add_argument("--check", action="store_true", help="Only validate, write nothing")
+    args = parser.parse_args()
+
+    text = args.log.read_text(encoding="utf-8", errors="replace")
+    try:
+        trace = json.loads(extract_dump(text))
+    except json.JSONDecodeError as e:
+        print(f"✗ No valid trace dump in {args.log}: {e}")
+        return 1
+
+    events = trace.get("traceEvents", [])
+    other = trace.get("otherData", {})
+    errors, closed, truncated = check_nesting(events, other.get("open_spans", []))
+
+    names = {ev["name"] for ev in events}
+    print(f"{len(events)} events, {closed} closed spans, {len(names)} span names"
+          + (", ring wrapped" if other.get("wrapped") else "")
+          + (f", {truncated} spans begun before the dump" if truncated else ""))
+
+    if errors:
+        for err in errors[:20]:
+            print(f"✗ {err}")
+        print(f"✗ {len(errors)} nesting errors")
+        return 1
+
+    if args.output and not args.check:
+        args.output.write_text(json.dumps(trace, indent=1), encoding="utf-8")
+        print(f"✓ Wrote {args.output}")
+    else:
+        print("✓ Spans nest correctly")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -14,7 +14,129 @@
 // Display Orientation
 // Set to 0 for VERTICAL (portrait, 172x320) - default
 // Set to 1 for HORIZONTAL (landscape, 320x172)
+#ifndef DISPLAY_HORIZONTAL
 #define DISPLAY_HORIZONTAL 1
+#endif
+
+// Display Transport
+// DISPLAY_TRANSPORT_ADAFRUIT: blocking Adafruit_ST7789 writePixels path
+// DISPLAY_TRANSPORT_ESP_LCD: esp_lcd ST7789 driver, SPI DMA, double-buffered
+// DISPLAY_TRANSPORT_FRAMEBUFFER: in-memory RGB565 framebuffer (profiling, no panel output)
+#define DISPLAY_TRANSPORT_ADAFRUIT 0
+#define DISPLAY_TRANSPORT_ESP_LCD 1
+#define DISPLAY_TRANSPORT_FRAMEBUFFER 2
+#ifndef DISPLAY_TRANSPORT
+#define DISPLAY_TRANSPORT DISPLAY_TRANSPORT_ESP_LCD
+#endif
+
+// LVGL Draw Buffers
+// LVGL_BUFFERS_PARTIAL: one render band in internal SRAM
+// LVGL_BUFFERS_PARTIAL_DOUBLE: two bands in internal DMA SRAM, render while the other is sent
+// LVGL_BUFFERS_DIRECT_PSRAM: full frame in PSRAM, only invalidated areas are sent
+#define LVGL_BUFFERS_PARTIAL 0
+#define LVGL_BUFFERS_PARTIAL_DOUBLE 1
+#define LVGL_BUFFERS_DIRECT_PSRAM 2
+#ifndef LVGL_BUFFER_STRATEGY
+#if DISPLAY_TRANSPORT == DISPLAY_TRANSPORT_ESP_LCD
+#define LVGL_BUFFER_STRATEGY LVGL_BUFFERS_PARTIAL_DOUBLE
+#else
+#define LVGL_BUFFER_STRATEGY LVGL_BUFFERS_PARTIAL
+#endif
+#endif
+
+// Merge dirty areas before flushing when one transfer is cheaper than several
+// (0 = LVGL's default joining only)
+#define DISPLAY_AREA_COALESCING 1
+
+// Flush benchmark
+// Number of full-screen refreshes timed at startup for each buffer strategy (0 to disable)
+#define DISPLAY_BENCHMARK_FRAMES 0
+
+// Forecast Response Parser
+// WEATHER_PARSER_ARDUINOJSON: ArduinoJson document through a field filter
+// WEATHER_PARSER_SCHEMA: tokenizer specialized for the WeatherAPI.com
+//   response, values written straight into WeatherData (forecast_parser)
+#define WEATHER_PARSER_ARDUINOJSON 0
+#define WEATHER_PARSER_SCHEMA 1
+#ifndef WEATHER_PARSER
+#define WEATHER_PARSER WEATHER_PARSER_SCHEMA
+#endif
+
+// Keep the connection to WeatherAPI.com open between fetches (HTTP/1.1
+// keep-alive); a connection the server closed while idle is replaced
+#define WEATHER_HTTP_REUSE 1
+#define WEATHER_HTTP_TIMEOUT_MS 5000 // Waiting for response and body bytes
+
+// Weather Fetch Task
+// Fetch and parse on a task of their own, pinned to the WiFi stack's core;
+// the loop task on the other core only picks up the result, so rendering
+// never waits for DNS, HTTP or parsing (0 = fetch inline in loop())
+#define WEATHER_TASK_ENABLED 1
+#define WEATHER_TASK_CORE 0
+#define WEATHER_TASK_PRIORITY 1
+#define WEATHER_TASK_STACK 8192         // Bytes; HTTP, parser and float logging
+#define WEATHER_CHECK_INTERVAL_MS 300000 // How often needsUpdate() is checked
+
+// UI Settings
+// Render the screen background, cards and shadows once into a PSRAM bitmap
+// and draw only labels and the icon on top of it
+#define UI_STATIC_LAYER_CACHE 1
+
+// Weather icon source
+// ICON_SOURCE_PNG: data/icons/*.png on LittleFS, decoded on every draw (see PNG_STREAM_DECODE)
+// ICON_SOURCE_BIN: data/icons/*.bin on LittleFS (resources/compile_icons.py --bin)
+// ICON_SOURCE_COMPILED: RGB565A8 images in flash, generated at build time
+// ICON_SOURCE_ATLAS: data/icons.atlas, one file loaded into PSRAM at first use
+// ICON_SOURCE_ASSETS: atlas in the "assets" flash partition, memory-mapped
+// ICON_SOURCE_QOI: data/icons/*.qoi on LittleFS, lossless, decoded in one pass
+// ICON_SOURCE_OPAQUE: RGB565 images in flash composited on the card color, copied without blending
+#define ICON_SOURCE_PNG 0
+#define ICON_SOURCE_BIN 1
+#define ICON_SOURCE_COMPILED 2
+#define ICON_SOURCE_ATLAS 3
+#define ICON_SOURCE_ASSETS 4
+#define ICON_SOURCE_QOI 5
+#define ICON_SOURCE_OPAQUE 6
+#ifndef ICON_SOURCE
+#define ICON_SOURCE ICON_SOURCE_OPAQUE
+#endif
+
+// Decoded PNG/.bin icons kept in PSRAM (bytes, LRU; 0 = decode on every draw)
+// A 64x64 PNG decodes to 16 KB ARGB8888, a .bin icon to 12 KB RGB565A8
+#define ICON_CACHE_BYTES (8 * 16 * 1024)
+
+// Decode PNGs row by row into a strip LVGL blends instead of into a full
+// ARGB8888 image (lvgl_png_stream; 0 = LODEPNG). Cached icons are decoded the
+// same way, straight into their PSRAM buffer.
+#define PNG_STREAM_DECODE 1
+#define PNG_STREAM_STRIP_ROWS 8 // Rows per get_area call, 4 B per pixel each
+
+// Fonts
+// The weather screen's Montserrat 16/24/26/48 are subsets generated at build
+// time (resources/compile_fonts.py). The A8 bitmaps of the number labels'
+// glyphs are kept after their first draw (lvgl_glyph_cache, PSRAM, LRU;
+// 0 = unpack every glyph on every draw).
+#define GLYPH_CACHE_BYTES (24 * 1024)
+
+// LittleFS Driver Settings (LVGL drive S:)
+// Descriptors are taken from a fixed pool; each has a read-ahead buffer that
+// turns LODEPNG's small reads into a few LittleFS reads. Paths opened before
+// are remembered with their size (or as missing) in the directory cache.
+#define LVGL_FS_MAX_OPEN 4
+#define LVGL_FS_READ_AHEAD 2048       // Bytes per descriptor, 0 = read through
+#define LVGL_FS_DIR_CACHE_ENTRIES 16  // 0 = look up every open
+
+// Power Settings
+// The main loop sleeps until the next LVGL timer, weather check or WiFi retry.
+// Automatic light sleep while idle needs PM and tickless idle in the core's
+// sdkconfig. The backlight PWM then runs from the RC_FAST clock, which keeps
+// going in light sleep (and stays powered, a few hundred uA) where the APB
+// clock stops; BACKLIGHT_BRIGHTNESS is kept.
+#define IDLE_LIGHT_SLEEP 1
+// 1: drive the backlight at a steady full level during light sleep instead,
+// RC_FAST powered down, brighter and drawing more backlight current
+#define IDLE_BACKLIGHT_FULL 0
+#define IDLE_REPORT_INTERVAL_MS 60000 // Log wakeups/min and idle %
 
 // Debug Settings
 // Set to 1 to enable verbose debug logging, 0 to disable
@@ -0,0 +1,66 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-ins for the Arduino core (native builds only)
+// Time comes from the monotonic clock, GPIO calls are no-ops and Serial
+// writes to stdout.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "WString.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+// ESP-IDF memory placement attributes have no meaning on the host
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define DMA_ATTR
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+void analogWrite(uint8_t pin, int value);
+
+// Byte source with the Arduino Stream interface (HTTP bodies, sockets)
+class Stream
+{
+public:
+  virtual ~Stream() {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t readBytes(char *buffer, size_t length) = 0;
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes(reinterpret_cast<char *>(buffer), length); }
+};
+
+class HostSerial
+{
+public:
+  void begin(unsigned long baud);
+  size_t print(const char *str);
+  size_t print(const String &str);
+  size_t println(const char *str = "");
+  size_t println(const String &str);
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  // Host only: drop all output, for runs that log expected errors
+  void setMuted(bool muted) { this->muted = muted; }
+
+private:
+  bool muted = false;
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,57 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// Host stand-in for the Arduino fs::FS / fs::File API (native builds only)
+// Files are plain stdio files below a root directory on the build host.
+
+#include <Arduino.h>
+#include <new>
+#include <stdio.h>
+
+enum SeekMode
+{
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+namespace fs
+{
+
+  class File
+  {
+  private:
+    FILE *handle;
+
+  public:
+    File(FILE *f = nullptr) : handle(f) {}
+
+    // Copies share the handle, like the reference-counted Arduino File
+    operator bool() const { return handle != nullptr; }
+
+    size_t read(uint8_t *buf, size_t size);
+    size_t write(const uint8_t *buf, size_t size);
+    bool seek(uint32_t pos, SeekMode mode);
+    size_t position() const;
+    size_t size() const;
+    void close();
+  };
+
+  class FS
+  {
+  private:
+    String root;
+
+  public:
+    FS(const char *root_dir) : root(root_dir) {}
+
+    void setRoot(const char *root_dir) { root = root_dir; }
+    File open(const char *path, const char *mode = "r");
+    bool exists(const char *path);
+  };
+
+} // namespace fs
+
+using fs::File;
+
+#endif // HOST_FS_H
@@ -0,0 +1,92 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+// Host stand-in for the ESP32 HTTPClient (native builds only)
+// After setResponse() every GET returns that canned response, so recorded
+// API payloads can be replayed without a network; getStream() then hands out
+// the body the way a socket does, HOST_HTTP_SEGMENT bytes available at a time.
+// After clearResponse() GET speaks HTTP/1.1 over the WiFiClient passed to
+// begin(), with the ESP32 client's keep-alive behavior: the connection stays
+// open after end() when setReuse() allows it and the server did not close it,
+// and the body is read raw from the client (chunked encoding included).
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define HOST_HTTP_SEGMENT 1460 // One TCP segment
+#define HOST_HTTP_MAX_HEADERS 4 // collectHeaders() names kept
+
+// Error codes of the ESP32 HTTPClient
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+// Response body as a stream, read from the client's copy
+class HostBodyStream : public Stream
+{
+public:
+  void reset(const String *body);
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+
+private:
+  const String *body = nullptr;
+  size_t pos = 0;
+};
+
+class HTTPClient
+{
+private:
+  static bool canned;
+  static int response_code;
+  static String response_body;
+
+  String url;
+  String body;
+  HostBodyStream stream;
+
+  // Network requests
+  WiFiClient *client = nullptr;
+  String host;
+  uint16_t port = 80;
+  String path;
+  bool http10 = false;
+  bool reuse = true;
+  bool can_reuse = false;
+  uint16_t timeout_ms = 5000;
+  int size = -1;
+  const char *header_names[HOST_HTTP_MAX_HEADERS];
+  String header_values[HOST_HTTP_MAX_HEADERS];
+  size_t header_count = 0;
+
+  int networkGET();
+  bool readLine(std::string &line);
+
+public:
+  // Response returned by all following GET requests
+  static void setResponse(int code, const String &body);
+  // Following GET requests go to the server of the URL given to begin()
+  static void clearResponse();
+
+  void useHTTP10(bool use) { http10 = use; }
+  void setReuse(bool keep_alive) { reuse = keep_alive; }
+  void setTimeout(uint16_t ms) { timeout_ms = ms; }
+  bool begin(const String &request_url);
+  bool begin(WiFiClient &tcp, const String &request_url);
+  void collectHeaders(const char *names[], size_t count);
+  String header(const char *name);
+  bool connected();
+  int GET();
+  int getSize();
+  String getString();
+  Stream &getStream();
+  void end();
+};
+
+#endif // HOST_HTTPCLIENT_H
@@ -0,0 +1,29 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+// Host stand-in for the LittleFS mount (native builds only)
+// Paths resolve below HOST_FS_ROOT (default: the project's data/ folder),
+// the same tree `pio run --target uploadfs` writes to flash.
+
+#include "FS.h"
+
+#ifndef HOST_FS_ROOT
+#define HOST_FS_ROOT "data"
+#endif
+
+namespace fs
+{
+
+  class LittleFSFS : public FS
+  {
+  public:
+    LittleFSFS() : FS(HOST_FS_ROOT) {}
+
+    bool begin(bool format_on_fail = false);
+  };
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
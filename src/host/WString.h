@@ -0,0 +1,87 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+// Host stand-in for the Arduino String class (native builds only)
+// Covers the subset of the API used by this project.
+
+#include <stddef.h>
+#include <strings.h>
+#include <string>
+
+class String
+{
+private:
+  std::string buffer;
+
+public:
+  String() {}
+  String(const char *cstr) : buffer(cstr ? cstr : "") {}
+  String(const std::string &str) : buffer(str) {}
+  explicit String(char c) : buffer(1, c) {}
+  explicit String(int value) : buffer(std::to_string(value)) {}
+  explicit String(unsigned int value) : buffer(std::to_string(value)) {}
+  explicit String(long value) : buffer(std::to_string(value)) {}
+  explicit String(unsigned long value) : buffer(std::to_string(value)) {}
+  explicit String(float value, unsigned int decimals = 2) { formatFloat(value, decimals); }
+  explicit String(double value, unsigned int decimals = 2) { formatFloat(value, decimals); }
+
+  const char *c_str() const { return buffer.c_str(); }
+  unsigned int length() const { return (unsigned int)buffer.size(); }
+  bool reserve(unsigned int size)
+  {
+    buffer.reserve(size);
+    return true;
+  }
+
+  bool concat(const String &str)
+  {
+    buffer += str.buffer;
+    return true;
+  }
+  bool concat(const char *cstr)
+  {
+    buffer += cstr;
+    return true;
+  }
+  bool concat(char c)
+  {
+    buffer += c;
+    return true;
+  }
+  bool concat(const char *cstr, unsigned int len)
+  {
+    buffer.append(cstr, len);
+    return true;
+  }
+
+  String &operator+=(const String &str)
+  {
+    concat(str);
+    return *this;
+  }
+  String &operator+=(const char *cstr)
+  {
+    concat(cstr);
+    return *this;
+  }
+  String &operator+=(char c)
+  {
+    concat(c);
+    return *this;
+  }
+
+  bool operator==(const String &rhs) const { return buffer == rhs.buffer; }
+  bool operator==(const char *rhs) const { return buffer == rhs; }
+  bool operator!=(const String &rhs) const { return buffer != rhs.buffer; }
+  bool equalsIgnoreCase(const String &rhs) const { return strcasecmp(buffer.c_str(), rhs.c_str()) == 0; }
+  char operator[](unsigned int index) const { return index < buffer.size() ? buffer[index] : 0; }
+
+private:
+  void formatFloat(double value, unsigned int decimals);
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,63 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// Host stand-in for the ESP32 WiFi class (native builds only)
+// Reports a connected station so the weather fetch path runs, unless a test
+// takes it offline with setStatus().
+// WiFiClient is a real TCP client, for tests against local servers.
+
+#include <Arduino.h>
+
+#include <atomic>
+
+typedef enum
+{
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+class HostWiFi
+{
+public:
+  wl_status_t status() { return current; }
+  void setStatus(wl_status_t status) { current = status; }
+  int RSSI() { return -55; }
+
+private:
+  std::atomic<wl_status_t> current{WL_CONNECTED}; // Read from fetch threads
+};
+
+extern HostWiFi WiFi;
+
+// TCP client over a POSIX socket, as the ESP32 WiFiClient: reads do not
+// block, readBytes() waits up to the stream timeout
+class WiFiClient : public Stream
+{
+public:
+  ~WiFiClient() { stop(); }
+
+  int connect(const char *host, uint16_t port);
+  // Open, and not closed by the peer (unread data counts as open)
+  uint8_t connected();
+  void stop();
+  void setTimeout(unsigned long ms) { timeout_ms = ms; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size);
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+
+private:
+  int fd = -1;
+  unsigned long timeout_ms = 1000;
+};
+
+#endif // HOST_WIFI_H
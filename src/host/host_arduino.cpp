@@ -0,0 +1,612 @@
+// Host implementations of the Arduino core stand-ins (native builds only)
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Global objects
+HostSerial Serial;
+HostWiFi WiFi;
+fs::LittleFSFS LittleFS;
+
+bool HTTPClient::canned = true;
+int HTTPClient::response_code = -1;
+String HTTPClient::response_body;
+
+static uint64_t monotonic_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static const uint64_t boot_us = monotonic_us();
+
+unsigned long millis()
+{
+  return (unsigned long)((monotonic_us() - boot_us) / 1000ULL);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)(monotonic_us() - boot_us);
+}
+
+void delay(uint32_t ms)
+{
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+  nanosleep(&ts, nullptr);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  (void)pin;
+  (void)val;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+  (void)pin;
+  (void)value;
+}
+
+// === String ===
+
+void String::formatFloat(double value, unsigned int decimals)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+  buffer = buf;
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+// === Serial ===
+
+void HostSerial::begin(unsigned long baud)
+{
+  (void)baud;
+}
+
+size_t HostSerial::print(const char *str)
+{
+  if (muted)
+  {
+    return strlen(str);
+  }
+  return fputs(str, stdout) < 0 ? 0 : strlen(str);
+}
+
+size_t HostSerial::print(const String &str)
+{
+  return print(str.c_str());
+}
+
+size_t HostSerial::println(const char *str)
+{
+  size_t n = print(str);
+  if (!muted)
+  {
+    fputc('\n', stdout);
+  }
+  return n + 1;
+}
+
+size_t HostSerial::println(const String &str)
+{
+  return println(str.c_str());
+}
+
+size_t HostSerial::printf(const char *format, ...)
+{
+  if (muted)
+  {
+    return 0;
+  }
+  va_list args;
+  va_start(args, format);
+  int n = vprintf(format, args);
+  va_end(args);
+  return n < 0 ? 0 : (size_t)n;
+}
+
+// === WiFiClient ===
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  stop();
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *addresses = nullptr;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", (unsigned)port);
+  if (getaddrinfo(host, service, &hints, &addresses) != 0)
+  {
+    return 0;
+  }
+
+  for (struct addrinfo *a = addresses; a != nullptr && fd < 0; a = a->ai_next)
+  {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0)
+    {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+  if (fd < 0)
+  {
+    return 0;
+  }
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return 1;
+}
+
+uint8_t WiFiClient::connected()
+{
+  if (fd < 0)
+  {
+    return 0;
+  }
+  char c;
+  ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+void WiFiClient::stop()
+{
+  if (fd >= 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+}
+
+int WiFiClient::available()
+{
+  int n = 0;
+  if (fd < 0 || ioctl(fd, FIONREAD, &n) != 0)
+  {
+    return 0;
+  }
+  return n;
+}
+
+int WiFiClient::read()
+{
+  uint8_t c;
+  return fd >= 0 && recv(fd, &c, 1, MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+int WiFiClient::peek()
+{
+  uint8_t c;
+  return fd >= 0 && recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size)
+{
+  size_t sent = 0;
+  while (fd >= 0 && sent < size)
+  {
+    ssize_t n = send(fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      break;
+    }
+    sent += (size_t)n;
+  }
+  return sent;
+}
+
+size_t WiFiClient::readBytes(char *buffer, size_t length)
+{
+  size_t total = 0;
+  unsigned long start = millis();
+  while (fd >= 0 && total < length)
+  {
+    unsigned long waited = millis() - start;
+    if (waited >= timeout_ms)
+    {
+      break;
+    }
+    struct pollfd p = {fd, POLLIN, 0};
+    if (poll(&p, 1, (int)(timeout_ms - waited)) <= 0)
+    {
+      break;
+    }
+    ssize_t n = recv(fd, buffer + total, length - total, 0);
+    if (n <= 0)
+    {
+      break; // Closed by the peer
+    }
+    total += (size_t)n;
+  }
+  return total;
+}
+
+// === HTTPClient ===
+
+void HTTPClient::setResponse(int code, const String &body)
+{
+  canned = true;
+  response_code = code;
+  response_body = body;
+}
+
+void HTTPClient::clearResponse()
+{
+  canned = false;
+}
+
+bool HTTPClient::begin(const String &request_url)
+{
+  url = request_url;
+  return true;
+}
+
+bool HTTPClient::begin(WiFiClient &tcp, const String &request_url)
+{
+  client = &tcp;
+  client->setTimeout(timeout_ms);
+  url = request_url;
+  size = -1;
+
+  // http://host[:port]/path
+  std::string u = request_url.c_str();
+  if (u.compare(0, 7, "http://") != 0)
+  {
+    return false;
+  }
+  size_t host_end = u.find_first_of(":/", 7);
+  host = String(u.substr(7, host_end - 7));
+  port = 80;
+  if (host_end != std::string::npos && u[host_end] == ':')
+  {
+    port = (uint16_t)atoi(u.c_str() + host_end + 1);
+    host_end = u.find('/', host_end);
+  }
+  path = host_end != std::string::npos ? String(u.substr(host_end)) : String("/");
+  return true;
+}
+
+void HTTPClient::collectHeaders(const char *names[], size_t count)
+{
+  header_count = count < HOST_HTTP_MAX_HEADERS ? count : HOST_HTTP_MAX_HEADERS;
+  for (size_t i = 0; i < header_count; i++)
+  {
+    header_names[i] = names[i];
+    header_values[i] = "";
+  }
+}
+
+String HTTPClient::header(const char *name)
+{
+  for (size_t i = 0; i < header_count; i++)
+  {
+    if (strcasecmp(header_names[i], name) == 0)
+    {
+      return header_values[i];
+    }
+  }
+  return String();
+}
+
+bool HTTPClient::connected()
+{
+  return !canned && client != nullptr && client->connected();
+}
+
+int HTTPClient::GET()
+{
+  if (!canned)
+  {
+    return networkGET();
+  }
+  body = response_body;
+  stream.reset(&body);
+  return response_code;
+}
+
+bool HTTPClient::readLine(std::string &line)
+{
+  line.clear();
+  char c;
+  while (client->readBytes(&c, 1) == 1)
+  {
+    if (c == '\n')
+    {
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.pop_back();
+      }
+      return true;
+    }
+    line += c;
+  }
+  return false;
+}
+
+int HTTPClient::networkGET()
+{
+  if (client == nullptr || host.length() == 0)
+  {
+    return HTTPC_ERROR_NOT_CONNECTED;
+  }
+
+  // Over the open connection, discarding what is left of the last response
+  if (client->connected())
+  {
+    while (client->available() > 0)
+    {
+      client->read();
+    }
+  }
+  else if (!client->connect(host.c_str(), port))
+  {
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+
+  String request = String("GET ") + path + (http10 ? " HTTP/1.0\r\n" : " HTTP/1.1\r\n") + "Host: " + host +
+                   "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: " + (reuse ? "keep-alive" : "close") + "\r\n";
+  if (!http10)
+  {
+    request += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+  }
+  request += "\r\n";
+  if (client->write((const uint8_t *)request.c_str(), request.length()) != request.length())
+  {
+    client->stop();
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+
+  std::string line;
+  if (!readLine(line) || line.compare(0, 7, "HTTP/1.") != 0 || line.size() < 12)
+  {
+    client->stop();
+    return HTTPC_ERROR_CONNECTION_LOST;
+  }
+  int code = atoi(line.c_str() + 9);
+  can_reuse = reuse && line[7] != '0';
+  size = -1;
+  for (size_t i = 0; i < header_count; i++)
+  {
+    header_values[i] = "";
+  }
+
+  while (readLine(line) && !line.empty())
+  {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos)
+    {
+      continue;
+    }
+    std::string name = line.substr(0, colon);
+    size_t value_start = line.find_first_not_of(' ', colon + 1);
+    std::string value = value_start != std::string::npos ? line.substr(value_start) : "";
+
+    if (strcasecmp(name.c_str(), "Content-Length") == 0)
+    {
+      size = atoi(value.c_str());
+    }
+    else if (strcasecmp(name.c_str(), "Connection") == 0 && strcasestr(value.c_str(), "close") != nullptr)
+    {
+      can_reuse = false;
+    }
+    for (size_t i = 0; i < header_count; i++)
+    {
+      if (strcasecmp(header_names[i], name.c_str()) == 0)
+      {
+        header_values[i] = String(value);
+      }
+    }
+  }
+  if (!line.empty())
+  {
+    client->stop();
+    return HTTPC_ERROR_READ_TIMEOUT;
+  }
+  return code;
+}
+
+int HTTPClient::getSize()
+{
+  return canned ? (int)body.length() : size;
+}
+
+String HTTPClient::getString()
+{
+  if (canned)
+  {
+    return body;
+  }
+  String text;
+  char buffer[512];
+  size_t n;
+  int left = size;
+  while (client != nullptr && left != 0 &&
+         (n = client->readBytes(buffer, left > 0 && left < (int)sizeof(buffer) ? left : sizeof(buffer))) > 0)
+  {
+    text.concat(buffer, n);
+    left = left > 0 ? left - (int)n : left;
+  }
+  return text;
+}
+
+Stream &HTTPClient::getStream()
+{
+  if (canned || client == nullptr)
+  {
+    return stream;
+  }
+  return *client;
+}
+
+void HostBodyStream::reset(const String *response)
+{
+  body = response;
+  pos = 0;
+}
+
+// The rest of the current segment
+int HostBodyStream::available()
+{
+  size_t length = body ? body->length() : 0;
+  if (pos >= length)
+  {
+    return 0;
+  }
+  size_t in_segment = HOST_HTTP_SEGMENT - pos % HOST_HTTP_SEGMENT;
+  return (int)(in_segment < length - pos ? in_segment : length - pos);
+}
+
+int HostBodyStream::read()
+{
+  if (body == nullptr || pos >= body->length())
+  {
+    return -1;
+  }
+  return (uint8_t)body->c_str()[pos++];
+}
+
+int HostBodyStream::peek()
+{
+  if (body == nullptr || pos >= body->length())
+  {
+    return -1;
+  }
+  return (uint8_t)body->c_str()[pos];
+}
+
+size_t HostBodyStream::readBytes(char *buffer, size_t length)
+{
+  size_t left = body ? body->length() - pos : 0;
+  size_t n = length < left ? length : left;
+  if (n > 0)
+  {
+    memcpy(buffer, body->c_str() + pos, n);
+    pos += n;
+  }
+  return n;
+}
+
+// The connection stays open when reuse is allowed, as on the ESP32
+void HTTPClient::end()
+{
+  if (canned || client == nullptr || !client->connected())
+  {
+    return;
+  }
+  if (reuse && can_reuse)
+  {
+    while (client->available() > 0)
+    {
+      client->read();
+    }
+  }
+  else
+  {
+    client->stop();
+  }
+}
+
+// === File system ===
+
+size_t fs::File::read(uint8_t *buf, size_t size)
+{
+  return handle ? fread(buf, 1, size, handle) : 0;
+}
+
+size_t fs::File::write(const uint8_t *buf, size_t size)
+{
+  return handle ? fwrite(buf, 1, size, handle) : 0;
+}
+
+bool fs::File::seek(uint32_t pos, SeekMode mode)
+{
+  static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+  return handle && fseek(handle, (long)pos, whence[mode]) == 0;
+}
+
+size_t fs::File::position() const
+{
+  return handle ? (size_t)ftell(handle) : 0;
+}
+
+size_t fs::File::size() const
+{
+  struct stat st;
+  return (handle && fstat(fileno(handle), &st) == 0) ? (size_t)st.st_size : 0;
+}
+
+void fs::File::close()
+{
+  if (handle)
+  {
+    fclose(handle);
+    handle = nullptr;
+  }
+}
+
+fs::File fs::FS::open(const char *path, const char *mode)
+{
+  String full_path = root + path;
+  const char *stdio_mode = (mode[0] == 'w') ? "wb" : "rb";
+  return File(fopen(full_path.c_str(), stdio_mode));
+}
+
+bool fs::FS::exists(const char *path)
+{
+  struct stat st;
+  String full_path = root + path;
+  return stat(full_path.c_str(), &st) == 0;
+}
+
+bool fs::LittleFSFS::begin(bool format_on_fail)
+{
+  (void)format_on_fail;
+  return true;
+}
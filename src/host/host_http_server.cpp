@@ -0,0 +1,214 @@
+// Own header
+#include "host_http_server.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+// Body bytes per chunk of a chunked response
+#define HOST_SERVER_CHUNK 1024
+
+// Wait for the socket while the server runs: true when it is readable
+static bool wait_readable(int fd, const std::atomic<bool> &running)
+{
+  while (running)
+  {
+    struct pollfd p = {fd, POLLIN, 0};
+    int ready = poll(&p, 1, 50);
+    if (ready > 0)
+    {
+      return true;
+    }
+    if (ready < 0)
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+static void send_all(int fd, const std::string &data)
+{
+  size_t sent = 0;
+  while (sent < data.size())
+  {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      return;
+    }
+    sent += (size_t)n;
+  }
+}
+
+bool HostHttpServer::start()
+{
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+  {
+    return false;
+  }
+  int one = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 4) != 0 ||
+      getsockname(listen_fd, (struct sockaddr *)&addr, &len) != 0)
+  {
+    close(listen_fd);
+    listen_fd = -1;
+    return false;
+  }
+  port = ntohs(addr.sin_port);
+
+  running = true;
+  thread = std::thread(&HostHttpServer::run, this);
+  return true;
+}
+
+void HostHttpServer::stop()
+{
+  running = false;
+  if (thread.joinable())
+  {
+    thread.join();
+  }
+  if (listen_fd >= 0)
+  {
+    close(listen_fd);
+    listen_fd = -1;
+  }
+}
+
+void HostHttpServer::setBody(const String &text)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  body = text.c_str();
+}
+
+void HostHttpServer::setChunked(bool enabled)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  chunked = enabled;
+}
+
+void HostHttpServer::setRequestsPerConnection(uint32_t count, bool announce)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  requests_per_connection = count;
+  announce_close = announce;
+}
+
+void HostHttpServer::setDroppedRequest(uint32_t request)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  dropped_request = request;
+}
+
+void HostHttpServer::setResponseDelay(uint32_t ms)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  response_delay_ms = ms;
+}
+
+void HostHttpServer::resetCounts()
+{
+  connections = 0;
+  requests = 0;
+}
+
+void HostHttpServer::run()
+{
+  while (wait_readable(listen_fd, running))
+  {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd >= 0)
+    {
+      connections++;
+      serve(fd);
+      close(fd);
+    }
+  }
+}
+
+// Requests on one connection until either side closes it
+void HostHttpServer::serve(int fd)
+{
+  std::string received;
+  uint32_t served = 0;
+
+  while (true)
+  {
+    size_t header_end;
+    while ((header_end = received.find("\r\n\r\n")) == std::string::npos)
+    {
+      char buffer[1024];
+      ssize_t n = wait_readable(fd, running) ? recv(fd, buffer, sizeof(buffer), 0) : 0;
+      if (n <= 0)
+      {
+        return; // Closed by the client
+      }
+      received.append(buffer, (size_t)n);
+    }
+    std::string request = received.substr(0, header_end);
+    received.erase(0, header_end + 4);
+    requests++;
+    served++;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (dropped_request > 0 && served == dropped_request)
+    {
+      return;
+    }
+    bool client_closes = request.find("Connection: close") != std::string::npos;
+    bool last = client_closes || (requests_per_connection > 0 && served == requests_per_connection);
+
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n";
+    if (chunked)
+    {
+      response += "Transfer-Encoding: chunked\r\n";
+    }
+    else
+    {
+      response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    response += last && (announce_close || client_closes) ? "Connection: close\r\n\r\n" : "Connection: keep-alive\r\n\r\n";
+
+    if (chunked)
+    {
+      char size_line[16];
+      for (size_t pos = 0; pos < body.size(); pos += HOST_SERVER_CHUNK)
+      {
+        size_t n = body.size() - pos < HOST_SERVER_CHUNK ? body.size() - pos : HOST_SERVER_CHUNK;
+        snprintf(size_line, sizeof(size_line), "%zx\r\n", n);
+        response += size_line;
+        response.append(body, pos, n);
+        response += "\r\n";
+      }
+      response += "0\r\n\r\n";
+    }
+    else
+    {
+      response += body;
+    }
+    uint32_t delay_ms = response_delay_ms;
+    lock.unlock();
+
+    if (delay_ms > 0)
+    {
+      delay(delay_ms);
+    }
+    send_all(fd, response);
+    if (last)
+    {
+      return;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef HOST_HTTP_SERVER_H
+#define HOST_HTTP_SERVER_H
+
+// HTTP/1.1 server on 127.0.0.1 for the native runner (native builds only)
+// Answers every GET with the same body from a background thread, one
+// connection at a time, keeping connections open between requests. Options
+// make it close connections the ways real servers do, to test clients that
+// reuse them.
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+class HostHttpServer
+{
+public:
+  ~HostHttpServer() { stop(); }
+
+  // Listen on an ephemeral port; false if the socket could not be set up
+  bool start();
+  void stop();
+  uint16_t getPort() const { return port; }
+
+  void setBody(const String &body);
+
+  // Send the body chunked (Transfer-Encoding) instead of with Content-Length
+  void setChunked(bool chunked);
+
+  // Close a connection after `requests` responses (0 = never). With
+  // `announce` the last one says "Connection: close", otherwise the server
+  // just closes, as on an idle timeout.
+  void setRequestsPerConnection(uint32_t requests, bool announce);
+
+  // Close a connection without answering its `request`th request (0 = never),
+  // as when the idle timeout strikes while the request is on its way
+  void setDroppedRequest(uint32_t request);
+
+  // Wait this long before answering each request, as a server across the
+  // internet takes to respond
+  void setResponseDelay(uint32_t ms);
+
+  // Counters since start() or resetCounts()
+  uint32_t getConnections() const { return connections; }
+  uint32_t getRequests() const { return requests; }
+  void resetCounts();
+
+private:
+  int listen_fd = -1;
+  uint16_t port = 0;
+  std::thread thread;
+  std::atomic<bool> running{false};
+  std::mutex mutex; // Guards the options below
+  std::string body;
+  bool chunked = false;
+  uint32_t requests_per_connection = 0;
+  bool announce_close = false;
+  uint32_t dropped_request = 0;
+  uint32_t response_delay_ms = 0;
+  std::atomic<uint32_t> connections{0};
+  std::atomic<uint32_t> requests{0};
+
+  void run();
+  void serve(int fd);
+};
+
+#endif // HOST_HTTP_SERVER_H
@@ -0,0 +1,1940 @@
+// Headless benchmark runner for the native environment
+// Renders the weather screen into the framebuffer transport and replays a
+// series of recorded WeatherAPI.com responses, timing each
+// updateWeatherDisplay() call. Run from the project root so S:/icons/ resolves
+// to data/icons/.
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "debug.h"
+#include "host_http_server.h"
+#include "trace.h"
+#include "lvgl/lvgl_fs_spiffs.h"
+#include "lvgl/lvgl_png_stream.h"
+#include "lvgl/lvgl_setup.h"
+#include "lvgl/rgb565_swap.h"
+#include "lvgl/transport_framebuffer.h"
+#include "ui/static_layer_cache.h"
+#include "ui/ui_weather.h"
+#include "ui/weather_icons.h"
+#include "weather/json_allocator.h"
+#include "weather/weather_api.h"
+#include "weather/weather_task.h"
+
+#if DISPLAY_TRANSPORT != DISPLAY_TRANSPORT_FRAMEBUFFER
+#error "The native runner needs DISPLAY_TRANSPORT_FRAMEBUFFER"
+#endif
+
+// Number of passes over the recorded responses
+#define BENCH_PASSES 3
+
+// Full-screen refreshes timed per LVGL buffer strategy
+#define BENCH_STRATEGY_FRAMES 20
+
+// Icon changes timed per icon source
+#define BENCH_ICON_SWITCHES 48
+
+// Text changes timed per number label, without and with the glyph cache
+#define BENCH_LABEL_UPDATES 50
+
+// Fetches from the local server per connection behavior in the session check
+#define SESSION_CHECK_FETCHES 12
+
+// Snapshots the producer thread publishes in the handoff stress test
+#define SNAPSHOT_STRESS_PUBLISHES 1000000
+
+// Frame stall check: fetches per mode, the local server's response time
+// (about a WeatherAPI.com round trip), loop frames between fetches
+#define STALL_CHECK_FETCHES 4
+#define STALL_RESPONSE_DELAY_MS 150
+#define STALL_FRAME_MS 10
+#define STALL_FRAMES_PER_FETCH 10
+
+// Offline start check: the task's check interval, and how long to wait for
+// it to fail offline and then to fetch once the network is back
+#define OFFLINE_CHECK_INTERVAL_MS 20
+#define OFFLINE_CHECK_TIMEOUT_MS 3000
+
+// Flush ordering check: wire time of one fake DMA transfer, rows per band in
+// partial mode and per bounce buffer in direct mode
+#define FLUSH_CHECK_TRANSFER_US 200
+#define FLUSH_CHECK_BAND_ROWS 10
+#define FLUSH_CHECK_BOUNCE_ROWS 4
+
+// Passes over codes 1000..1282 timed per condition lookup
+#define BENCH_LOOKUP_PASSES 2000
+
+// Passes over the icon files timed per LVGL drive
+#define BENCH_DRIVE_PASSES 20
+
+// Passes over all condition PNGs decoded per LittleFS driver setting
+#define BENCH_PNG_LOAD_PASSES 5
+
+// Decoded icons the cache check may hold (64x64 ARGB8888 PNG decodes)
+#define CHECK_ICON_CACHE_ICONS 3
+// Icons looked up past ICON_CACHE_MAX_ENTRIES by the eviction check
+#define CHECK_ICON_CACHE_OVERFILL 2
+
+#if TRACE_ENABLED
+static void file_writer(const char *text, void *ctx)
+{
+  fputs(text, static_cast<FILE *>(ctx));
+}
+#endif
+
+// Recorded forecast.json responses: the values WeatherAPI reads, rebuilt into
+// a full days=1&aqi=yes response (location, current, the forecast day with
+// its astro data and 24 hourly entries)
+struct RecordedWeather
+{
+  int condition_code;
+  float temp_c;
+  int humidity;
+  float pm2_5;
+  int us_epa_index;
+  float mintemp_c;
+  float maxtemp_c;
+};
+
+static const RecordedWeather recorded_weather[] = {
+    {1000, 23.4f, 41, 12.3f, 1, 15.2f, 27.8f},
+    {1003, 21.9f, 48, 18.0f, 2, 14.8f, 26.1f},
+    {1063, 18.2f, 77, 35.6f, 2, 13.1f, 19.9f},
+    {1195, 14.6f, 93, 8.1f, 1, 11.0f, 16.4f},
+    {1087, 26.7f, 69, 55.4f, 3, 21.3f, 30.2f},
+    {1225, -4.1f, 85, 4.2f, 1, -9.6f, -1.8f},
+    {1135, 7.3f, 98, 101.7f, 4, 2.4f, 9.9f},
+    {1000, 23.4f, 41, 12.3f, 1, 15.2f, 27.8f}, // Unchanged update
+};
+
+static const int NUM_RECORDED = sizeof(recorded_weather) / sizeof(recorded_weather[0]);
+
+static void appendf(std::string &out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string &out, const char *format, ...)
+{
+  char piece[1024];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(piece, sizeof(piece), format, args);
+  va_end(args);
+  out += piece;
+}
+
+static void append_condition(std::string &out, int code, bool day)
+{
+  // Slashes escaped as some encoders do
+  appendf(out, "\"condition\":{\"text\":\"%s\",\"icon\":\"\\/\\/cdn.weatherapi.com\\/weather\\/64x64\\/%s\\/%d.png\","
+          "\"code\":%d}", WeatherIcons::getConditionDisplayName(code), day ? "day" : "night", code - 887, code);
+}
+
+static void append_air_quality(std::string &out, float pm2_5, int us_epa_index)
+{
+  appendf(out, "\"air_quality\":{\"co\":%.1f,\"no2\":%.1f,\"o3\":%.1f,\"so2\":%.1f,\"pm2_5\":%.1f,"
+          "\"pm10\":%.1f,\"us-epa-index\":%d,\"gb-defra-index\":%d}",
+          227.2f + pm2_5, 18.3f, 62.0f, 3.1f, pm2_5, pm2_5 * 1.4f, us_epa_index, us_epa_index + 1);
+}
+
+static void append_current(std::string &out, const RecordedWeather &w)
+{
+  appendf(out, "\"current\":{\"last_updated_epoch\":1755766800,\"last_updated\":\"2025-08-21 10:00\","
+          "\"temp_c\":%.1f,\"temp_f\":%.1f,\"is_day\":1,", w.temp_c, w.temp_c * 1.8f + 32);
+  append_condition(out, w.condition_code, true);
+  appendf(out, ",\"wind_mph\":8.1,\"wind_kph\":13.0,\"wind_degree\":243,\"wind_dir\":\"WSW\","
+          "\"pressure_mb\":1016.0,\"pressure_in\":30.0,\"precip_mm\":0.0,\"precip_in\":0.0,\"humidity\":%d,"
+          "\"cloud\":25,\"feelslike_c\":%.1f,\"feelslike_f\":%.1f,\"windchill_c\":%.1f,\"windchill_f\":%.1f,"
+          "\"heatindex_c\":%.1f,\"heatindex_f\":%.1f,\"dewpoint_c\":9.8,\"dewpoint_f\":49.6,\"vis_km\":10.0,"
+          "\"vis_miles\":6.0,\"uv\":4.2,\"gust_mph\":10.4,\"gust_kph\":16.7,",
+          w.humidity, w.temp_c, w.temp_c * 1.8f + 32, w.temp_c - 1, w.temp_c * 1.8f + 30, w.temp_c + 1,
+          w.temp_c * 1.8f + 34);
+  append_air_quality(out, w.pm2_5, w.us_epa_index);
+  out += "}";
+}
+
+static void append_forecast(std::string &out, const RecordedWeather &w)
+{
+  appendf(out, "\"forecast\":{\"forecastday\":[{\"date\":\"2025-08-21\",\"date_epoch\":1755734400,"
+          "\"day\":{\"maxtemp_c\":%.1f,\"maxtemp_f\":%.1f,\"mintemp_c\":%.1f,\"mintemp_f\":%.1f,"
+          "\"avgtemp_c\":%.1f,\"avgtemp_f\":%.1f,\"maxwind_mph\":11.6,\"maxwind_kph\":18.7,"
+          "\"totalprecip_mm\":0.4,\"totalprecip_in\":0.02,\"totalsnow_cm\":0.0,\"avgvis_km\":9.8,"
+          "\"avgvis_miles\":6.0,\"avghumidity\":%d,\"daily_will_it_rain\":0,\"daily_chance_of_rain\":12,"
+          "\"daily_will_it_snow\":0,\"daily_chance_of_snow\":0,",
+          w.maxtemp_c, w.maxtemp_c * 1.8f + 32, w.mintemp_c, w.mintemp_c * 1.8f + 32,
+          (w.mintemp_c + w.maxtemp_c) / 2, (w.mintemp_c + w.maxtemp_c) * 0.9f + 32, w.humidity);
+  append_condition(out, w.condition_code, true);
+  out += ",\"uv\":5.0,";
+  append_air_quality(out, w.pm2_5, w.us_epa_index);
+  out += "},\"astro\":{\"sunrise\":\"06:03 AM\",\"sunset\":\"08:11 PM\",\"moonrise\":\"03:25 AM\","
+         "\"moonset\":\"07:14 PM\",\"moon_phase\":\"Waning Crescent\",\"moon_illumination\":4,"
+         "\"is_moon_up\":0,\"is_sun_up\":1},\"hour\":[";
+
+  for (int h = 0; h < 24; h++)
+  {
+    float temp = w.mintemp_c + (w.maxtemp_c - w.mintemp_c) * (h < 14 ? h / 14.0f : (24 - h) / 10.0f);
+    bool day = h >= 6 && h < 20;
+    appendf(out, "%s{\"time_epoch\":%d,\"time\":\"2025-08-21 %02d:00\",\"temp_c\":%.1f,\"temp_f\":%.1f,"
+            "\"is_day\":%d,", h ? "," : "", 1755734400 + h * 3600, h, temp, temp * 1.8f + 32, day);
+    append_condition(out, w.condition_code, day);
+    appendf(out, ",\"wind_mph\":%.1f,\"wind_kph\":%.1f,\"wind_degree\":%d,\"wind_dir\":\"SW\","
+            "\"pressure_mb\":1015.0,\"pressure_in\":29.97,\"precip_mm\":0.0,\"precip_in\":0.0,\"snow_cm\":0.0,"
+            "\"humidity\":%d,\"cloud\":%d,\"feelslike_c\":%.1f,\"feelslike_f\":%.1f,\"windchill_c\":%.1f,"
+            "\"windchill_f\":%.1f,\"heatindex_c\":%.1f,\"heatindex_f\":%.1f,\"dewpoint_c\":10.1,"
+            "\"dewpoint_f\":50.2,\"will_it_rain\":0,\"chance_of_rain\":%d,\"will_it_snow\":0,"
+            "\"chance_of_snow\":0,\"vis_km\":10.0,\"vis_miles\":6.0,\"gust_mph\":%.1f,\"gust_kph\":%.1f,"
+            "\"uv\":%.1f,",
+            5.0f + h % 7, 8.0f + h % 7 * 1.6f, 200 + h * 3, w.humidity, h * 4 % 100, temp, temp * 1.8f + 32,
+            temp - 1, temp * 1.8f + 30, temp + 1, temp * 1.8f + 34, h * 3 % 100, 7.0f + h % 5, 11.3f + h % 5,
+            day ? h % 8 : 0.0f);
+    append_air_quality(out, w.pm2_5 + h % 3, w.us_epa_index);
+    out += "}";
+  }
+  out += "]}]}";
+}
+
+// Response layouts: members in WeatherAPI.com's order, or the forecast first
+enum PayloadOrder
+{
+  PAYLOAD_API_ORDER,
+  PAYLOAD_FORECAST_FIRST,
+};
+
+static String build_payload(const RecordedWeather &w, PayloadOrder order = PAYLOAD_API_ORDER)
+{
+  std::string body = "{\"location\":{\"name\":\"London\",\"region\":\"City of London, Greater London\","
+                     "\"country\":\"United Kingdom\",\"lat\":51.5171,\"lon\":-0.1062,\"tz_id\":\"Europe\\/London\","
+                     "\"localtime_epoch\":1755766800,\"localtime\":\"2025-08-21 10:00\"},";
+  if (order == PAYLOAD_API_ORDER)
+  {
+    append_current(body, w);
+    body += ",";
+    append_forecast(body, w);
+  }
+  else
+  {
+    append_forecast(body, w);
+    body += ",";
+    append_current(body, w);
+  }
+  body += "}";
+  return String(body);
+}
+
+// Current weather the buffered full-document parse gives for `body`, as the
+// streaming parse must (false if the body is not valid JSON)
+static bool parse_buffered(const String &body, WeatherData &out, uint32_t &peak_bytes)
+{
+  CountingJsonAllocator allocator;
+  JsonDocument doc(&allocator);
+  if (deserializeJson(doc, body))
+  {
+    return false;
+  }
+  peak_bytes = allocator.getPeakBytes() + body.length(); // The body is held as well
+
+  JsonObject current = doc["current"];
+  out.temperature = current["temp_c"].as<float>();
+  out.humidity = current["humidity"].as<int>();
+  out.air_quality_pm25 = current["air_quality"]["pm2_5"].as<int>();
+  out.air_quality_us_epa = current["air_quality"]["us-epa-index"].as<int>();
+  out.condition_code = current["condition"]["code"].as<int>();
+  out.temp_high = doc["forecast"]["forecastday"][0]["day"]["maxtemp_c"].as<float>();
+  out.temp_low = doc["forecast"]["forecastday"][0]["day"]["mintemp_c"].as<float>();
+  return true;
+}
+
+static bool same_weather(const WeatherData &a, const WeatherData &b)
+{
+  return a.temperature == b.temperature && a.humidity == b.humidity && a.air_quality_pm25 == b.air_quality_pm25 &&
+         a.air_quality_us_epa == b.air_quality_us_epa && a.condition_code == b.condition_code &&
+         a.temp_high == b.temp_high && a.temp_low == b.temp_low;
+}
+
+// Fetch `body` and expect the fetch to fail, leaving the weather unchanged
+static bool check_rejected(WeatherAPI &api, const String &body, const char *what)
+{
+  WeatherData before = api.getCurrentWeather();
+  HTTPClient::setResponse(200, body);
+  if (api.fetchWeatherData() || !same_weather(api.getCurrentWeather(), before))
+  {
+    LOG_ERRORF("Parse check: %s accepted\n", what);
+    return false;
+  }
+  return true;
+}
+
+// `body` with the first `what` from `from` on replaced by `with`
+static std::string replaced(std::string body, size_t from, const char *what, const char *with)
+{
+  return body.replace(body.find(what, from), strlen(what), with);
+}
+
+// Streamed parse of every recorded response in both member orders, by each
+// parser backend, against the buffered full-document parse: same fields, and
+// the input ends before the hourly forecast where the backend can tell.
+// Bodies cut short or malformed before the forecast day must fail.
+static bool run_parse_check(WeatherAPI &api)
+{
+  static const char *const order_names[] = {"API order", "forecast first"};
+  static const int parsers[] = {WEATHER_PARSER_ARDUINOJSON, WEATHER_PARSER_SCHEMA};
+
+  for (int order = PAYLOAD_API_ORDER; order <= PAYLOAD_FORECAST_FIRST; order++)
+  {
+    uint64_t buffered_us = 0;
+    uint32_t buffered_peak = 0;
+    uint64_t body_bytes = 0;
+    for (int i = 0; i < NUM_RECORDED; i++)
+    {
+      String body = build_payload(recorded_weather[i], static_cast<PayloadOrder>(order));
+      WeatherData expected = {};
+      uint32_t peak = 0;
+      unsigned long start = micros();
+      parse_buffered(body, expected, peak);
+      buffered_us += micros() - start;
+      buffered_peak = peak > buffered_peak ? peak : buffered_peak;
+      body_bytes += body.length();
+    }
+    LOG_INFOF("Forecast parse (%s): buffered ArduinoJson %5llu us, %6lu B peak, %llu B body\n", order_names[order],
+              (unsigned long long)(buffered_us / NUM_RECORDED), (unsigned long)buffered_peak,
+              (unsigned long long)(body_bytes / NUM_RECORDED));
+
+    for (size_t p = 0; p < sizeof(parsers) / sizeof(parsers[0]); p++)
+    {
+      api.setParser(parsers[p]);
+      uint64_t stream_us = 0;
+      uint64_t read_bytes = 0;
+      uint32_t stream_peak = 0;
+
+      for (int i = 0; i < NUM_RECORDED; i++)
+      {
+        String body = build_payload(recorded_weather[i], static_cast<PayloadOrder>(order));
+        WeatherData expected = {};
+        uint32_t peak = 0;
+        bool parsed = parse_buffered(body, expected, peak);
+
+        HTTPClient::setResponse(200, body);
+        if (!parsed || !api.fetchWeatherData())
+        {
+          LOG_ERRORF("Parse check: response %d (%s) not parsed by %s\n", i, order_names[order],
+                     WeatherAPI::getParserName(parsers[p]));
+          return false;
+        }
+
+        // The schema parser ends at the last field in either order
+        const WeatherParseStats &stats = api.getParseStats();
+        bool stop_expected = order == PAYLOAD_API_ORDER || parsers[p] == WEATHER_PARSER_SCHEMA;
+        if (!same_weather(api.getCurrentWeather(), expected) || stats.stopped_early != stop_expected ||
+            stats.total_bytes != (int32_t)body.length())
+        {
+          LOG_ERRORF("Parse check: response %d (%s) by %s differs from the full parse\n", i, order_names[order],
+                     WeatherAPI::getParserName(parsers[p]));
+          return false;
+        }
+        stream_us += stats.parse_us;
+        read_bytes += stats.body_bytes;
+        stream_peak = stats.peak_bytes > stream_peak ? stats.peak_bytes : stream_peak;
+      }
+
+      LOG_INFOF("Forecast parse (%s): streamed %-11s %5llu us, %6lu B peak, read %llu B\n", order_names[order],
+                WeatherAPI::getParserName(parsers[p]), (unsigned long long)(stream_us / NUM_RECORDED),
+                (unsigned long)stream_peak, (unsigned long long)(read_bytes / NUM_RECORDED));
+    }
+  }
+
+  std::string body = build_payload(recorded_weather[2]).c_str();
+  size_t current_at = body.find("\"current\"");
+  size_t hour_at = body.find("\"hour\"");
+  size_t humidity_at = body.find("\"humidity\"", current_at) + 11;
+  std::string malformed = body;
+  malformed[humidity_at] = '}';
+  std::string leading_zero = std::string(body).insert(humidity_at, "0");
+  std::string negative_zero = std::string(body).insert(humidity_at, "-0");
+  std::string bare_point = std::string(body).insert(body.find(',', humidity_at), ".");
+  std::string control = std::string(body).insert(body.find("\"text\":\"", current_at) + 8, "\t");
+
+  // Keys with escapes name the same members once decoded
+  std::string escaped_keys = replaced(body, current_at, "\"temp_c\"", "\"temp\\u005Fc\"");
+  escaped_keys = replaced(escaped_keys, current_at, "\"humidity\"", "\"hu\\u006didity\"");
+  escaped_keys = replaced(escaped_keys, current_at, "\"code\"", "\"c\\u006fde\"");
+  WeatherData escaped_expected = {};
+  uint32_t escaped_peak = 0;
+  if (!parse_buffered(String(escaped_keys), escaped_expected, escaped_peak) ||
+      escaped_expected.temperature != recorded_weather[2].temp_c ||
+      escaped_expected.humidity != recorded_weather[2].humidity)
+  {
+    LOG_ERROR("Parse check: escaped keys not decoded by the full parse");
+    return false;
+  }
+
+  for (size_t p = 0; p < sizeof(parsers) / sizeof(parsers[0]); p++)
+  {
+    api.setParser(parsers[p]);
+
+    // Cut inside the hourly forecast: everything needed was read
+    HTTPClient::setResponse(200, String(body.substr(0, hour_at + 200)));
+    if (!api.fetchWeatherData() || api.getCurrentWeather().condition_code != recorded_weather[2].condition_code)
+    {
+      LOG_ERRORF("Parse check: body cut in the hourly forecast rejected by %s\n",
+                 WeatherAPI::getParserName(parsers[p]));
+      return false;
+    }
+
+    if (!check_rejected(api, String(body.substr(0, current_at + 120)), "body cut in current") ||
+        !check_rejected(api, String(body.substr(0, body.find("\"forecast\""))), "body without forecast") ||
+        !check_rejected(api, String(malformed), "malformed body") ||
+        !check_rejected(api, String(""), "empty body") ||
+        !check_rejected(api, String(leading_zero), "number with a leading zero") ||
+        !check_rejected(api, String(negative_zero), "negative number with a leading zero") ||
+        !check_rejected(api, String(bare_point), "number ending in '.'") ||
+        !check_rejected(api, String(control), "control character in a string"))
+    {
+      return false;
+    }
+
+    HTTPClient::setResponse(200, String(escaped_keys));
+    if (!api.fetchWeatherData() || !same_weather(api.getCurrentWeather(), escaped_expected))
+    {
+      LOG_ERRORF("Parse check: escaped keys read differently by %s\n", WeatherAPI::getParserName(parsers[p]));
+      return false;
+    }
+  }
+  api.setParser(WEATHER_PARSER);
+  return true;
+}
+
+// Body positions between corpus variants, and the characters written into
+// the malformed ones
+#define CORPUS_CUT_STEP 97
+#define CORPUS_MUTATION_STEP 37
+static const char corpus_mutations[] = "}]:,\"x\\";
+
+// Outcome of one body through both backends
+struct ParserComparison
+{
+  uint32_t both_accepted;
+  uint32_t both_rejected;
+  uint32_t schema_only; // Cut or corrupted after the schema parser's last field
+};
+
+// Fetch `body` with each backend. Whatever the ArduinoJson path accepts the
+// schema parser must accept with the same values; the schema parser stops at
+// its last field, so it may also accept bodies ArduinoJson reads further into
+// and rejects, but only with the values of the intact response `reference`.
+static bool compare_parsers(WeatherAPI &api, const String &body, const WeatherData &reference,
+                            ParserComparison &result)
+{
+  api.setParser(WEATHER_PARSER_ARDUINOJSON);
+  HTTPClient::setResponse(200, body);
+  bool json_ok = api.fetchWeatherData();
+  WeatherData json = api.getCurrentWeather();
+
+  api.setParser(WEATHER_PARSER_SCHEMA);
+  HTTPClient::setResponse(200, body);
+  bool schema_ok = api.fetchWeatherData();
+  WeatherData schema = api.getCurrentWeather();
+
+  if (json_ok)
+  {
+    result.both_accepted++;
+    return schema_ok && same_weather(json, schema);
+  }
+  if (schema_ok)
+  {
+    result.schema_only++;
+    return same_weather(schema, reference);
+  }
+  result.both_rejected++;
+  return true;
+}
+
+// Both backends over the recorded responses in both orders, each also cut
+// every CORPUS_CUT_STEP bytes and with a structural character written every
+// CORPUS_MUTATION_STEP bytes
+static bool run_parser_comparison(WeatherAPI &api)
+{
+  ParserComparison result = {};
+  uint32_t mutation = 0;
+  bool ok = true;
+
+  Serial.setMuted(true); // Rejected bodies log errors
+  for (int order = PAYLOAD_API_ORDER; order <= PAYLOAD_FORECAST_FIRST && ok; order++)
+  {
+    for (int i = 0; i < NUM_RECORDED && ok; i++)
+    {
+      String intact = build_payload(recorded_weather[i], static_cast<PayloadOrder>(order));
+      std::string body = intact.c_str();
+      WeatherData reference = {};
+      uint32_t peak = 0;
+      ok = parse_buffered(intact, reference, peak) && compare_parsers(api, intact, reference, result);
+
+      for (size_t cut = 0; cut < body.size() && ok; cut += CORPUS_CUT_STEP)
+      {
+        ok = compare_parsers(api, String(body.substr(0, cut)), reference, result);
+      }
+      for (size_t at = 0; at < body.size() && ok; at += CORPUS_MUTATION_STEP)
+      {
+        std::string malformed = body;
+        malformed[at] = corpus_mutations[mutation++ % (sizeof(corpus_mutations) - 1)];
+        ok = compare_parsers(api, String(malformed), reference, result);
+      }
+      if (!ok)
+      {
+        Serial.setMuted(false);
+        LOG_ERRORF("Parser comparison: backends disagree on a variant of response %d\n", i);
+      }
+    }
+  }
+  Serial.setMuted(false);
+  api.setParser(WEATHER_PARSER);
+
+  LOG_INFOF("Parser comparison: %lu bodies, %lu accepted by both, %lu rejected by both, "
+            "%lu accepted by the schema parser only\n",
+            (unsigned long)(result.both_accepted + result.both_rejected + result.schema_only),
+            (unsigned long)result.both_accepted, (unsigned long)result.both_rejected,
+            (unsigned long)result.schema_only);
+  return ok;
+}
+
+// How the local server treats connections, and what the session must do
+struct SessionCase
+{
+  const char *name;
+  bool reuse;
+  bool chunked;
+  uint32_t requests_per_connection; // Server closes after this many (0 = never)
+  bool announce_close;              // ...saying "Connection: close"
+  uint32_t dropped_request;         // Server closes on this request unanswered
+  uint32_t connections;             // Expected for SESSION_CHECK_FETCHES fetches
+  int retries;                      // Expected, -1 if it depends on timing
+};
+
+static const SessionCase session_cases[] = {
+    {"new connection per fetch", false, false, 0, false, 0, SESSION_CHECK_FETCHES, 0},
+    {"keep-alive", true, false, 0, false, 0, 1, 0},
+    {"keep-alive, chunked", true, true, 0, false, 0, 1, 0},
+    {"Connection: close every 4", true, false, 4, true, 0, 3, 0},
+    // Usually noticed before the next request, otherwise resent
+    {"silent close every 4", true, false, 4, false, 0, 3, -1},
+    {"5th request dropped", true, true, 0, false, 5, 3, 2},
+};
+
+// WeatherAPI's HTTP session against a local server: every fetch parses the
+// served response (both parsers stop early, so the rest is drained), the
+// connection is reused as the server allows, and closed connections are
+// replaced without a failed fetch
+static bool run_session_check(WeatherAPI &api)
+{
+  HostHttpServer server;
+  if (!server.start())
+  {
+    LOG_ERROR("Session check: local server not started");
+    return false;
+  }
+  HTTPClient::clearResponse();
+  api.setEndpoint(String("http://localhost:") + String((unsigned int)server.getPort()) + "/v1/forecast.json");
+  HttpSession &session = api.getSession();
+  bool ok = true;
+  double fetch_new_us = 0;
+  double fetch_reused_us = 0;
+
+  for (size_t c = 0; c < sizeof(session_cases) / sizeof(session_cases[0]) && ok; c++)
+  {
+    const SessionCase &sc = session_cases[c];
+    server.setChunked(sc.chunked);
+    server.setRequestsPerConnection(sc.requests_per_connection, sc.announce_close);
+    server.setDroppedRequest(sc.dropped_request);
+    session.setReuse(sc.reuse);
+    session.close();
+    session.resetStats();
+    server.resetCounts();
+
+    uint64_t fetch_us = 0;
+    for (int f = 0; f < SESSION_CHECK_FETCHES && ok; f++)
+    {
+      String body = build_payload(recorded_weather[f % NUM_RECORDED]);
+      WeatherData expected = {};
+      uint32_t peak = 0;
+      parse_buffered(body, expected, peak);
+      server.setBody(body);
+      api.setParser(f % 2 ? WEATHER_PARSER_SCHEMA : WEATHER_PARSER_ARDUINOJSON);
+
+      unsigned long start = micros();
+      ok = api.fetchWeatherData() && same_weather(api.getCurrentWeather(), expected);
+      fetch_us += micros() - start;
+      if (!ok)
+      {
+        LOG_ERRORF("Session check (%s): fetch %d failed\n", sc.name, f);
+      }
+    }
+
+    const HttpSessionStats &st = session.getStats();
+    uint32_t reused = st.requests - st.connections;
+    LOG_INFOF("Session %-26s: %2lu fetches, %2lu connections, %lu retries, GET %5.0f us new, %5.0f us reused, "
+              "fetch %6.0f us, %6lu B drained\n",
+              sc.name, (unsigned long)st.requests, (unsigned long)st.connections, (unsigned long)st.retries,
+              st.connections ? (double)st.new_us / st.connections : 0.0, reused ? (double)st.reused_us / reused : 0.0,
+              (double)fetch_us / SESSION_CHECK_FETCHES, (unsigned long)st.drained_bytes);
+
+    if (ok && (st.requests != SESSION_CHECK_FETCHES || st.connections != sc.connections ||
+               server.getConnections() != sc.connections || (sc.retries >= 0 && st.retries != (uint32_t)sc.retries) ||
+               server.getRequests() != st.requests + st.retries))
+    {
+      LOG_ERRORF("Session check (%s): %lu connections (server %lu), %lu retries, server saw %lu requests\n", sc.name,
+                 (unsigned long)st.connections, (unsigned long)server.getConnections(), (unsigned long)st.retries,
+                 (unsigned long)server.getRequests());
+      ok = false;
+    }
+    if (c == 0)
+    {
+      fetch_new_us = (double)fetch_us / SESSION_CHECK_FETCHES;
+    }
+    else if (c == 1)
+    {
+      fetch_reused_us = (double)fetch_us / SESSION_CHECK_FETCHES;
+    }
+  }
+
+  if (ok)
+  {
+    LOG_INFOF("Session: keep-alive saves %.0f us per fetch on loopback (DNS and handshake on a network cost more)\n",
+              fetch_new_us - fetch_reused_us);
+  }
+
+  server.stop();
+  session.setReuse(WEATHER_HTTP_REUSE);
+  api.setEndpoint(WeatherAPIConfig().endpoint);
+  session.resetStats();
+  api.setParser(WEATHER_PARSER);
+  return ok;
+}
+
+// Every field derived from the publish number, so a snapshot mixing two
+// publishes shows
+static void fill_stress_snapshot(WeatherSnapshot &s, uint32_t n)
+{
+  s.weather.condition_code = 1000 + n % 283;
+  s.weather.temperature = n * 0.5f;
+  s.weather.temp_low = n;
+  s.weather.temp_high = n + 1.0f;
+  s.weather.humidity = n % 101;
+  s.weather.air_quality_pm25 = n * 3;
+  s.weather.air_quality_us_epa = n % 7;
+  s.weather.last_updated = String((unsigned long)n);
+  s.weather.valid = true;
+  s.fetch_time = n;
+  s.fetches = n;
+}
+
+static bool stress_snapshot_whole(const WeatherSnapshot &s)
+{
+  uint32_t n = s.fetches;
+  return s.weather.condition_code == (int)(1000 + n % 283) && s.weather.temperature == n * 0.5f &&
+         s.weather.temp_low == (float)n && s.weather.temp_high == n + 1.0f && s.weather.humidity == (int)(n % 101) &&
+         s.weather.air_quality_pm25 == (int)(n * 3) && s.weather.air_quality_us_epa == (int)(n % 7) &&
+         strtoul(s.weather.last_updated.c_str(), nullptr, 10) == n && s.weather.valid && s.fetch_time == (time_t)n;
+}
+
+// WeatherAPI's snapshot handoff between two threads publishing and taking as
+// fast as they can: every snapshot taken must come whole from one publish,
+// be newer than the one before and stay unchanged until the next take(); the
+// last publish must arrive. Both threads yield now and then so they also
+// interleave on a single core.
+static bool run_snapshot_stress()
+{
+  SnapshotBuffer<WeatherSnapshot> buffer;
+  std::atomic<bool> done{false};
+
+  unsigned long start = micros();
+  std::thread producer([&buffer, &done] {
+    for (uint32_t n = 1; n <= SNAPSHOT_STRESS_PUBLISHES; n++)
+    {
+      fill_stress_snapshot(buffer.writeSlot(), n);
+      buffer.publish();
+      if (n % 16 == 0)
+      {
+        std::this_thread::yield();
+      }
+    }
+    done = true;
+  });
+
+  uint32_t taken = 0;
+  uint32_t torn = 0;
+  uint32_t changed = 0;
+  uint32_t out_of_order = 0;
+  uint32_t last = 0;
+  while (true)
+  {
+    // Read first: once done, a take() after it sees the last publish
+    bool finished = done;
+    if (buffer.take())
+    {
+      const WeatherSnapshot &s = buffer.read();
+      torn += !stress_snapshot_whole(s);
+      out_of_order += s.fetches <= last;
+      last = s.fetches;
+      taken++;
+      // The producer runs meanwhile but must not write the taken slot
+      std::this_thread::yield();
+      changed += s.fetches != last || !stress_snapshot_whole(s);
+    }
+    else if (finished)
+    {
+      break;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  unsigned long elapsed = micros() - start;
+
+  LOG_INFOF("Snapshot stress: %lu published, %lu taken (rest overwritten unread), %lu torn, %lu changed while held, "
+            "%lu out of order, %.0f ns per publish\n",
+            (unsigned long)SNAPSHOT_STRESS_PUBLISHES, (unsigned long)taken, (unsigned long)torn,
+            (unsigned long)changed, (unsigned long)out_of_order, elapsed * 1000.0 / SNAPSHOT_STRESS_PUBLISHES);
+  return torn == 0 && changed == 0 && out_of_order == 0 && last == SNAPSHOT_STRESS_PUBLISHES;
+}
+
+// Until `done` or OFFLINE_CHECK_TIMEOUT_MS passed; false on the timeout
+template <typename Done>
+static bool wait_for(Done done)
+{
+  unsigned long start = millis();
+  while (!done())
+  {
+    if (millis() - start >= OFFLINE_CHECK_TIMEOUT_MS)
+    {
+      return false;
+    }
+    delay(5);
+  }
+  return true;
+}
+
+// WiFi down when the weather task starts, as when the board boots out of
+// range: the task keeps retrying at its checks and fetches once WiFi is up,
+// without being asked
+static bool run_offline_start_check(WeatherAPI &api)
+{
+  HostHttpServer server;
+  if (!server.start())
+  {
+    LOG_ERROR("Offline start check: local server not started");
+    return false;
+  }
+  HTTPClient::clearResponse();
+  api.setEndpoint(String("http://localhost:") + String((unsigned int)server.getPort()) + "/v1/forecast.json");
+  String body = build_payload(recorded_weather[2]);
+  server.setBody(body);
+  WeatherData expected = {};
+  uint32_t peak = 0;
+  parse_buffered(body, expected, peak);
+
+  WiFi.setStatus(WL_DISCONNECTED);
+  WeatherFetchTask task(api);
+  task.setCheckInterval(OFFLINE_CHECK_INTERVAL_MS);
+  task.start();
+
+  // The fetch at start and at least one retry fail without a request
+  bool ok = wait_for([&task] { return task.getFailures() >= 2; }) && task.getFetches() == 0 &&
+            !api.hasNewWeather() && server.getRequests() == 0;
+  if (!ok)
+  {
+    LOG_ERROR("Offline start check: fetches did not fail while offline");
+  }
+
+  WiFi.setStatus(WL_CONNECTED);
+  unsigned long online = millis();
+  if (ok && !(wait_for([&task] { return task.getFetches() >= 1; }) && api.hasNewWeather() &&
+              same_weather(api.getCurrentWeather(), expected)))
+  {
+    LOG_ERROR("Offline start check: no fetch after WiFi came up");
+    ok = false;
+  }
+  if (ok)
+  {
+    LOG_INFOF("Offline start: %lu failed fetches offline, weather %lu ms after WiFi came up\n",
+              (unsigned long)task.getFailures(), millis() - online);
+  }
+
+  task.stop();
+  server.stop();
+  api.setEndpoint(WeatherAPIConfig().endpoint);
+  return ok;
+}
+
+// Longest loop() iteration while STALL_CHECK_FETCHES responses are fetched
+// from `server`, each frame updating the UI if there is new weather and
+// running lv_timer_handler(). Without `task` the loop fetches inline as it
+// did before the weather task; with it the loop only takes the results.
+static bool measure_frame_stall(WeatherAPI &api, WeatherUI &ui, HostHttpServer &server, WeatherFetchTask *task,
+                                uint32_t &max_stall_us)
+{
+  int requested = 1;
+  server.setBody(build_payload(recorded_weather[0]));
+  if (task != nullptr)
+  {
+    task->start(); // First fetch right away
+  }
+
+  bool ok = true;
+  max_stall_us = 0;
+  for (int frame = 0;; frame++)
+  {
+    unsigned long start = micros();
+    if (task == nullptr)
+    {
+      if (frame % STALL_FRAMES_PER_FETCH == 0 && frame / STALL_FRAMES_PER_FETCH < STALL_CHECK_FETCHES)
+      {
+        server.setBody(build_payload(recorded_weather[frame / STALL_FRAMES_PER_FETCH]));
+        if (!api.fetchWeatherData())
+        {
+          return false;
+        }
+        ui.updateWeatherDisplay();
+      }
+    }
+    else if (api.hasNewWeather())
+    {
+      ui.updateWeatherDisplay();
+    }
+    lv_timer_handler();
+    uint32_t stall_us = micros() - start;
+    max_stall_us = stall_us > max_stall_us ? stall_us : max_stall_us;
+
+    if (task == nullptr)
+    {
+      if (frame / STALL_FRAMES_PER_FETCH >= STALL_CHECK_FETCHES - 1 &&
+          frame % STALL_FRAMES_PER_FETCH == STALL_FRAMES_PER_FETCH - 1)
+      {
+        break;
+      }
+    }
+    else
+    {
+      if (task->getFailures() > 0)
+      {
+        ok = false;
+        break;
+      }
+      // Next fetch once the last one was taken and a few frames passed
+      bool idle = (int)task->getFetches() == requested && !api.hasNewWeather();
+      if (idle && requested == STALL_CHECK_FETCHES)
+      {
+        break;
+      }
+      if (idle && frame % STALL_FRAMES_PER_FETCH == 0)
+      {
+        server.setBody(build_payload(recorded_weather[requested]));
+        requested++;
+        task->requestFetch();
+      }
+    }
+    delay(STALL_FRAME_MS);
+  }
+
+  if (task != nullptr)
+  {
+    task->stop();
+  }
+  WeatherData expected = {};
+  uint32_t peak = 0;
+  parse_buffered(build_payload(recorded_weather[STALL_CHECK_FETCHES - 1]), expected, peak);
+  return ok && same_weather(api.getCurrentWeather(), expected);
+}
+
+// UI frame stall during fetches from a server as slow as WeatherAPI.com:
+// fetching inline stalls a frame for the whole fetch, the weather task must
+// keep every frame well under the server's response time
+static bool run_frame_stall_check(WeatherAPI &api, WeatherUI &ui)
+{
+  HostHttpServer server;
+  if (!server.start())
+  {
+    LOG_ERROR("Frame stall check: local server not started");
+    return false;
+  }
+  server.setResponseDelay(STALL_RESPONSE_DELAY_MS);
+  HTTPClient::clearResponse();
+  api.setEndpoint(String("http://localhost:") + String((unsigned int)server.getPort()) + "/v1/forecast.json");
+
+  uint32_t inline_us = 0;
+  uint32_t task_us = 0;
+  WeatherFetchTask task(api);
+  bool ok = measure_frame_stall(api, ui, server, nullptr, inline_us) &&
+            measure_frame_stall(api, ui, server, &task, task_us);
+  if (ok)
+  {
+    LOG_INFOF("Frame stall over %d fetches (server answers in %d ms): inline %lu us max, weather task %lu us max\n",
+              STALL_CHECK_FETCHES, STALL_RESPONSE_DELAY_MS, (unsigned long)inline_us, (unsigned long)task_us);
+  }
+  else
+  {
+    LOG_ERROR("Frame stall check: a fetch failed or the UI did not get its result");
+  }
+  if (ok && task_us >= STALL_RESPONSE_DELAY_MS * 1000UL)
+  {
+    LOG_ERROR("Frame stall check: frames still wait for the fetch");
+    ok = false;
+  }
+
+  server.stop();
+  api.setEndpoint(WeatherAPIConfig().endpoint);
+  return ok;
+}
+
+// Asynchronous transport standing in for esp_lcd's SPI DMA: a thread sends the
+// queued transfers in order into a framebuffer, reading the pixels only at the
+// end of each, and counts every finished one the way EspLcdTransport's
+// interrupt does. poll() reports them.
+class FakeDmaTransport : public DisplayTransport
+{
+public:
+  FakeDmaTransport() : frame(SCREEN_WIDTH * SCREEN_HEIGHT, 0) {}
+  ~FakeDmaTransport()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wakeup.notify_one();
+    if (engine.joinable())
+    {
+      engine.join();
+    }
+  }
+
+  bool begin() override
+  {
+    engine = std::thread([this] { engineMain(); });
+    return true;
+  }
+
+  bool writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels) override
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back({x1, y1, x2, y2, pixels});
+    }
+    wakeup.notify_one();
+    return true;
+  }
+
+  bool isAsync() const override { return true; }
+  const char *name() const override { return "fake_dma"; }
+
+  void poll() override
+  {
+    uint32_t done = transfers_done.load(std::memory_order_acquire);
+    while (transfers_reported != done)
+    {
+      transfers_reported++;
+      notifyTransferDone();
+    }
+  }
+
+  // Keep queued transfers from starting
+  void hold(bool held)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->held = held;
+    }
+    wakeup.notify_one();
+  }
+
+  uint32_t getSent() const { return transfers_done.load(std::memory_order_acquire); }
+
+  // Valid for the transfers getSent() counts
+  const std::vector<const uint16_t *> &getSentBuffers() const { return sent_buffers; }
+  const std::vector<uint16_t> &getFrame() const { return frame; }
+
+private:
+  struct Transfer
+  {
+    int32_t x1, y1, x2, y2;
+    const uint16_t *pixels;
+  };
+
+  std::vector<uint16_t> frame;
+  std::vector<const uint16_t *> sent_buffers;
+  std::deque<Transfer> queue;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::thread engine;
+  bool held = false;
+  bool stopping = false;
+  std::atomic<uint32_t> transfers_done{0}; // Written by the engine only
+  uint32_t transfers_reported = 0;
+
+  void engineMain()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      wakeup.wait(lock, [this] { return stopping || (!held && !queue.empty()); });
+      if (stopping)
+      {
+        return;
+      }
+      Transfer t = queue.front();
+      queue.pop_front();
+      lock.unlock();
+
+      std::this_thread::sleep_for(std::chrono::microseconds(FLUSH_CHECK_TRANSFER_US));
+      const uint16_t *src = t.pixels;
+      for (int32_t y = t.y1; y <= t.y2; y++)
+      {
+        for (int32_t x = t.x1; x <= t.x2; x++)
+        {
+          frame[y * SCREEN_WIDTH + x] = *src++;
+        }
+      }
+      sent_buffers.push_back(t.pixels);
+      transfers_done.store(transfers_done.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+      lock.lock();
+    }
+  }
+};
+
+static uint16_t flush_check_pixel(int32_t x, int32_t y, uint16_t seed)
+{
+  return (uint16_t)(x * 7 + y * 131 + seed);
+}
+
+static bool flush_check_rows(const std::vector<uint16_t> &frame, int32_t y1, int32_t y2, uint16_t seed)
+{
+  for (int32_t y = y1; y <= y2; y++)
+  {
+    for (int32_t x = 0; x < SCREEN_WIDTH; x++)
+    {
+      if (frame[y * SCREEN_WIDTH + x] != flush_check_pixel(x, y, seed))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void flush_check_ready(void *user_ctx)
+{
+  (*static_cast<uint32_t *>(user_ctx))++;
+}
+
+// DisplayFlush on an asynchronous transport whose completions come from
+// another thread: a partial buffer goes back to LVGL only once its transfer
+// was sent and polled, never from the completing thread, and direct mode
+// never repacks a bounce buffer still on the wire
+static bool run_flush_ordering_check()
+{
+  FakeDmaTransport dma;
+  uint32_t ready = 0;
+  DisplayFlush flush(&dma, flush_check_ready, &ready);
+  flush.begin();
+  dma.begin();
+
+  // Partial: band A, then band B as the last of the frame
+  const int32_t band = FLUSH_CHECK_BAND_ROWS;
+  std::vector<uint16_t> band_a(SCREEN_WIDTH * band), band_b(SCREEN_WIDTH * band);
+  for (int32_t y = 0; y < band; y++)
+  {
+    for (int32_t x = 0; x < SCREEN_WIDTH; x++)
+    {
+      band_a[y * SCREEN_WIDTH + x] = flush_check_pixel(x, y, 1);
+      band_b[y * SCREEN_WIDTH + x] = flush_check_pixel(x, y + band, 1);
+    }
+  }
+
+  bool ok = true;
+  dma.hold(true);
+  flush.submit(0, 0, SCREEN_WIDTH - 1, band - 1, band_a.data(), false);
+  flush.poll();
+  if (ready != 0 || !flush.isBusy() || flush.getStats().overlapped != 1)
+  {
+    LOG_ERROR("Flush ordering: band released before its transfer was sent");
+    ok = false;
+  }
+  dma.hold(false);
+  while (dma.getSent() < 1)
+  {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (ok && (ready != 0 || !flush.isBusy()))
+  {
+    LOG_ERROR("Flush ordering: band released from the completing thread");
+    ok = false;
+  }
+  flush.poll();
+  if (ok && (ready != 1 || flush.isBusy()))
+  {
+    LOG_ERROR("Flush ordering: sent band not released by poll()");
+    ok = false;
+  }
+
+  flush.submit(0, band, SCREEN_WIDTH - 1, 2 * band - 1, band_b.data(), true);
+  flush.waitIdle();
+  const DisplayFlush::Stats &partial = flush.getStats();
+  if (ok && (ready != 2 || partial.frames != 1 || partial.buffer_swaps != 1 || partial.order_errors != 0 ||
+             partial.dropped != 0 || !flush_check_rows(dma.getFrame(), 0, 2 * band - 1, 1)))
+  {
+    LOG_ERROR("Flush ordering: partial bands out of order or not on the panel");
+    ok = false;
+  }
+
+  // Direct: a whole frame through two small bounce buffers
+  std::vector<uint16_t> frame(SCREEN_WIDTH * SCREEN_HEIGHT);
+  for (int32_t y = 0; y < SCREEN_HEIGHT; y++)
+  {
+    for (int32_t x = 0; x < SCREEN_WIDTH; x++)
+    {
+      frame[y * SCREEN_WIDTH + x] = flush_check_pixel(x, y, 2);
+    }
+  }
+  std::vector<uint16_t> bounce_a(SCREEN_WIDTH * FLUSH_CHECK_BOUNCE_ROWS);
+  std::vector<uint16_t> bounce_b(SCREEN_WIDTH * FLUSH_CHECK_BOUNCE_ROWS);
+  flush.setBounceBuffers(bounce_a.data(), bounce_b.data(), SCREEN_WIDTH * FLUSH_CHECK_BOUNCE_ROWS);
+  flush.resetStats();
+  uint32_t sent_before = dma.getSent();
+  unsigned long start = micros();
+  flush.submitRect(0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, frame.data(), SCREEN_WIDTH, true);
+  unsigned long packed_us = micros() - start;
+  uint32_t ready_after_pack = ready;
+  flush.waitIdle();
+  unsigned long sent_us = micros() - start;
+
+  const DisplayFlush::Stats &direct = flush.getStats();
+  uint32_t chunks = (SCREEN_HEIGHT + FLUSH_CHECK_BOUNCE_ROWS - 1) / FLUSH_CHECK_BOUNCE_ROWS;
+  bool alternating = dma.getSent() - sent_before == chunks;
+  const std::vector<const uint16_t *> &sent = dma.getSentBuffers();
+  for (uint32_t i = 0; alternating && i < chunks; i++)
+  {
+    alternating = sent[sent_before + i] == (i % 2 == 0 ? bounce_a.data() : bounce_b.data());
+  }
+  if (ok && (ready_after_pack != 3 || direct.commands != chunks || direct.dropped != 0 || direct.frames != 1 ||
+             !alternating || !flush_check_rows(dma.getFrame(), 0, SCREEN_HEIGHT - 1, 2)))
+  {
+    LOG_ERROR("Flush ordering: direct mode chunks out of order or overwritten on the wire");
+    ok = false;
+  }
+
+  if (ok)
+  {
+    LOG_INFOF("Flush ordering: partial bands released on poll, %lu direct chunks alternating, "
+              "packed in %lu us, sent in %lu us\n",
+              (unsigned long)chunks, packed_us, sent_us);
+  }
+  return ok;
+}
+
+// A card with one dynamic object more than the static layer can hide must be
+// drawn live instead of baked with that object; at the limit it is cached
+static bool run_static_layer_overflow_check()
+{
+  lv_obj_t *screen = lv_obj_create(NULL);
+  lv_obj_t *card = lv_obj_create(screen);
+  lv_obj_set_size(card, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+  for (int i = 0; i <= STATIC_LAYER_MAX_HIDDEN; i++)
+  {
+    lv_obj_t *label = lv_label_create(card);
+    lv_label_set_text(label, "x");
+  }
+
+  StaticLayerCache cache;
+  cache.setRoot(screen);
+  cache.addLayer(card);
+  cache.prepare();
+  bool overflow_live = !cache.isActive() && cache.getBuildCount() == 0;
+
+  lv_obj_delete(lv_obj_get_child(card, 0));
+  cache.invalidate();
+  cache.prepare();
+  bool limit_cached = cache.isActive() && cache.getBuildCount() == 1;
+
+  cache.setEnabled(false);
+  lv_obj_delete(screen);
+
+  if (!overflow_live)
+  {
+    LOG_ERRORF("Static layer: %d dynamic objects cached although only %d are hidden\n",
+               STATIC_LAYER_MAX_HIDDEN + 1, STATIC_LAYER_MAX_HIDDEN);
+  }
+  if (!limit_cached)
+  {
+    LOG_ERRORF("Static layer: not cached with %d dynamic objects\n", STATIC_LAYER_MAX_HIDDEN);
+  }
+  return overflow_live && limit_cached;
+}
+
+// Redraw saving of the weather screen's static layer; afterwards each layer
+// (container, cards) drawn live must have its own background and shadow again
+static bool run_static_layer_restore_check(StaticLayerCache &cache, uint32_t frames)
+{
+  lv_opa_t bg_opa[STATIC_LAYER_MAX_LAYERS];
+  int32_t shadow_width[STATIC_LAYER_MAX_LAYERS];
+  cache.invalidate();
+  for (uint32_t i = 0; i < cache.getLayerCount(); i++)
+  {
+    bg_opa[i] = lv_obj_get_style_bg_opa(cache.getLayer(i), LV_PART_MAIN);
+    shadow_width[i] = lv_obj_get_style_shadow_width(cache.getLayer(i), LV_PART_MAIN);
+  }
+
+  cache.measureSaving(frames);
+  cache.invalidate();
+  bool ok = true;
+  for (uint32_t i = 0; i < cache.getLayerCount(); i++)
+  {
+    lv_opa_t opa = lv_obj_get_style_bg_opa(cache.getLayer(i), LV_PART_MAIN);
+    int32_t shadow = lv_obj_get_style_shadow_width(cache.getLayer(i), LV_PART_MAIN);
+    if (opa != bg_opa[i] || shadow != shadow_width[i])
+    {
+      LOG_ERRORF("Static layer: layer %lu drawn with bg_opa %d, shadow %ld instead of %d, %ld\n",
+                 (unsigned long)i, opa, (long)shadow, bg_opa[i], (long)shadow_width[i]);
+      ok = false;
+    }
+  }
+  cache.prepare();
+  return ok;
+}
+
+struct UpdateSample
+{
+  uint32_t update_us; // Inside updateWeatherDisplay()
+  uint32_t render_us; // updateWeatherDisplay() plus the refresh it caused
+  uint32_t flushes;
+  uint64_t pixels;
+  AreaCoalescer::RefreshStats refresh;
+  uint32_t heap_used;
+  uint32_t heap_max_used;
+};
+
+static UpdateSample run_update(WeatherUI &ui, FramebufferTransport &fb);
+
+// FNV-1a over the framebuffer, to compare frames between passes
+static uint64_t framebuffer_hash(const FramebufferTransport &fb)
+{
+  const uint16_t *px = fb.getFramebuffer();
+  uint64_t hash = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < (uint32_t)fb.getWidth() * fb.getHeight(); i++)
+  {
+    hash = (hash ^ px[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Replay every recorded response once and return the refresh totals and the
+// frame after each update
+static bool run_coalescing_pass(WeatherAPI &api, WeatherUI &ui, FramebufferTransport &fb,
+                                bool enabled, AreaCoalescer::Totals &totals, uint64_t (&frames)[NUM_RECORDED])
+{
+  AreaCoalescer *coalescer = lvgl_get_area_coalescer();
+  coalescer->setEnabled(enabled);
+  coalescer->resetStats();
+
+  for (int i = 0; i < NUM_RECORDED; i++)
+  {
+    HTTPClient::setResponse(200, build_payload(recorded_weather[i]));
+    if (!api.fetchWeatherData())
+    {
+      return false;
+    }
+    run_update(ui, fb);
+    frames[i] = framebuffer_hash(fb);
+  }
+
+  totals = coalescer->getTotals();
+  return true;
+}
+
+// Same update sequence with LVGL's joining only, then with area coalescing:
+// coalescing must send fewer flushes or panel commands and draw the same
+// frames. The refresh label shows the fetch minute, so the passes are run
+// again if the minute changed in between.
+static bool run_coalescing_check(WeatherAPI &api, WeatherUI &ui, FramebufferTransport &fb)
+{
+  AreaCoalescer::Totals totals[2];
+  uint64_t frames[2][NUM_RECORDED];
+  bool same_frames = false;
+  for (int attempt = 0; attempt < 2 && !same_frames; attempt++)
+  {
+    time_t minute = time(nullptr) / 60;
+    for (int enabled = 0; enabled <= 1; enabled++)
+    {
+      if (!run_coalescing_pass(api, ui, fb, enabled, totals[enabled], frames[enabled]))
+      {
+        LOG_ERROR("Coalescing: replaying a response failed");
+        return false;
+      }
+    }
+    same_frames = memcmp(frames[0], frames[1], sizeof(frames[0])) == 0;
+    if (time(nullptr) / 60 == minute)
+    {
+      break;
+    }
+  }
+
+  for (int enabled = 0; enabled <= 1; enabled++)
+  {
+    const AreaCoalescer::Totals &t = totals[enabled];
+    LOG_INFOF("Coalescing %-3s: %lu refreshes, %lu invalidations -> %lu areas, %lu flushes, "
+              "%lu panel commands, %llu px\n",
+              enabled ? "on" : "off", (unsigned long)t.refreshes, (unsigned long)t.invalidated,
+              (unsigned long)t.areas, (unsigned long)t.flushes, (unsigned long)t.commands,
+              (unsigned long long)t.pixels);
+  }
+  lvgl_get_area_coalescer()->setEnabled(DISPLAY_AREA_COALESCING);
+
+  if (!same_frames)
+  {
+    LOG_ERROR("Coalescing: frames differ from LVGL's joining only");
+    return false;
+  }
+  if (totals[1].flushes >= totals[0].flushes && totals[1].commands >= totals[0].commands)
+  {
+    LOG_ERROR("Coalescing: no fewer flushes or panel commands than LVGL's joining only");
+    return false;
+  }
+  return true;
+}
+
+// Every condition, day and night, twice through a small icon cache: every
+// lookup must succeed and the held bytes must never exceed the budget
+static bool run_icon_cache_check()
+{
+  const uint32_t budget = CHECK_ICON_CACHE_ICONS * 64 * 64 * 4;
+  IconCache cache(budget);
+  uint32_t lookups = 0;
+
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (int i = 0; i < WeatherIcons::getConditionCount(); i++)
+    {
+      for (int day = 1; day >= 0; day--)
+      {
+        char path[ICON_CACHE_PATH_LEN];
+        snprintf(path, sizeof(path), "S:%s", WeatherIcons::getPNGPath(WeatherIcons::getConditionCode(i), day));
+        if (cache.get(path) == nullptr)
+        {
+          LOG_ERRORF("Icon cache: %s not cached\n", path);
+          return false;
+        }
+        if (cache.getStats().bytes > budget)
+        {
+          LOG_ERRORF("Icon cache: %lu B held, budget %lu B\n",
+                     (unsigned long)cache.getStats().bytes, (unsigned long)budget);
+          return false;
+        }
+        lookups++;
+      }
+    }
+  }
+
+  const IconCache::Stats &c = cache.getStats();
+  LOG_INFOF("Icon cache: %lu lookups, %lu hits, %lu misses, %lu evictions, peak %lu B of %lu B\n",
+            (unsigned long)lookups, (unsigned long)c.hits, (unsigned long)c.misses,
+            (unsigned long)c.evictions, (unsigned long)c.peak_bytes, (unsigned long)budget);
+  return c.hits + c.misses == lookups && c.evictions > 0 && c.peak_bytes <= budget;
+}
+
+// Distinct condition icons past the entry limit, within the byte budget:
+// each one past the limit must evict exactly one entry, the least recently
+// used, never the first icon looked up again before the overfill
+static bool run_icon_cache_eviction_check()
+{
+  const int icons = ICON_CACHE_MAX_ENTRIES + CHECK_ICON_CACHE_OVERFILL;
+  std::vector<std::string> paths;
+  for (int i = 0; i < WeatherIcons::getConditionCount() && (int)paths.size() < icons; i++)
+  {
+    for (int day = 1; day >= 0; day--)
+    {
+      std::string path = std::string("S:") + WeatherIcons::getPNGPath(WeatherIcons::getConditionCode(i), day);
+      bool seen = false;
+      for (const std::string &p : paths)
+      {
+        seen = seen || p == path;
+      }
+      if (!seen && (int)paths.size() < icons)
+      {
+        paths.push_back(path);
+      }
+    }
+  }
+  if ((int)paths.size() < icons)
+  {
+    LOG_ERRORF("Icon cache: %d distinct icons, %d needed\n", (int)paths.size(), icons);
+    return false;
+  }
+
+  IconCache cache(icons * 64 * 64 * 4);
+  for (int i = 0; i < ICON_CACHE_MAX_ENTRIES; i++)
+  {
+    if (cache.get(paths[i].c_str()) == nullptr)
+    {
+      LOG_ERRORF("Icon cache: %s not cached\n", paths[i].c_str());
+      return false;
+    }
+  }
+  cache.get(paths[0].c_str()); // paths[1] is the least recently used now
+  for (int i = ICON_CACHE_MAX_ENTRIES; i < icons; i++)
+  {
+    cache.get(paths[i].c_str());
+  }
+
+  const IconCache::Stats &c = cache.getStats();
+  uint32_t evictions = c.evictions;
+  if (evictions != CHECK_ICON_CACHE_OVERFILL || c.entries != ICON_CACHE_MAX_ENTRIES)
+  {
+    LOG_ERRORF("Icon cache: %lu evictions, %lu entries after %d icons\n", (unsigned long)evictions,
+               (unsigned long)c.entries, icons);
+    return false;
+  }
+
+  // Survivors are hits, then the evicted ones misses (evicting others)
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (int i = 0; i < icons; i++)
+    {
+      bool evicted = i >= 1 && i <= CHECK_ICON_CACHE_OVERFILL;
+      if (evicted != (pass == 1))
+      {
+        continue;
+      }
+      uint32_t misses = c.misses;
+      cache.get(paths[i].c_str());
+      if ((c.misses != misses) != evicted)
+      {
+        LOG_ERRORF("Icon cache: %s %s\n", paths[i].c_str(), evicted ? "not evicted" : "evicted");
+        return false;
+      }
+    }
+  }
+  LOG_INFOF("Icon cache: %d icons in %d entries, %lu evictions, least recently used first\n", icons,
+            ICON_CACHE_MAX_ENTRIES, (unsigned long)evictions);
+  return true;
+}
+
+// Every condition PNG drawn by LVGL into the render bands, decoded whole by
+// LODEPNG and then streamed strip by strip: the frames must be identical
+static bool run_png_stream_draw_check(FramebufferTransport &fb)
+{
+  char path[ICON_CACHE_PATH_LEN];
+  size_t frame_bytes = (size_t)fb.getWidth() * fb.getHeight() * sizeof(uint16_t);
+  uint16_t *reference = static_cast<uint16_t *>(malloc(frame_bytes));
+  if (reference == nullptr)
+  {
+    return false;
+  }
+
+  lv_obj_t *img = lv_image_create(lv_layer_top());
+  lv_obj_center(img);
+  bool stream_enabled = lvgl_png_stream_get_enabled();
+  lvgl_png_stream_reset_stats();
+
+  bool ok = true;
+  for (int i = 0; i < WeatherIcons::getConditionCount() && ok; i++)
+  {
+    snprintf(path, sizeof(path), "S:%s", WeatherIcons::getPNGPath(WeatherIcons::getConditionCode(i), i & 1));
+    lv_image_set_src(img, path);
+    for (int stream = 0; stream <= 1; stream++)
+    {
+      lvgl_png_stream_set_enabled(stream);
+      lv_obj_invalidate(img);
+      lv_refr_now(NULL);
+      if (!stream)
+      {
+        memcpy(reference, fb.getFramebuffer(), frame_bytes);
+      }
+      else if (memcmp(reference, fb.getFramebuffer(), frame_bytes) != 0)
+      {
+        LOG_ERRORF("PNG stream: %s drawn differently than by LODEPNG\n", path);
+        ok = false;
+      }
+    }
+  }
+
+  lv_obj_delete(img);
+  lv_refr_now(NULL);
+  lvgl_png_stream_set_enabled(stream_enabled);
+  free(reference);
+
+  const PngStreamStats &p = lvgl_png_stream_get_stats();
+  LOG_INFOF("PNG stream draw: %lu streams, %lu resumed, %lu rows, %lu rows skipped, peak %lu B\n",
+            (unsigned long)p.opens, (unsigned long)p.resumes, (unsigned long)p.rows, (unsigned long)p.skipped,
+            (unsigned long)p.peak_bytes);
+  return ok && p.rows > 0;
+}
+
+// Reference for the dense index: scan the map rows
+static int find_condition_linear(int code)
+{
+  for (int i = 0; i < WeatherIcons::getConditionCount(); i++)
+  {
+    if (WeatherIcons::getConditionCode(i) == code)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Dense index against the linear scan for one code; unknown codes fall back
+// to "Unknown" and the sunny icon
+static bool check_condition_lookup(int code)
+{
+  int row = WeatherIcons::findConditionIndex(code);
+  if (row != find_condition_linear(code))
+  {
+    LOG_ERRORF("Condition %d: row %d, linear scan %d\n", code, row, find_condition_linear(code));
+    return false;
+  }
+
+  const char *name = WeatherIcons::getConditionDisplayName(code);
+  const char *path = WeatherIcons::getPNGPath(code, false);
+  bool unknown = strcmp(name, "Unknown") == 0;
+  bool ok = row < 0 ? unknown && WeatherIcons::getPNGPath(code, true) == WeatherIcons::getPNGPath(1000, true)
+                    : !unknown && strncmp(path, "/icons/night_", 13) == 0;
+  if (!ok)
+  {
+    LOG_ERRORF("Condition %d: \"%s\", %s\n", code, name, path);
+  }
+  return ok;
+}
+
+// Every code from 1000 to 1282 and a few outside, then time both lookups
+static bool run_condition_lookup_check()
+{
+  static const int outside[] = {-1, 0, 999, 1283, 2000, 0x7FFFFFFF};
+  int known = 0;
+
+  for (int code = 1000; code <= 1282; code++)
+  {
+    if (!check_condition_lookup(code))
+    {
+      return false;
+    }
+    known += WeatherIcons::findConditionIndex(code) >= 0;
+  }
+  for (size_t i = 0; i < sizeof(outside) / sizeof(outside[0]); i++)
+  {
+    if (!check_condition_lookup(outside[i]))
+    {
+      return false;
+    }
+  }
+
+  volatile int sink = 0;
+  unsigned long start = micros();
+  for (int pass = 0; pass < BENCH_LOOKUP_PASSES; pass++)
+  {
+    for (int code = 1000; code <= 1282; code++)
+    {
+      sink += WeatherIcons::findConditionIndex(code);
+    }
+  }
+  unsigned long dense_us = micros() - start;
+
+  start = micros();
+  for (int pass = 0; pass < BENCH_LOOKUP_PASSES; pass++)
+  {
+    for (int code = 1000; code <= 1282; code++)
+    {
+      sink += find_condition_linear(code);
+    }
+  }
+  unsigned long linear_us = micros() - start;
+  (void)sink; // Keeps the loops
+
+  uint32_t lookups = BENCH_LOOKUP_PASSES * 283;
+  LOG_INFOF("Condition lookup: %d of 283 codes known, dense %.1f ns, linear scan %.1f ns per lookup\n",
+            known, dense_us * 1000.0 / lookups, linear_us * 1000.0 / lookups);
+  return known == WeatherIcons::getConditionCount();
+}
+
+// Open, read and close `path` through its LVGL drive; bytes read, 0 on failure
+static uint32_t read_through_drive(const char *path, uint8_t *buf, uint32_t size)
+{
+  lv_fs_file_t file;
+  if (lv_fs_open(&file, path, LV_FS_MODE_RD) != LV_FS_RES_OK)
+  {
+    return 0;
+  }
+
+  uint32_t total = 0;
+  uint32_t n = 0;
+  while (lv_fs_read(&file, buf, size, &n) == LV_FS_RES_OK && n > 0)
+  {
+    total += n;
+  }
+  lv_fs_close(&file);
+  return total;
+}
+
+static void log_drive_reads(const char *name, uint32_t opens, uint64_t bytes, unsigned long us)
+{
+  LOG_INFOF("Drive %-12s: %5lu opens, %8llu B, %6.2f us/open, %7.1f MB/s\n", name, (unsigned long)opens,
+            (unsigned long long)bytes, (double)us / opens, us > 0 ? (double)bytes / us : 0.0);
+}
+
+// Icon files through the LittleFS driver (S:, PNG) vs the mapped asset
+// partition (A:, .bin entries read, then referenced in place)
+static bool run_asset_drive_benchmark()
+{
+  IconAtlas *assets = WeatherIcons::getAtlas(ICON_SOURCE_ASSETS);
+  if (assets == nullptr)
+  {
+    LOG_INFO("Drive benchmark: skipped, no asset partition image (resources/compile_icons.py)");
+    return true;
+  }
+
+  static uint8_t buf[4096];
+  char path[ICON_CACHE_PATH_LEN];
+  uint32_t opens = 0;
+  uint64_t bytes = 0;
+
+  unsigned long start = micros();
+  for (int pass = 0; pass < BENCH_DRIVE_PASSES; pass++)
+  {
+    for (int i = 0; i < WeatherIcons::getConditionCount(); i++)
+    {
+      snprintf(path, sizeof(path), "S:%s", WeatherIcons::getPNGPath(WeatherIcons::getConditionCode(i), pass & 1));
+      bytes += read_through_drive(path, buf, sizeof(buf));
+      opens++;
+    }
+  }
+  log_drive_reads("littlefs S:", opens, bytes, micros() - start);
+
+  opens = 0;
+  bytes = 0;
+  start = micros();
+  for (int pass = 0; pass < BENCH_DRIVE_PASSES; pass++)
+  {
+    for (uint32_t i = 0; i < lvgl_fs_atlas_count(assets); i++)
+    {
+      lvgl_fs_atlas_src(assets, i, path, sizeof(path));
+      uint32_t n = read_through_drive(path, buf, sizeof(buf));
+      if (n != lvgl_fs_atlas_entry(assets, i)->size)
+      {
+        LOG_ERRORF("Drive: %s read %lu B\n", path, (unsigned long)n);
+        return false;
+      }
+      bytes += n;
+      opens++;
+    }
+  }
+  log_drive_reads("mapped A:", opens, bytes, micros() - start);
+
+  // In place: the decoder only references the mapped pixels
+  opens = 0;
+  bytes = 0;
+  start = micros();
+  for (int pass = 0; pass < BENCH_DRIVE_PASSES; pass++)
+  {
+    for (uint32_t i = 0; i < lvgl_fs_atlas_count(assets); i++)
+    {
+      lv_image_decoder_dsc_t dsc;
+      if (lv_image_decoder_open(&dsc, lvgl_fs_atlas_image(assets, i), NULL) != LV_RESULT_OK)
+      {
+        LOG_ERRORF("Drive: entry %lu not decodable in place\n", (unsigned long)i);
+        return false;
+      }
+      bytes += dsc.decoded != nullptr ? dsc.decoded->data_size : 0;
+      lv_image_decoder_close(&dsc);
+      opens++;
+    }
+  }
+  log_drive_reads("in place A:", opens, bytes, micros() - start);
+  return true;
+}
+
+// Every condition PNG decoded from S: (LODEPNG) with the driver reading
+// through, then with read-ahead and the directory cache
+static bool run_png_load_benchmark()
+{
+  char path[ICON_CACHE_PATH_LEN];
+
+  for (int caching = 0; caching <= 1; caching++)
+  {
+    lvgl_fs_spiffs_set_read_ahead(caching ? LVGL_FS_READ_AHEAD : 0);
+    lvgl_fs_spiffs_set_dir_cache(caching);
+    lvgl_fs_spiffs_reset_stats();
+
+    uint32_t loads = 0;
+    unsigned long start = micros();
+    for (int pass = 0; pass < BENCH_PNG_LOAD_PASSES; pass++)
+    {
+      for (int i = 0; i < WeatherIcons::getConditionCount(); i++)
+      {
+        snprintf(path, sizeof(path), "S:%s", WeatherIcons::getPNGPath(WeatherIcons::getConditionCode(i), pass & 1));
+        lv_image_decoder_dsc_t dsc;
+        if (lv_image_decoder_open(&dsc, path, NULL) != LV_RESULT_OK)
+        {
+          LOG_ERRORF("PNG load: %s failed\n", path);
+          return false;
+        }
+        lv_image_decoder_close(&dsc);
+        loads++;
+      }
+    }
+    unsigned long elapsed = micros() - start;
+
+    const LvglFsStats &f = lvgl_fs_spiffs_get_stats();
+    LOG_INFOF("PNG load %-8s: %lu loads, avg %lu us (driver %llu us), %lu opens (%lu dir hits), "
+              "%lu reads -> %lu LittleFS reads, %lu seeks, %llu B\n",
+              caching ? "cached" : "direct", (unsigned long)loads, (unsigned long)(elapsed / loads),
+              (unsigned long long)(f.time_us / loads), (unsigned long)f.opens, (unsigned long)f.dir_hits,
+              (unsigned long)f.reads, (unsigned long)f.fs_reads, (unsigned long)f.seeks,
+              (unsigned long long)f.bytes);
+  }
+  return true;
+}
+
+static UpdateSample run_update(WeatherUI &ui, FramebufferTransport &fb)
+{
+  UpdateSample sample;
+
+  fb.resetStats();
+  unsigned long start = micros();
+  ui.updateWeatherDisplay();
+  unsigned long updated = micros();
+  lv_refr_now(NULL);
+  unsigned long rendered = micros();
+
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+
+  sample.update_us = updated - start;
+  sample.render_us = rendered - start;
+  sample.flushes = fb.getStats().flushes;
+  sample.pixels = fb.getStats().pixels;
+  sample.refresh = lvgl_get_area_coalescer()->getLastRefresh();
+  sample.heap_used = mon.total_size - mon.free_size;
+  sample.heap_max_used = mon.max_used;
+  return sample;
+}
+
+int main()
+{
+  LOG_INFOF("=== Native render benchmark (%s, %dx%d) ===\n",
+            DISPLAY_HORIZONTAL ? "horizontal" : "vertical", SCREEN_WIDTH, SCREEN_HEIGHT);
+
+  // Swap/pack kernel: verify against the reference and measure throughput
+  if (!rgb565_swap_benchmark(SCREEN_WIDTH * SCREEN_HEIGHT, 500))
+  {
+    return 1;
+  }
+
+  if (!run_condition_lookup_check())
+  {
+    LOG_ERROR("Condition lookup check failed");
+    return 1;
+  }
+
+  if (!run_flush_ordering_check())
+  {
+    LOG_ERROR("Flush ordering check failed");
+    return 1;
+  }
+
+  lvgl_setup();
+  FramebufferTransport &fb = *static_cast<FramebufferTransport *>(lvgl_get_transport());
+
+  WeatherAPI weather_api;
+  weather_api.init();
+  if (!run_parse_check(weather_api) || !run_parser_comparison(weather_api))
+  {
+    LOG_ERROR("Forecast parse check failed");
+    return 1;
+  }
+  if (!run_session_check(weather_api))
+  {
+    LOG_ERROR("HTTP session check failed");
+    return 1;
+  }
+  if (!run_snapshot_stress())
+  {
+    LOG_ERROR("Snapshot handoff stress test failed");
+    return 1;
+  }
+  if (!run_offline_start_check(weather_api))
+  {
+    LOG_ERROR("Offline start check failed");
+    return 1;
+  }
+
+  WeatherUI weather_ui(&weather_api);
+  weather_ui.createWeatherScreen();
+  weather_ui.showWeatherScreen();
+
+  fb.resetStats();
+  unsigned long start = micros();
+  lv_refr_now(NULL);
+  LOG_INFOF("Initial screen: %lu us, %llu px in %lu flushes\n",
+            micros() - start, (unsigned long long)fb.getStats().pixels,
+            (unsigned long)fb.getStats().flushes);
+
+  // Weather task vs fetching inline in the loop
+  if (!run_frame_stall_check(weather_api, weather_ui))
+  {
+    LOG_ERROR("Frame stall check failed");
+    return 1;
+  }
+
+  lvgl_benchmark_buffer_strategies(BENCH_STRATEGY_FRAMES);
+
+  uint64_t total_render_us = 0;
+  uint32_t max_render_us = 0;
+  int samples = 0;
+
+  for (int pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (int i = 0; i < NUM_RECORDED; i++)
+    {
+      const RecordedWeather &w = recorded_weather[i];
+      HTTPClient::setResponse(200, build_payload(w));
+      if (!weather_api.fetchWeatherData())
+      {
+        LOG_ERRORF("Replaying response %d failed\n", i);
+        return 1;
+      }
+
+      UpdateSample s = run_update(weather_ui, fb);
+      LOG_INFOF("pass %d code %4d: update %6lu us, render %7lu us, areas %2lu->%2lu, %3lu flushes, "
+                "%7llu px, lv heap %6lu B (max %6lu B)\n",
+                pass, w.condition_code, (unsigned long)s.update_us, (unsigned long)s.render_us,
+                (unsigned long)s.refresh.invalidated, (unsigned long)s.refresh.areas,
+                (unsigned long)s.flushes, (unsigned long long)s.pixels,
+                (unsigned long)s.heap_used, (unsigned long)s.heap_max_used);
+
+      total_render_us += s.render_us;
+      if (s.render_us > max_render_us)
+      {
+        max_render_us = s.render_us;
+      }
+      samples++;
+    }
+  }
+
+  LOG_INFOF("Summary: %d updates, avg render %llu us, max render %lu us\n",
+            samples, (unsigned long long)(total_render_us / samples), (unsigned long)max_render_us);
+
+  const UiTransaction::Stats &u = weather_ui.getUpdateStats();
+  LOG_INFOF("UI updates: %lu commits, %lu changes applied, %lu unchanged skipped, "
+            "blocked avg %llu us, max %lu us\n",
+            (unsigned long)u.commits, (unsigned long)u.applied, (unsigned long)u.skipped,
+            (unsigned long long)(u.total_blocked_us / (u.commits ? u.commits : 1)),
+            (unsigned long)u.max_blocked_us);
+
+  // Same update sequence with LVGL's joining only, then with area coalescing
+  if (!run_coalescing_check(weather_api, weather_ui, fb))
+  {
+    LOG_ERROR("Coalescing check failed");
+    return 1;
+  }
+
+  // Icon switches: PNG decode vs .bin vs compiled vs atlas vs mapped partition
+  // vs QOI vs opaque, then alpha vs opaque draw time, then every condition
+  // in every icon set size
+  if (!weather_ui.benchmarkIcons(BENCH_ICON_SWITCHES))
+  {
+    LOG_ERROR("Streamed PNG or QOI icons do not match LODEPNG, opaque icons the card, or an icon set is incomplete");
+    return 1;
+  }
+
+  if (!run_png_load_benchmark())
+  {
+    LOG_ERROR("PNG load benchmark failed");
+    return 1;
+  }
+
+  if (!run_asset_drive_benchmark())
+  {
+    LOG_ERROR("Asset drive benchmark failed");
+    return 1;
+  }
+
+  if (!run_icon_cache_check())
+  {
+    LOG_ERROR("Icon cache check failed");
+    return 1;
+  }
+
+  if (!run_icon_cache_eviction_check())
+  {
+    LOG_ERROR("Icon cache eviction check failed");
+    return 1;
+  }
+
+  if (!run_png_stream_draw_check(fb))
+  {
+    LOG_ERROR("PNG stream draw check failed");
+    return 1;
+  }
+
+  // Subset fonts: every text the labels show has its glyphs; label update time
+  if (!weather_ui.benchmarkLabels(BENCH_LABEL_UPDATES))
+  {
+    LOG_ERROR("Label font or glyph cache check failed");
+    return 1;
+  }
+
+  // Redraw of the dynamic objects with the cards drawn live vs from the static layer
+  if (!run_static_layer_restore_check(weather_ui.getStaticLayerCache(), BENCH_STRATEGY_FRAMES))
+  {
+    LOG_ERROR("Static layer restore check failed");
+    return 1;
+  }
+  if (!run_static_layer_overflow_check())
+  {
+    LOG_ERROR("Static layer overflow check failed");
+    return 1;
+  }
+
+  const char *frame_path = DISPLAY_HORIZONTAL ? "native_frame_horizontal.png" : "native_frame_vertical.png";
+  if (fb.dumpPNG(frame_path))
+  {
+    LOG_INFOF("Last frame written to %s\n", frame_path);
+  }
+
+#if TRACE_ENABLED
+  // One more traced update so the kept window covers fetch, parse, render and flush
+  trace_reset();
+  HTTPClient::setResponse(200, build_payload(recorded_weather[1]));
+  weather_api.fetchWeatherData();
+  run_update(weather_ui, fb);
+
+  uint32_t spans = 0;
+  uint32_t nesting_errors = trace_check_nesting(&spans);
+  LOG_INFOF("Trace: %lu events, %lu closed spans, %lu nesting errors\n",
+            (unsigned long)trace_recorded(), (unsigned long)spans, (unsigned long)nesting_errors);
+
+  FILE *trace_file = fopen("native_trace.json", "w");
+  if (trace_file != nullptr)
+  {
+    trace_dump_chrome(file_writer, trace_file);
+    fclose(trace_file);
+    LOG_INFO("Trace written to native_trace.json");
+  }
+
+  if (nesting_errors > 0 || spans == 0)
+  {
+    LOG_ERROR("Trace spans do not nest");
+    return 1;
+  }
+#endif
+  return 0;
+}
@@ -0,0 +1,156 @@
+// Own header
+#include "idle_scheduler.h"
+#include <Arduino.h>
+#include "config.h"
+#include "debug.h"
+#include "trace.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+#include <sdkconfig.h>
+#endif
+
+#include <string.h>
+
+uint32_t idle_ms_until(unsigned long start, unsigned long interval)
+{
+  unsigned long elapsed = millis() - start;
+  return elapsed >= interval ? 0 : (uint32_t)(interval - elapsed);
+}
+
+IdleScheduler::IdleScheduler()
+{
+  memset(&totals, 0, sizeof(totals));
+  memset(&window, 0, sizeof(window));
+  window_start = 0;
+  busy_start_us = 0;
+  light_sleep = false;
+#ifdef ESP_PLATFORM
+  task = nullptr;
+#endif
+}
+
+bool IdleScheduler::begin()
+{
+#ifdef ESP_PLATFORM
+  task = xTaskGetCurrentTaskHandle();
+
+#if IDLE_LIGHT_SLEEP && defined(CONFIG_PM_ENABLE)
+  // Scale down to 80 MHz when idle; light sleep additionally needs
+  // CONFIG_FREERTOS_USE_TICKLESS_IDLE in the core's sdkconfig
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_pm_config_t pm_config = {};
+#else
+  esp_pm_config_esp32s3_t pm_config = {};
+#endif
+  pm_config.max_freq_mhz = getCpuFrequencyMhz();
+  pm_config.min_freq_mhz = 80;
+  pm_config.light_sleep_enable = true;
+
+  esp_err_t err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK)
+  {
+    // No tickless idle: keep frequency scaling only
+    pm_config.light_sleep_enable = false;
+    esp_pm_configure(&pm_config);
+    LOG_INFOF("Idle: automatic light sleep unavailable (%s)\n", esp_err_to_name(err));
+  }
+  light_sleep = err == ESP_OK;
+#elif IDLE_LIGHT_SLEEP
+  LOG_INFO("Idle: automatic light sleep needs CONFIG_PM_ENABLE");
+#endif
+#endif
+
+  memset(&totals, 0, sizeof(totals));
+  memset(&window, 0, sizeof(window));
+  window_start = millis();
+  busy_start_us = micros();
+
+  LOG_INFOF("Idle: tickless loop, light sleep %s\n", light_sleep ? "on" : "off");
+  return light_sleep;
+}
+
+void IdleScheduler::block(uint32_t timeout_ms)
+{
+#ifdef ESP_PLATFORM
+  // A pending wake() returns immediately
+  ulTaskNotifyTake(pdTRUE, timeout_ms == IDLE_NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+#else
+  delay(timeout_ms);
+#endif
+}
+
+void IdleScheduler::idle(uint32_t timeout_ms)
+{
+  unsigned long now = millis();
+
+  // Wake up for the stats report even if nothing else is due
+  uint32_t report_ms = idle_ms_until(window_start, IDLE_REPORT_INTERVAL_MS);
+  if (report_ms < timeout_ms)
+  {
+    timeout_ms = report_ms;
+  }
+
+  unsigned long start_us = micros();
+  uint32_t busy_us = start_us - busy_start_us;
+  window.busy_us += busy_us;
+  totals.busy_us += busy_us;
+  if (busy_us > window.max_busy_us)
+  {
+    window.max_busy_us = busy_us;
+  }
+  if (busy_us > totals.max_busy_us)
+  {
+    totals.max_busy_us = busy_us;
+  }
+
+  if (timeout_ms > 0)
+  {
+    TRACE_SCOPE("idle");
+    block(timeout_ms);
+  }
+
+  busy_start_us = micros();
+  uint32_t idle_us = busy_start_us - start_us;
+  window.idle_us += idle_us;
+  totals.idle_us += idle_us;
+  window.wakeups++;
+  totals.wakeups++;
+
+  now = millis();
+  if (now - window_start >= IDLE_REPORT_INTERVAL_MS)
+  {
+    report(now);
+  }
+}
+
+void IdleScheduler::wake()
+{
+#ifdef ESP_PLATFORM
+  if (task != nullptr)
+  {
+    xTaskNotifyGive(task);
+  }
+#endif
+}
+
+float IdleScheduler::getIdlePercent() const
+{
+  uint64_t total = totals.idle_us + totals.busy_us;
+  return total > 0 ? 100.0f * totals.idle_us / total : 0.0f;
+}
+
+void IdleScheduler::report(unsigned long now)
+{
+  float minutes = (now - window_start) / 60000.0f;
+  uint64_t total = window.idle_us + window.busy_us;
+
+  LOG_INFOF("Idle: %.1f wakeups/min, %.1f%% idle, longest busy %lu ms, light sleep %s\n",
+            minutes > 0 ? window.wakeups / minutes : 0.0f,
+            total > 0 ? 100.0f * window.idle_us / total : 0.0f,
+            (unsigned long)(window.max_busy_us / 1000), light_sleep ? "on" : "off");
+
+  memset(&window, 0, sizeof(window));
+  window_start = now;
+}
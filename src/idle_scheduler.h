@@ -0,0 +1,65 @@
+#ifndef IDLE_SCHEDULER_H
+#define IDLE_SCHEDULER_H
+
+// System libraries
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// No deadline pending (same value as LVGL's LV_NO_TIMER_READY)
+#define IDLE_NO_DEADLINE 0xFFFFFFFFu
+
+// Blocks the loop task until the next deadline instead of polling.
+// The caller passes the earliest of its deadlines (lv_timer_handler()'s
+// return value, weather check, WiFi retry); the task sleeps exactly that long
+// or until wake() is called. With automatic light sleep enabled the chip
+// drops into light sleep while no task is ready.
+class IdleScheduler
+{
+public:
+  struct Stats
+  {
+    uint32_t wakeups;
+    uint64_t idle_us;
+    uint64_t busy_us;
+    uint32_t max_busy_us; // Longest stretch between two idle() calls: the worst frame stall
+  };
+
+  IdleScheduler();
+
+  // Configure power management, returns true if automatic light sleep is on
+  bool begin();
+
+  // Block for up to `timeout_ms` (IDLE_NO_DEADLINE: until wake())
+  void idle(uint32_t timeout_ms);
+
+  // End the current idle() early (other tasks, event callbacks)
+  void wake();
+
+  bool isLightSleepEnabled() const { return light_sleep; }
+
+  // Totals since begin()
+  const Stats &getStats() const { return totals; }
+  float getIdlePercent() const;
+
+private:
+  Stats totals;
+  Stats window; // Current report interval
+  unsigned long window_start;
+  unsigned long busy_start_us;
+  bool light_sleep;
+#ifdef ESP_PLATFORM
+  TaskHandle_t task;
+#endif
+
+  void block(uint32_t timeout_ms);
+  void report(unsigned long now);
+};
+
+// Milliseconds until `start + interval`, 0 if already due
+uint32_t idle_ms_until(unsigned long start, unsigned long interval);
+
+#endif // IDLE_SCHEDULER_H
@@ -0,0 +1,179 @@
+// Own header
+#include "area_coalescer.h"
+
+// LVGL internals: the display's invalidated-area list
+#include <lvgl_private.h>
+
+#include <string.h>
+
+static uint32_t area_px(const lv_area_t &a)
+{
+  return (uint32_t)(a.x2 - a.x1 + 1) * (uint32_t)(a.y2 - a.y1 + 1);
+}
+
+static uint32_t count_unjoined(const lv_display_t *disp)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < disp->inv_p; i++)
+  {
+    if (!disp->inv_area_joined[i])
+    {
+      n++;
+    }
+  }
+  return n;
+}
+
+AreaCoalescer::AreaCoalescer(const DisplayFlush *flush)
+    : flush(flush), enabled(true)
+{
+  resetStats();
+}
+
+void AreaCoalescer::attach(lv_display_t *disp)
+{
+  lv_display_add_event_cb(disp, onEvent, LV_EVENT_INVALIDATE_AREA, this);
+  lv_display_add_event_cb(disp, onEvent, LV_EVENT_REFR_START, this);
+  lv_display_add_event_cb(disp, onEvent, LV_EVENT_RENDER_START, this);
+  lv_display_add_event_cb(disp, onEvent, LV_EVENT_REFR_READY, this);
+}
+
+void AreaCoalescer::resetStats()
+{
+  memset(&last, 0, sizeof(last));
+  memset(&totals, 0, sizeof(totals));
+  memset(&flush_at_start, 0, sizeof(flush_at_start));
+  pending_invalidated = 0;
+}
+
+void AreaCoalescer::align(lv_area_t *area, int32_t max_x, int32_t max_y)
+{
+  area->x1 -= area->x1 % AREA_ALIGN_X;
+  area->y1 -= area->y1 % AREA_ALIGN_Y;
+  area->x2 += AREA_ALIGN_X - 1 - area->x2 % AREA_ALIGN_X;
+  area->y2 += AREA_ALIGN_Y - 1 - area->y2 % AREA_ALIGN_Y;
+
+  if (area->x2 > max_x)
+  {
+    area->x2 = max_x;
+  }
+  if (area->y2 > max_y)
+  {
+    area->y2 = max_y;
+  }
+}
+
+uint32_t AreaCoalescer::coalesce(lv_area_t *areas, uint8_t *joined, uint32_t count, uint32_t overhead_px)
+{
+  uint32_t merges = 0;
+  bool changed = true;
+
+  // Merging grows an area, which can make earlier pairs worth merging too
+  while (changed)
+  {
+    changed = false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      if (joined[i])
+      {
+        continue;
+      }
+
+      for (uint32_t j = i + 1; j < count; j++)
+      {
+        if (joined[j])
+        {
+          continue;
+        }
+
+        lv_area_t merged;
+        merged.x1 = areas[i].x1 < areas[j].x1 ? areas[i].x1 : areas[j].x1;
+        merged.y1 = areas[i].y1 < areas[j].y1 ? areas[i].y1 : areas[j].y1;
+        merged.x2 = areas[i].x2 > areas[j].x2 ? areas[i].x2 : areas[j].x2;
+        merged.y2 = areas[i].y2 > areas[j].y2 ? areas[i].y2 : areas[j].y2;
+
+        // One transfer of the union vs two transfers (overlap is sent twice)
+        // Keep the later entry: LVGL has already picked the last area to draw
+        if (area_px(merged) <= area_px(areas[i]) + area_px(areas[j]) + overhead_px)
+        {
+          areas[j] = merged;
+          joined[i] = 1;
+          merges++;
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  return merges;
+}
+
+void AreaCoalescer::onEvent(lv_event_t *e)
+{
+  AreaCoalescer *self = static_cast<AreaCoalescer *>(lv_event_get_user_data(e));
+  lv_display_t *disp = static_cast<lv_display_t *>(lv_event_get_current_target(e));
+
+  switch (lv_event_get_code(e))
+  {
+  case LV_EVENT_INVALIDATE_AREA:
+    self->pending_invalidated++;
+    if (self->enabled)
+    {
+      // Area is already clipped to the screen
+      align(static_cast<lv_area_t *>(lv_event_get_param(e)),
+            lv_display_get_horizontal_resolution(disp) - 1,
+            lv_display_get_vertical_resolution(disp) - 1);
+    }
+    break;
+  case LV_EVENT_REFR_START:
+    self->flush_at_start = self->flush->getStats();
+    memset(&self->last, 0, sizeof(self->last));
+    break;
+  case LV_EVENT_RENDER_START:
+    self->renderStart(disp);
+    break;
+  case LV_EVENT_REFR_READY:
+    self->refreshReady();
+    break;
+  default:
+    break;
+  }
+}
+
+// Runs after layout updates and LVGL's own join, right before drawing
+void AreaCoalescer::renderStart(lv_display_t *disp)
+{
+  uint32_t merges = 0;
+  if (enabled)
+  {
+    merges = coalesce(disp->inv_areas, disp->inv_area_joined, disp->inv_p, AREA_MERGE_OVERHEAD_PX);
+  }
+
+  last.areas = count_unjoined(disp);
+  totals.merged += merges;
+}
+
+void AreaCoalescer::refreshReady()
+{
+  last.invalidated = pending_invalidated;
+  pending_invalidated = 0;
+
+  const DisplayFlush::Stats &now = flush->getStats();
+  last.flushes = now.flushes - flush_at_start.flushes;
+  last.commands = now.commands - flush_at_start.commands;
+  last.pixels = now.pixels - flush_at_start.pixels;
+
+  // Refreshes with nothing to draw still fire the events
+  if (last.areas == 0)
+  {
+    return;
+  }
+
+  totals.refreshes++;
+  totals.invalidated += last.invalidated;
+  totals.areas += last.areas;
+  totals.flushes += last.flushes;
+  totals.commands += last.commands;
+  totals.pixels += last.pixels;
+}
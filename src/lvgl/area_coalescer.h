@@ -0,0 +1,85 @@
+#ifndef AREA_COALESCER_H
+#define AREA_COALESCER_H
+
+#include <stdint.h>
+
+// Third-party libraries
+#include <lvgl.h>
+
+// Project headers
+#include "display_flush.h"
+
+// Cost of one extra panel transfer (CASET/RASET/RAMWR plus transaction setup
+// and per-area render setup), expressed in pixels sent at SPI_FREQUENCY
+#define AREA_MERGE_OVERHEAD_PX 256
+
+// Preferred area granularity: even x edges keep every row a whole number of
+// 32-bit words for the swap stage and the DMA engine
+#define AREA_ALIGN_X 2
+#define AREA_ALIGN_Y 1
+
+// Invalidated-area optimizer
+// Hooks the display's LV_EVENT_INVALIDATE_AREA (rounder) and refresh events:
+// every dirty area is widened to the panel granularity, and right before LVGL
+// draws, areas are merged whenever one combined transfer costs less than the
+// separate ones (LVGL's own join only merges when no pixels are added).
+// Also counts what each refresh sent to the panel. Meant for single-buffered
+// direct mode or partial mode; double-buffered direct mode syncs areas earlier.
+class AreaCoalescer
+{
+public:
+  struct RefreshStats
+  {
+    uint32_t invalidated; // Invalidate calls since the previous refresh
+    uint32_t areas;       // Areas drawn after merging
+    uint32_t flushes;     // flush_cb calls
+    uint32_t commands;    // Panel address window + write sequences
+    uint64_t pixels;      // Pixels sent
+  };
+
+  struct Totals
+  {
+    uint32_t refreshes;
+    uint32_t invalidated;
+    uint32_t areas;
+    uint32_t merged; // Areas folded into another one by the cost model
+    uint32_t flushes;
+    uint32_t commands;
+    uint64_t pixels;
+  };
+
+  explicit AreaCoalescer(const DisplayFlush *flush);
+
+  // Register the event callbacks on a display
+  void attach(lv_display_t *disp);
+
+  // Disabled: areas pass through untouched, counters keep running
+  void setEnabled(bool enabled) { this->enabled = enabled; }
+  bool isEnabled() const { return enabled; }
+
+  const RefreshStats &getLastRefresh() const { return last; }
+  const Totals &getTotals() const { return totals; }
+  void resetStats();
+
+  // Widen an area to AREA_ALIGN_X/Y, clipped to [0, max_x] x [0, max_y]
+  static void align(lv_area_t *area, int32_t max_x, int32_t max_y);
+
+  // Merge areas while a union is cheaper than its parts; merged-away entries
+  // get joined[i] = 1. Returns the number of merges.
+  static uint32_t coalesce(lv_area_t *areas, uint8_t *joined, uint32_t count, uint32_t overhead_px);
+
+private:
+  static void onEvent(lv_event_t *e);
+  void renderStart(lv_display_t *disp);
+  void refreshReady();
+
+  const DisplayFlush *flush;
+  bool enabled;
+
+  uint32_t pending_invalidated;
+  DisplayFlush::Stats flush_at_start;
+  RefreshStats last;
+  Totals totals;
+};
+
+#endif // AREA_COALESCER_H
@@ -0,0 +1,193 @@
+// Own header
+#include "display_flush.h"
+#include "rgb565_swap.h"
+
+#include <string.h>
+
+DisplayFlush::DisplayFlush(DisplayTransport *transport, ReadyCallback ready_cb, void *ready_ctx)
+    : transport(transport), ready_cb(ready_cb), ready_ctx(ready_ctx)
+{
+  in_flight = nullptr;
+  in_flight_last = false;
+  last_buffer = nullptr;
+  resetStats();
+  setBounceBuffers(nullptr, nullptr, 0);
+}
+
+void DisplayFlush::begin()
+{
+  transport->setTransferDoneCallback(onTransferDone, this);
+}
+
+void DisplayFlush::submit(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels, bool last_in_frame)
+{
+  stats.flushes++;
+  direct_mode = false;
+
+  // LVGL must not hand over a buffer before the previous one was released
+  if (in_flight != nullptr)
+  {
+    stats.order_errors++;
+  }
+
+  if (last_buffer != nullptr && pixels != last_buffer)
+  {
+    stats.buffer_swaps++;
+  }
+  last_buffer = pixels;
+
+  // Swap/pack stage: convert the whole band in bulk before it is sent
+  uint32_t count = (uint32_t)(x2 - x1 + 1) * (uint32_t)(y2 - y1 + 1);
+  if (transport->wantsBigEndian())
+  {
+    rgb565_swap(pixels, pixels, count);
+  }
+
+  in_flight_last = last_in_frame;
+  in_flight = pixels;
+
+  if (!transport->writePixels(x1, y1, x2, y2, pixels))
+  {
+    // Release the buffer anyway, otherwise LVGL would wait forever
+    stats.dropped++;
+    complete(false);
+    return;
+  }
+  stats.commands++;
+  stats.pixels += count;
+
+  // Async transports are still sending here while LVGL renders the next band
+  if (in_flight != nullptr)
+  {
+    stats.overlapped++;
+  }
+}
+
+void DisplayFlush::setBounceBuffers(uint16_t *buf_a, uint16_t *buf_b, uint32_t size_px)
+{
+  bounce[0] = buf_a;
+  bounce[1] = buf_b;
+  bounce_px = size_px;
+  bounce_busy[0] = false;
+  bounce_busy[1] = false;
+  direct_mode = false;
+  next_bounce = 0;
+  done_bounce = 0;
+}
+
+void DisplayFlush::submitRect(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                              const uint16_t *frame, uint32_t stride_px, bool last_in_frame)
+{
+  stats.flushes++;
+  direct_mode = true;
+
+  uint32_t w = (uint32_t)(x2 - x1 + 1);
+  uint32_t rows_per_chunk = (bounce_px >= w) ? bounce_px / w : 0;
+  if (rows_per_chunk == 0)
+  {
+    stats.dropped++;
+    ready_cb(ready_ctx);
+    return;
+  }
+
+  for (int32_t y = y1; y <= y2; y += rows_per_chunk)
+  {
+    uint32_t rows = (uint32_t)(y2 - y + 1) < rows_per_chunk ? (uint32_t)(y2 - y + 1) : rows_per_chunk;
+    uint8_t idx = next_bounce;
+
+    // Wait for this bounce buffer's previous transfer (the other one keeps the bus busy)
+    while (bounce_busy[idx])
+    {
+      poll();
+    }
+
+    uint16_t *chunk = bounce[idx];
+    const uint16_t *src = frame + (size_t)y * stride_px + x1;
+    if (transport->wantsBigEndian())
+    {
+      rgb565_pack_rect(chunk, src, stride_px, w, rows);
+    }
+    else
+    {
+      for (uint32_t row = 0; row < rows; row++)
+      {
+        memcpy(chunk + row * w, src + (size_t)row * stride_px, w * sizeof(uint16_t));
+      }
+    }
+
+    bounce_busy[idx] = true;
+    if (!transport->writePixels(x1, y, x2, y + rows - 1, chunk))
+    {
+      // Nothing was queued: keep the same buffer so the alternation holds
+      bounce_busy[idx] = false;
+      stats.dropped++;
+      continue;
+    }
+
+    next_bounce ^= 1;
+    stats.buffer_swaps++;
+    stats.commands++;
+    stats.pixels += w * rows;
+
+    if (bounce_busy[idx])
+    {
+      stats.overlapped++;
+    }
+  }
+
+  if (last_in_frame)
+  {
+    stats.frames++;
+  }
+
+  // Everything is packed: LVGL may draw into the frame again
+  ready_cb(ready_ctx);
+}
+
+void DisplayFlush::waitIdle()
+{
+  while (isBusy())
+  {
+    poll();
+  }
+}
+
+void DisplayFlush::resetStats()
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+// Called by the transport in task context: inside writePixels() or poll()
+void DisplayFlush::onTransferDone(void *user_ctx)
+{
+  DisplayFlush *self = static_cast<DisplayFlush *>(user_ctx);
+  if (self->direct_mode)
+  {
+    self->bounceDone();
+  }
+  else
+  {
+    self->complete(true);
+  }
+}
+
+void DisplayFlush::bounceDone()
+{
+  bounce_busy[done_bounce] = false;
+  done_bounce ^= 1;
+}
+
+void DisplayFlush::complete(bool delivered)
+{
+  bool last = in_flight_last;
+
+  // Clear before signalling: LVGL may submit the next area right away
+  in_flight = nullptr;
+
+  if (delivered && last)
+  {
+    stats.frames++;
+  }
+
+  ready_cb(ready_ctx);
+}
@@ -0,0 +1,87 @@
+#ifndef DISPLAY_FLUSH_H
+#define DISPLAY_FLUSH_H
+
+#include <stdint.h>
+
+#include "display_transport.h"
+
+// Ping-pong flush pipeline between LVGL and a DisplayTransport
+// LVGL renders into one buffer while the other one is on the wire. A buffer
+// is handed back to LVGL (ready callback -> lv_display_flush_ready) only once
+// the transport reports that its transfer has finished.
+//
+// Completions arrive through the transport's poll() in task context, so
+// nothing here runs from an interrupt; waitIdle() and the bounce buffer wait
+// poll while they spin.
+//
+// In direct mode LVGL keeps a full frame (e.g. in PSRAM) and only the
+// invalidated areas are sent: submitRect() packs each area in chunks into two
+// small bounce buffers that alternate on the wire, and releases the frame as
+// soon as the last chunk is packed.
+class DisplayFlush
+{
+public:
+  typedef void (*ReadyCallback)(void *user_ctx);
+
+  struct Stats
+  {
+    uint32_t flushes;      // Areas submitted
+    uint32_t frames;       // Refreshes whose last area has been sent
+    uint32_t buffer_swaps; // Submissions that alternated to the other buffer
+    uint32_t overlapped;   // Transfers still running when submit() returned
+    uint32_t dropped;      // Transfers the transport refused
+    uint32_t order_errors; // Submissions while a previous transfer was in flight
+    uint32_t commands;     // Address window + pixel write sequences sent to the panel
+    uint64_t pixels;       // Pixels sent to the panel
+  };
+
+  DisplayFlush(DisplayTransport *transport, ReadyCallback ready_cb, void *ready_ctx);
+
+  // Attach to the transport's completion source
+  void begin();
+
+  // Send one rendered area; last_in_frame marks the final area of a refresh
+  void submit(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels, bool last_in_frame);
+
+  // Bounce buffers used by submitRect() (size_px pixels each)
+  void setBounceBuffers(uint16_t *buf_a, uint16_t *buf_b, uint32_t size_px);
+
+  // Send one area of a full-frame buffer with a row stride of stride_px
+  void submitRect(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                  const uint16_t *frame, uint32_t stride_px, bool last_in_frame);
+
+  bool isBusy() const { return in_flight != nullptr || bounce_busy[0] || bounce_busy[1]; }
+
+  // Deliver the transport's finished transfers
+  void poll() { transport->poll(); }
+
+  // Return once nothing is on the wire
+  void waitIdle();
+  const Stats &getStats() const { return stats; }
+  void resetStats();
+
+private:
+  static void onTransferDone(void *user_ctx);
+  void complete(bool delivered);
+  void bounceDone();
+
+  DisplayTransport *transport;
+  ReadyCallback ready_cb;
+  void *ready_ctx;
+  uint16_t *in_flight;
+  bool in_flight_last;
+  const uint16_t *last_buffer;
+  Stats stats;
+
+  // Direct mode: chunks are queued strictly alternating between the two
+  // bounce buffers and complete in order, so the completion side only needs
+  // its own index. busy flags are set by submitRect() and cleared by completions.
+  uint16_t *bounce[2];
+  uint32_t bounce_px;
+  bool bounce_busy[2];
+  bool direct_mode;
+  uint8_t next_bounce;
+  uint8_t done_bounce;
+};
+
+#endif // DISPLAY_FLUSH_H
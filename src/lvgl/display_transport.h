@@ -0,0 +1,58 @@
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+#include <stdint.h>
+
+// Abstract panel transport used by the LVGL flush path
+// Synchronous transports finish inside writePixels(), asynchronous ones only
+// record completion in their interrupt (e.g. SPI DMA done) and deliver it
+// from poll(). Either way the transfer-done callback fires exactly once per
+// successful writePixels() call, in submission order, and never from an
+// interrupt.
+class DisplayTransport
+{
+public:
+  typedef void (*TransferDoneCallback)(void *user_ctx);
+
+  virtual ~DisplayTransport() {}
+
+  // Bring up the bus and the panel
+  virtual bool begin() = 0;
+
+  // Send an RGB565 area (inclusive coordinates, byte order per wantsBigEndian())
+  // Returns false if the transfer could not be started
+  virtual bool writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels) = 0;
+
+  // True if writePixels() returns before the buffer has been sent
+  virtual bool isAsync() const = 0;
+
+  // True if pixels must arrive already swapped to big-endian RGB565
+  virtual bool wantsBigEndian() const { return false; }
+
+  // Short name for logs
+  virtual const char *name() const = 0;
+
+  // Deliver the completions recorded since the last call (task context)
+  virtual void poll() {}
+
+  void setTransferDoneCallback(TransferDoneCallback cb, void *user_ctx)
+  {
+    done_cb = cb;
+    done_ctx = user_ctx;
+  }
+
+protected:
+  void notifyTransferDone()
+  {
+    if (done_cb)
+    {
+      done_cb(done_ctx);
+    }
+  }
+
+private:
+  TransferDoneCallback done_cb = nullptr;
+  void *done_ctx = nullptr;
+};
+
+#endif // DISPLAY_TRANSPORT_H
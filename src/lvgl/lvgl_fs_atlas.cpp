@@ -0,0 +1,369 @@
+// Own header
+#include "lvgl_fs_atlas.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../debug.h"
+#include "lvgl_setup.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_idf_version.h>
+#include <esp_partition.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ESP_PLATFORM
+// Host stand-in for the flash partitions: <root>/<label>.bin
+#ifndef HOST_PARTITION_ROOT
+#define HOST_PARTITION_ROOT ".pio/assets"
+#endif
+#endif
+
+static_assert(sizeof(IconAtlasHeader) == 16, "atlas header is 16 bytes");
+static_assert(sizeof(IconAtlasEntry) == 16, "atlas index entry is 16 bytes");
+
+// Whole atlas in PSRAM or mapped flash, registered as one drive
+struct IconAtlas
+{
+  const uint8_t *data;
+  uint32_t bytes;
+  uint32_t count;
+  const IconAtlasEntry *index;
+  lv_image_dsc_t *images; // One per entry, over the entry bytes
+  bool mapped;
+  lv_fs_drv_t drv;
+};
+
+static IconAtlas atlases[ICON_ATLAS_MAX_DRIVES];
+static uint32_t atlas_drives = 0;
+
+// Open entry, position relative to the entry start
+typedef struct
+{
+  const IconAtlas *atlas;
+  const IconAtlasEntry *entry;
+  uint32_t pos;
+  bool used;
+} atlas_file_t;
+
+static atlas_file_t open_files[ICON_ATLAS_MAX_OPEN];
+
+// Open callback: path is "/<index>.<ext>"
+static void *fs_open_cb(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode)
+{
+  const IconAtlas *atlas = static_cast<const IconAtlas *>(drv->user_data);
+
+  if (mode != LV_FS_MODE_RD)
+  {
+    return NULL;
+  }
+
+  if (*path == '/')
+  {
+    path++;
+  }
+
+  char *end;
+  unsigned long index = strtoul(path, &end, 10);
+  if (end == path || *end != '.' || index >= atlas->count)
+  {
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < ICON_ATLAS_MAX_OPEN; i++)
+  {
+    if (!open_files[i].used)
+    {
+      open_files[i].atlas = atlas;
+      open_files[i].entry = &atlas->index[index];
+      open_files[i].pos = 0;
+      open_files[i].used = true;
+      return &open_files[i];
+    }
+  }
+
+  LOG_ERROR("Atlas: too many open entries");
+  return NULL;
+}
+
+// Close callback
+static lv_fs_res_t fs_close_cb(lv_fs_drv_t *drv, void *file_p)
+{
+  (void)drv; // Unused
+
+  static_cast<atlas_file_t *>(file_p)->used = false;
+  return LV_FS_RES_OK;
+}
+
+// Read callback
+static lv_fs_res_t fs_read_cb(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+  (void)drv; // Unused
+
+  atlas_file_t *f = static_cast<atlas_file_t *>(file_p);
+  uint32_t left = f->entry->size - f->pos;
+  uint32_t n = btr < left ? btr : left;
+
+  memcpy(buf, f->atlas->data + f->entry->offset + f->pos, n);
+  f->pos += n;
+  *br = n;
+  return LV_FS_RES_OK;
+}
+
+// Seek callback
+static lv_fs_res_t fs_seek_cb(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence)
+{
+  (void)drv; // Unused
+
+  atlas_file_t *f = static_cast<atlas_file_t *>(file_p);
+  uint32_t base = 0;
+  if (whence == LV_FS_SEEK_CUR)
+    base = f->pos;
+  else if (whence == LV_FS_SEEK_END)
+    base = f->entry->size;
+
+  if (base + pos > f->entry->size)
+    return LV_FS_RES_INV_PARAM;
+
+  f->pos = base + pos;
+  return LV_FS_RES_OK;
+}
+
+// Tell callback
+static lv_fs_res_t fs_tell_cb(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+  (void)drv; // Unused
+
+  *pos_p = static_cast<atlas_file_t *>(file_p)->pos;
+  return LV_FS_RES_OK;
+}
+
+// Check the header and that every entry lies inside the file
+static bool atlas_valid(const uint8_t *data, uint32_t bytes)
+{
+  if (bytes < sizeof(IconAtlasHeader))
+  {
+    return false;
+  }
+
+  const IconAtlasHeader *header = reinterpret_cast<const IconAtlasHeader *>(data);
+  if (memcmp(header->magic, ICON_ATLAS_MAGIC, 4) != 0 || header->version != ICON_ATLAS_VERSION ||
+      header->index_offset % 4 != 0 ||
+      header->index_offset + header->count * sizeof(IconAtlasEntry) > bytes)
+  {
+    return false;
+  }
+
+  const IconAtlasEntry *index = reinterpret_cast<const IconAtlasEntry *>(data + header->index_offset);
+  for (uint32_t i = 0; i < header->count; i++)
+  {
+    if (index[i].offset > bytes || index[i].size > bytes - index[i].offset ||
+        (index[i].format == ICON_ATLAS_FORMAT_BIN && index[i].size < sizeof(lv_image_header_t)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Descriptor of one entry: .bin entries start with their LVGL image header,
+// PNG and QOI entries are raw data for their decoders
+static void describe_entry(const uint8_t *data, const IconAtlasEntry &entry, lv_image_dsc_t *image)
+{
+  memset(image, 0, sizeof(lv_image_dsc_t));
+  if (entry.format == ICON_ATLAS_FORMAT_BIN)
+  {
+    memcpy(&image->header, data + entry.offset, sizeof(lv_image_header_t));
+    image->data = data + entry.offset + sizeof(lv_image_header_t);
+    image->data_size = entry.size - sizeof(lv_image_header_t);
+  }
+  else
+  {
+    image->header.magic = LV_IMAGE_HEADER_MAGIC;
+    image->header.cf = LV_COLOR_FORMAT_RAW_ALPHA;
+    image->header.w = entry.w;
+    image->header.h = entry.h;
+    image->data = data + entry.offset;
+    image->data_size = entry.size;
+  }
+}
+
+// Validate `data` and register it as drive `letter`
+static IconAtlas *register_atlas(const uint8_t *data, uint32_t bytes, bool mapped, char letter)
+{
+  if (atlas_drives >= ICON_ATLAS_MAX_DRIVES || !atlas_valid(data, bytes))
+  {
+    return nullptr;
+  }
+
+  const IconAtlasHeader *header = reinterpret_cast<const IconAtlasHeader *>(data);
+  lv_image_dsc_t *images = static_cast<lv_image_dsc_t *>(malloc(header->count * sizeof(lv_image_dsc_t)));
+  if (images == nullptr)
+  {
+    return nullptr;
+  }
+
+  IconAtlas *atlas = &atlases[atlas_drives++];
+  atlas->data = data;
+  atlas->bytes = bytes;
+  atlas->count = header->count;
+  atlas->index = reinterpret_cast<const IconAtlasEntry *>(data + header->index_offset);
+  atlas->images = images;
+  atlas->mapped = mapped;
+
+  for (uint32_t i = 0; i < atlas->count; i++)
+  {
+    describe_entry(data, atlas->index[i], &images[i]);
+  }
+
+  lv_fs_drv_t *fs_drv = &atlas->drv;
+  lv_fs_drv_init(fs_drv);
+
+  fs_drv->letter = letter;
+  fs_drv->cache_size = 0;
+  fs_drv->user_data = atlas;
+
+  fs_drv->open_cb = fs_open_cb;
+  fs_drv->close_cb = fs_close_cb;
+  fs_drv->read_cb = fs_read_cb;
+  fs_drv->seek_cb = fs_seek_cb;
+  fs_drv->tell_cb = fs_tell_cb;
+
+  lv_fs_drv_register(fs_drv);
+
+  LOG_INFOF("Atlas %c: %lu icons, %lu B %s\n", letter, (unsigned long)atlas->count,
+            (unsigned long)bytes, mapped ? "mapped" : "loaded");
+  return atlas;
+}
+
+IconAtlas *lvgl_fs_atlas_load(const char *path, char letter)
+{
+  File file = LittleFS.open(path, "r");
+  if (!file)
+  {
+    LOG_ERRORF("Atlas: %s not found\n", path);
+    return nullptr;
+  }
+
+  // One read of the whole file
+  uint32_t bytes = file.size();
+  uint8_t *data = static_cast<uint8_t *>(lvgl_buffer_alloc(bytes, true));
+  uint32_t read = data != nullptr ? file.read(data, bytes) : 0;
+  file.close();
+
+  IconAtlas *atlas = read == bytes ? register_atlas(data, bytes, false, letter) : nullptr;
+  if (atlas == nullptr)
+  {
+    LOG_ERRORF("Atlas: %s could not be loaded\n", path);
+    lvgl_buffer_free(data);
+  }
+  return atlas;
+}
+
+IconAtlas *lvgl_fs_atlas_map(const char *label, char letter)
+{
+  const void *data = nullptr;
+  uint32_t bytes = 0;
+
+#ifdef ESP_PLATFORM
+  const esp_partition_t *partition =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (partition == nullptr)
+  {
+    LOG_ERRORF("Atlas: no partition %s\n", label);
+    return nullptr;
+  }
+
+  // Mapped for the lifetime of the firmware, the handle is never released
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_partition_mmap_handle_t handle;
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &handle);
+#else
+  spi_flash_mmap_handle_t handle;
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &data, &handle);
+#endif
+  if (err != ESP_OK)
+  {
+    LOG_ERRORF("Atlas: cannot map %s (%d)\n", label, (int)err);
+    return nullptr;
+  }
+  bytes = partition->size;
+#else
+  char path[128];
+  snprintf(path, sizeof(path), "%s/%s.bin", HOST_PARTITION_ROOT, label);
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    LOG_ERRORF("Atlas: no partition image %s\n", path);
+    if (fd >= 0)
+    {
+      close(fd);
+    }
+    return nullptr;
+  }
+
+  data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    LOG_ERRORF("Atlas: cannot map %s\n", path);
+    return nullptr;
+  }
+  bytes = st.st_size;
+#endif
+
+  IconAtlas *atlas = register_atlas(static_cast<const uint8_t *>(data), bytes, true, letter);
+  if (atlas == nullptr)
+  {
+    // Erased or never flashed: pio run --target upload writes the image
+    LOG_ERRORF("Atlas: partition %s holds no atlas\n", label);
+  }
+  return atlas;
+}
+
+uint32_t lvgl_fs_atlas_count(const IconAtlas *atlas)
+{
+  return atlas != nullptr ? atlas->count : 0;
+}
+
+uint32_t lvgl_fs_atlas_bytes(const IconAtlas *atlas)
+{
+  return atlas != nullptr ? atlas->bytes : 0;
+}
+
+bool lvgl_fs_atlas_mapped(const IconAtlas *atlas)
+{
+  return atlas != nullptr && atlas->mapped;
+}
+
+const IconAtlasEntry *lvgl_fs_atlas_entry(const IconAtlas *atlas, uint32_t index)
+{
+  return atlas != nullptr && index < atlas->count ? &atlas->index[index] : nullptr;
+}
+
+bool lvgl_fs_atlas_src(const IconAtlas *atlas, uint32_t index, char *buf, size_t size)
+{
+  const IconAtlasEntry *entry = lvgl_fs_atlas_entry(atlas, index);
+  if (entry == nullptr)
+  {
+    return false;
+  }
+
+  static const char *const extensions[] = {"png", "bin", "qoi"};
+  snprintf(buf, size, "%c:/%lu.%s", atlas->drv.letter, (unsigned long)index,
+           entry->format <= ICON_ATLAS_FORMAT_QOI ? extensions[entry->format] : "png");
+  return true;
+}
+
+const lv_image_dsc_t *lvgl_fs_atlas_image(const IconAtlas *atlas, uint32_t index)
+{
+  return atlas != nullptr && index < atlas->count ? &atlas->images[index] : nullptr;
+}
@@ -0,0 +1,80 @@
+#ifndef LVGL_FS_ATLAS_H
+#define LVGL_FS_ATLAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Icon atlas: all icons in one image (resources/compile_icons.py)
+// An atlas is exposed as an LVGL drive, where entry i is the file
+// "<letter>:/<i>.png" (or ".bin"/".qoi", by entry format). LVGL's PNG and bin
+// decoders then read the entry from memory: no path lookup, no allocation
+// per open, no flash access per read. Two backings:
+// - lvgl_fs_atlas_load(): a LittleFS file read into PSRAM with a single read
+// - lvgl_fs_atlas_map(): a read-only flash partition mapped into the address
+//   space (esp_partition_mmap; mmap(2) of .pio/assets/<label>.bin on the host)
+#define ICON_ATLAS_PATH "/icons.atlas"
+#define ICON_ATLAS_DRIVE 'I'
+
+// Asset partition written by the upload (partitions.csv, FLASH_EXTRA_IMAGES)
+#define ICON_ASSETS_PARTITION "assets"
+#define ICON_ASSETS_DRIVE 'A'
+
+#define ICON_ATLAS_MAGIC "WIA1"
+#define ICON_ATLAS_VERSION 1
+#define ICON_ATLAS_FORMAT_PNG 0
+#define ICON_ATLAS_FORMAT_BIN 1
+#define ICON_ATLAS_FORMAT_QOI 2
+
+// Atlas entries open at the same time (static descriptor pool, all drives)
+#define ICON_ATLAS_MAX_OPEN 4
+
+// Registered atlases (drives)
+#define ICON_ATLAS_MAX_DRIVES 2
+
+// File layout: 16 B header, `count` index entries, entry data
+struct IconAtlasHeader
+{
+  char magic[4];
+  uint16_t version;
+  uint16_t count;
+  uint32_t index_offset;
+  uint32_t data_offset;
+};
+
+struct IconAtlasEntry
+{
+  uint32_t offset; // From the start of the file
+  uint32_t size;
+  uint8_t format; // ICON_ATLAS_FORMAT_*
+  uint8_t reserved;
+  uint16_t w;
+  uint16_t h;
+  uint16_t reserved_2;
+};
+
+struct IconAtlas;
+
+// Load `path` from LittleFS into PSRAM and register it as drive `letter`;
+// nullptr if missing or invalid
+IconAtlas *lvgl_fs_atlas_load(const char *path, char letter);
+
+// Map the data partition `label` and register it as drive `letter`;
+// nullptr if there is no such partition or it holds no valid atlas
+IconAtlas *lvgl_fs_atlas_map(const char *label, char letter);
+
+uint32_t lvgl_fs_atlas_count(const IconAtlas *atlas);
+uint32_t lvgl_fs_atlas_bytes(const IconAtlas *atlas);
+bool lvgl_fs_atlas_mapped(const IconAtlas *atlas);
+const IconAtlasEntry *lvgl_fs_atlas_entry(const IconAtlas *atlas, uint32_t index);
+
+// LVGL path of entry `index` ("I:/12.png"), false if there is no such entry
+bool lvgl_fs_atlas_src(const IconAtlas *atlas, uint32_t index, char *buf, size_t size);
+
+// Image descriptor over the entry's bytes in place, for lv_image_set_src()
+// without a file open: .bin entries are drawn directly, PNG and QOI entries
+// are decoded from memory. nullptr if there is no such entry.
+const lv_image_dsc_t *lvgl_fs_atlas_image(const IconAtlas *atlas, uint32_t index);
+
+#endif // LVGL_FS_ATLAS_H
@@ -1,42 +1,202 @@
 #include "lvgl_fs_spiffs.h"
+#include <Arduino.h>
 #include <LittleFS.h>
 #include <FS.h>
+#include "../config.h"
+
+#include <string.h>
+
+// Longest path kept in the directory cache
+#define LVGL_FS_PATH_LEN 48
 
 // File descriptor structure
+// `pos` is the position LVGL sees; the LittleFS file is at `file_pos`, and
+// `buffer` holds `buffered` bytes read ahead from `buffer_start`.
 typedef struct
 {
   File file;
   bool is_open;
+  uint32_t size;
+  uint32_t pos;
+  uint32_t file_pos;
+  uint32_t buffer_start;
+  uint32_t buffered;
+  uint8_t *buffer;
 } spiffs_file_t;
 
+// Directory cache entry: a path opened before, with its size or as missing
+typedef struct
+{
+  char path[LVGL_FS_PATH_LEN];
+  bool exists;
+  uint32_t size;
+  uint32_t last_use;
+} dir_entry_t;
+
+static spiffs_file_t files[LVGL_FS_MAX_OPEN];
+#if LVGL_FS_READ_AHEAD > 0
+static uint8_t read_ahead_buffers[LVGL_FS_MAX_OPEN][LVGL_FS_READ_AHEAD];
+#endif
+static uint32_t read_ahead = LVGL_FS_READ_AHEAD;
+
+#if LVGL_FS_DIR_CACHE_ENTRIES > 0
+static dir_entry_t dir_cache[LVGL_FS_DIR_CACHE_ENTRIES];
+#endif
+static bool dir_cache_enabled = LVGL_FS_DIR_CACHE_ENTRIES > 0;
+static uint32_t dir_clock = 0;
+
+static LvglFsStats stats;
+
+// Cached entry for `path`, nullptr if not cached
+static dir_entry_t *dir_find(const char *path)
+{
+#if LVGL_FS_DIR_CACHE_ENTRIES > 0
+  if (dir_cache_enabled)
+  {
+    for (uint32_t i = 0; i < LVGL_FS_DIR_CACHE_ENTRIES; i++)
+    {
+      if (dir_cache[i].path[0] != '\0' && strcmp(dir_cache[i].path, path) == 0)
+      {
+        dir_cache[i].last_use = ++dir_clock;
+        return &dir_cache[i];
+      }
+    }
+  }
+#else
+  (void)path; // Unused
+#endif
+  return nullptr;
+}
+
+// Remember `path`, replacing the least recently used entry
+static void dir_store(const char *path, bool exists, uint32_t size)
+{
+#if LVGL_FS_DIR_CACHE_ENTRIES > 0
+  if (!dir_cache_enabled || strlen(path) >= LVGL_FS_PATH_LEN)
+  {
+    return;
+  }
+
+  dir_entry_t *slot = &dir_cache[0];
+  for (uint32_t i = 1; i < LVGL_FS_DIR_CACHE_ENTRIES; i++)
+  {
+    if (dir_cache[i].last_use < slot->last_use)
+    {
+      slot = &dir_cache[i];
+    }
+  }
+
+  strcpy(slot->path, path);
+  slot->exists = exists;
+  slot->size = size;
+  slot->last_use = ++dir_clock;
+#else
+  (void)path;   // Unused
+  (void)exists; // Unused
+  (void)size;   // Unused
+#endif
+}
+
+static void dir_forget(const char *path)
+{
+  dir_entry_t *entry = dir_find(path);
+  if (entry != nullptr)
+  {
+    memset(entry, 0, sizeof(dir_entry_t));
+  }
+}
+
+// Move the LittleFS file to the position LVGL expects
+static bool sync_position(spiffs_file_t *f)
+{
+  if (f->file_pos == f->pos)
+  {
+    return true;
+  }
+
+  stats.seeks++;
+  if (!f->file.seek(f->pos, SeekSet))
+  {
+    return false;
+  }
+  f->file_pos = f->pos;
+  return true;
+}
+
 // Open callback
 static void *fs_open_cb(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode)
 {
   (void)drv; // Unused
 
-  spiffs_file_t *file_p = (spiffs_file_t *)malloc(sizeof(spiffs_file_t));
-  if (file_p == NULL)
+  unsigned long start = micros();
+  stats.opens++;
+
+  // Known to be missing: no LittleFS lookup
+  dir_entry_t *entry = mode == LV_FS_MODE_RD ? dir_find(path) : nullptr;
+  if (entry != nullptr)
+  {
+    stats.dir_hits++;
+    if (!entry->exists)
+    {
+      stats.open_failures++;
+      stats.time_us += micros() - start;
+      return NULL;
+    }
+  }
+  else if (mode == LV_FS_MODE_RD)
   {
-    return NULL;
+    stats.dir_misses++;
+  }
+  else
+  {
+    // Written files change size
+    dir_forget(path);
   }
 
-  // Initialize the File object properly before opening
-  new (&file_p->file) fs::File();
+  spiffs_file_t *file_p = nullptr;
+  for (uint32_t i = 0; i < LVGL_FS_MAX_OPEN && file_p == nullptr; i++)
+  {
+    if (!files[i].is_open)
+    {
+      file_p = &files[i];
+    }
+  }
 
   const char *mode_str = (mode == LV_FS_MODE_WR) ? "w" : "r";
-  fs::File opened_file = LittleFS.open(path, mode_str);
+  fs::File opened_file = file_p != nullptr ? LittleFS.open(path, mode_str) : fs::File();
 
   if (opened_file)
   {
     file_p->file = opened_file;
     file_p->is_open = true;
-    return file_p;
+    file_p->size = entry != nullptr ? entry->size : opened_file.size();
+    file_p->pos = 0;
+    file_p->file_pos = 0;
+    file_p->buffer_start = 0;
+    file_p->buffered = 0;
+
+    if (entry == nullptr && mode == LV_FS_MODE_RD)
+    {
+      dir_store(path, true, file_p->size);
+    }
   }
   else
   {
-    free(file_p);
-    return NULL;
+    // Only remember files that are really missing, not a full pool
+    if (file_p != nullptr && mode == LV_FS_MODE_RD)
+    {
+      if (entry != nullptr)
+      {
+        memset(entry, 0, sizeof(dir_entry_t)); // Deleted behind the cache
+      }
+      dir_store(path, false, 0);
+    }
+    stats.open_failures++;
+    file_p = nullptr;
   }
+
+  stats.time_us += micros() - start;
+  return file_p;
 }
 
 // Close callback
@@ -49,11 +209,14 @@ static lv_fs_res_t fs_close_cb(lv_fs_drv_t *drv, void *file_p)
   {
     f->file.close();
   }
-  free(f);
+  f->file = fs::File();
+  f->is_open = false;
   return LV_FS_RES_OK;
 }
 
 // Read callback
+// Small reads are served from the read-ahead buffer, refilled with one
+// LittleFS read; reads of at least a buffer go straight to the caller.
 static lv_fs_res_t fs_read_cb(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
 {
   (void)drv; // Unused
@@ -65,11 +228,62 @@ static lv_fs_res_t fs_read_cb(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_
     return LV_FS_RES_FS_ERR;
   }
 
-  *br = f->file.read((uint8_t *)buf, btr);
+  unsigned long start = micros();
+  uint8_t *out = (uint8_t *)buf;
+  uint32_t done = 0;
+  stats.reads++;
+
+  while (done < btr)
+  {
+    if (f->pos >= f->buffer_start && f->pos < f->buffer_start + f->buffered)
+    {
+      uint32_t offset = f->pos - f->buffer_start;
+      uint32_t n = f->buffered - offset;
+      if (n > btr - done)
+      {
+        n = btr - done;
+      }
+      memcpy(out + done, f->buffer + offset, n);
+      f->pos += n;
+      done += n;
+      continue;
+    }
+
+    if (!sync_position(f))
+    {
+      break;
+    }
+
+    uint32_t left = btr - done;
+    if (read_ahead == 0 || left >= read_ahead)
+    {
+      uint32_t n = f->file.read(out + done, left);
+      stats.fs_reads++;
+      f->pos += n;
+      f->file_pos += n;
+      done += n;
+      break;
+    }
+
+    uint32_t n = f->file.read(f->buffer, read_ahead);
+    stats.fs_reads++;
+    f->buffer_start = f->pos;
+    f->buffered = n;
+    f->file_pos += n;
+    if (n == 0)
+    {
+      break;
+    }
+  }
+
+  *br = done;
+  stats.bytes += done;
+  stats.time_us += micros() - start;
   return (*br > 0) ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
 }
 
 // Seek callback
+// Only moves the position; LittleFS seeks when a read needs it
 static lv_fs_res_t fs_seek_cb(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence)
 {
   (void)drv; // Unused
@@ -78,13 +292,14 @@ static lv_fs_res_t fs_seek_cb(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_f
   if (!f->is_open)
     return LV_FS_RES_FS_ERR;
 
-  SeekMode mode = SeekSet;
+  uint32_t base = 0;
   if (whence == LV_FS_SEEK_CUR)
-    mode = SeekCur;
+    base = f->pos;
   else if (whence == LV_FS_SEEK_END)
-    mode = SeekEnd;
+    base = f->size;
 
-  return f->file.seek(pos, mode) ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
+  f->pos = base + pos;
+  return LV_FS_RES_OK;
 }
 
 // Tell callback
@@ -96,10 +311,50 @@ static lv_fs_res_t fs_tell_cb(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
   if (!f->is_open)
     return LV_FS_RES_FS_ERR;
 
-  *pos_p = f->file.position();
+  *pos_p = f->pos;
   return LV_FS_RES_OK;
 }
 
+void lvgl_fs_spiffs_set_read_ahead(uint32_t bytes)
+{
+  read_ahead = bytes < LVGL_FS_READ_AHEAD ? bytes : LVGL_FS_READ_AHEAD;
+
+  // Open files drop what they have buffered
+  for (uint32_t i = 0; i < LVGL_FS_MAX_OPEN; i++)
+  {
+    files[i].buffered = 0;
+  }
+}
+
+uint32_t lvgl_fs_spiffs_get_read_ahead()
+{
+  return read_ahead;
+}
+
+void lvgl_fs_spiffs_set_dir_cache(bool enabled)
+{
+  lvgl_fs_spiffs_invalidate();
+  dir_cache_enabled = enabled && LVGL_FS_DIR_CACHE_ENTRIES > 0;
+}
+
+void lvgl_fs_spiffs_invalidate()
+{
+#if LVGL_FS_DIR_CACHE_ENTRIES > 0
+  memset(dir_cache, 0, sizeof(dir_cache));
+#endif
+  dir_clock = 0;
+}
+
+const LvglFsStats &lvgl_fs_spiffs_get_stats()
+{
+  return stats;
+}
+
+void lvgl_fs_spiffs_reset_stats()
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
 // Initialize LittleFS filesystem driver for LVGL
 void lvgl_fs_spiffs_init()
 {
@@ -110,12 +365,23 @@ void lvgl_fs_spiffs_init()
     return;
   }
 
+  // Descriptor pool with preallocated read-ahead buffers: no malloc per open
+  for (uint32_t i = 0; i < LVGL_FS_MAX_OPEN; i++)
+  {
+    files[i].is_open = false;
+#if LVGL_FS_READ_AHEAD > 0
+    files[i].buffer = read_ahead_buffers[i];
+#else
+    files[i].buffer = nullptr;
+#endif
+  }
+
   // Register LittleFS driver with LVGL
   static lv_fs_drv_t fs_drv;
   lv_fs_drv_init(&fs_drv);
 
   fs_drv.letter = 'S'; // Drive letter 'S:' for filesystem
-  fs_drv.cache_size = 0;
+  fs_drv.cache_size = 0; // Read-ahead is done by the driver
 
   fs_drv.open_cb = fs_open_cb;
   fs_drv.close_cb = fs_close_cb;
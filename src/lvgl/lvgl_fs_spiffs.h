@@ -1,9 +1,38 @@
 #ifndef LVGL_FS_SPIFFS_H
 #define LVGL_FS_SPIFFS_H
 
+#include <stdint.h>
+
 #include <lvgl.h>
 
+// Driver counters since the last reset
+struct LvglFsStats
+{
+  uint32_t opens;
+  uint32_t open_failures; // Missing files and an exhausted descriptor pool
+  uint32_t dir_hits;      // Opens answered by the directory cache
+  uint32_t dir_misses;
+  uint32_t reads;     // read callbacks (LVGL requests)
+  uint32_t fs_reads;  // LittleFS reads, including read-ahead refills
+  uint32_t seeks;     // LittleFS seeks; in-buffer seeks do not count
+  uint64_t bytes;     // Bytes returned to LVGL
+  uint64_t time_us;   // Time spent in the driver callbacks
+};
+
 // Initialize SPIFFS filesystem driver for LVGL
 void lvgl_fs_spiffs_init();
 
+// Read-ahead per descriptor, up to LVGL_FS_READ_AHEAD (0 = read through)
+void lvgl_fs_spiffs_set_read_ahead(uint32_t bytes);
+uint32_t lvgl_fs_spiffs_get_read_ahead();
+
+// Enable the directory cache; disabling it also forgets all entries
+void lvgl_fs_spiffs_set_dir_cache(bool enabled);
+
+// Forget all directory entries, e.g. after writing files outside LVGL
+void lvgl_fs_spiffs_invalidate();
+
+const LvglFsStats &lvgl_fs_spiffs_get_stats();
+void lvgl_fs_spiffs_reset_stats();
+
 #endif // LVGL_FS_SPIFFS_H
@@ -0,0 +1,219 @@
+// Own header
+#include "lvgl_glyph_cache.h"
+#include "lvgl_setup.h"
+#include "../config.h"
+
+#include <string.h>
+
+// One unpacked glyph, as LVGL laid it out in the draw buffer
+typedef struct
+{
+  const lv_font_t *font; // Cache font it was drawn with, nullptr if free
+  uint32_t gid;
+  uint32_t stride;
+  uint32_t size;
+  uint32_t last_use;
+  uint8_t *bitmap;
+} glyph_entry_t;
+
+// Copies of the base fonts with the bitmap callback replaced; user_data
+// points to the base
+static lv_font_t fonts[GLYPH_CACHE_MAX_FONTS];
+static uint32_t font_count = 0;
+
+static glyph_entry_t entries[GLYPH_CACHE_MAX_ENTRIES];
+static uint32_t budget = GLYPH_CACHE_BYTES;
+static uint32_t use_clock = 0;
+static GlyphCacheStats stats;
+
+static void evict(glyph_entry_t *entry)
+{
+  stats.bytes -= entry->size;
+  stats.evictions++;
+  lvgl_buffer_free(entry->bitmap);
+  memset(entry, 0, sizeof(glyph_entry_t));
+}
+
+static void clear()
+{
+  for (uint32_t i = 0; i < GLYPH_CACHE_MAX_ENTRIES; i++)
+  {
+    if (entries[i].font != nullptr)
+    {
+      evict(&entries[i]);
+    }
+  }
+}
+
+static glyph_entry_t *find(const lv_font_t *font, uint32_t gid)
+{
+  for (uint32_t i = 0; i < GLYPH_CACHE_MAX_ENTRIES; i++)
+  {
+    if (entries[i].font == font && entries[i].gid == gid)
+    {
+      return &entries[i];
+    }
+  }
+  return nullptr;
+}
+
+// Free slot with `size` bytes left in the budget, evicting the least
+// recently used glyphs; nullptr if the glyph alone exceeds the budget
+static glyph_entry_t *make_room(uint32_t size)
+{
+  if (size > budget)
+  {
+    return nullptr;
+  }
+
+  while (true)
+  {
+    glyph_entry_t *free_slot = nullptr;
+    glyph_entry_t *oldest = nullptr;
+    for (uint32_t i = 0; i < GLYPH_CACHE_MAX_ENTRIES; i++)
+    {
+      glyph_entry_t *entry = &entries[i];
+      if (entry->font == nullptr)
+      {
+        free_slot = free_slot != nullptr ? free_slot : entry;
+      }
+      else if (oldest == nullptr || entry->last_use < oldest->last_use)
+      {
+        oldest = entry;
+      }
+    }
+
+    if (free_slot != nullptr && stats.bytes + size <= budget)
+    {
+      return free_slot;
+    }
+    evict(oldest);
+  }
+}
+
+static void store(const lv_font_t *font, uint32_t gid, const lv_draw_buf_t *draw_buf, uint32_t size)
+{
+  glyph_entry_t *entry = find(font, gid);
+  if (entry != nullptr)
+  {
+    evict(entry); // Laid out with another stride
+  }
+
+  entry = make_room(size);
+  uint8_t *bitmap = entry != nullptr ? static_cast<uint8_t *>(lvgl_buffer_alloc(size, true)) : nullptr;
+  if (bitmap == nullptr)
+  {
+    return;
+  }
+
+  memcpy(bitmap, draw_buf->data, size);
+  entry->font = font;
+  entry->gid = gid;
+  entry->stride = draw_buf->header.stride;
+  entry->size = size;
+  entry->last_use = ++use_clock;
+  entry->bitmap = bitmap;
+  stats.bytes += size;
+  if (stats.bytes > stats.peak_bytes)
+  {
+    stats.peak_bytes = stats.bytes;
+  }
+}
+
+// get_glyph_bitmap of the cache fonts: the cached bitmap copied into the
+// draw buffer LVGL prepared for the glyph, or the base font's unpacked one
+static const void *cached_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+  const lv_font_t *font = g_dsc->resolved_font;
+  const lv_font_t *base = static_cast<const lv_font_t *>(font->user_data);
+  uint32_t gid = g_dsc->gid.index;
+  uint32_t size = draw_buf != nullptr ? draw_buf->header.stride * g_dsc->box_h : 0;
+
+  if (budget > 0 && size > 0 && size <= draw_buf->data_size)
+  {
+    glyph_entry_t *entry = find(font, gid);
+    if (entry != nullptr && entry->stride == draw_buf->header.stride && entry->size == size)
+    {
+      stats.hits++;
+      entry->last_use = ++use_clock;
+      memcpy(draw_buf->data, entry->bitmap, size);
+      return draw_buf;
+    }
+  }
+
+  // The base font looks up its own data through the resolved font
+  g_dsc->resolved_font = base;
+  const void *bitmap = base->get_glyph_bitmap(g_dsc, draw_buf);
+  g_dsc->resolved_font = font;
+
+  // Only bitmaps unpacked into the draw buffer are kept, not ones LVGL
+  // draws straight from the font data
+  if (budget > 0 && size > 0 && size <= draw_buf->data_size && bitmap == draw_buf)
+  {
+    stats.misses++;
+    store(font, gid, draw_buf, size);
+  }
+  return bitmap;
+}
+
+const lv_font_t *lvgl_glyph_cache_font(const lv_font_t *base)
+{
+  for (uint32_t i = 0; i < font_count; i++)
+  {
+    if (fonts[i].user_data == base)
+    {
+      return &fonts[i];
+    }
+  }
+  if (font_count == GLYPH_CACHE_MAX_FONTS)
+  {
+    return base;
+  }
+
+  lv_font_t *font = &fonts[font_count++];
+  *font = *base;
+  font->get_glyph_bitmap = cached_bitmap;
+  font->user_data = const_cast<lv_font_t *>(base);
+  return font;
+}
+
+void lvgl_glyph_cache_set_budget(uint32_t bytes)
+{
+  budget = bytes;
+  if (budget == 0)
+  {
+    clear();
+    return;
+  }
+
+  while (stats.bytes > budget)
+  {
+    glyph_entry_t *oldest = nullptr;
+    for (uint32_t i = 0; i < GLYPH_CACHE_MAX_ENTRIES; i++)
+    {
+      if (entries[i].font != nullptr && (oldest == nullptr || entries[i].last_use < oldest->last_use))
+      {
+        oldest = &entries[i];
+      }
+    }
+    evict(oldest);
+  }
+}
+
+uint32_t lvgl_glyph_cache_get_budget()
+{
+  return budget;
+}
+
+const GlyphCacheStats &lvgl_glyph_cache_get_stats()
+{
+  return stats;
+}
+
+void lvgl_glyph_cache_reset_stats()
+{
+  uint32_t bytes = stats.bytes;
+  memset(&stats, 0, sizeof(stats));
+  stats.bytes = bytes;
+  stats.peak_bytes = bytes;
+}
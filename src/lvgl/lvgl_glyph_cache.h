@@ -0,0 +1,39 @@
+#ifndef LVGL_GLYPH_CACHE_H
+#define LVGL_GLYPH_CACHE_H
+
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Glyph bitmap cache for LVGL bitmap fonts
+// A font from lvgl_glyph_cache_font() draws like its base font, but the A8
+// bitmap LVGL unpacks from a glyph's 4 bpp data is kept after the first draw
+// and copied on later draws. Meant for the large digits of the number labels:
+// a few dozen glyphs in PSRAM (lvgl_buffer_alloc), outside LVGL's heap, the
+// least recently used evicted beyond the byte budget.
+#define GLYPH_CACHE_MAX_FONTS 4
+#define GLYPH_CACHE_MAX_ENTRIES 48
+
+// Cache counters since the last reset
+struct GlyphCacheStats
+{
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+  uint32_t bytes;      // Bitmap bytes held in PSRAM
+  uint32_t peak_bytes; // Highest `bytes` since the last reset
+};
+
+// Font drawing `base` (an lv_font_fmt_txt font) through the cache, the same
+// one for the same base; `base` itself once GLYPH_CACHE_MAX_FONTS are in use
+const lv_font_t *lvgl_glyph_cache_font(const lv_font_t *base);
+
+// Bitmap bytes kept for all fonts (initially GLYPH_CACHE_BYTES); 0 frees
+// them and every glyph is unpacked on every draw again
+void lvgl_glyph_cache_set_budget(uint32_t bytes);
+uint32_t lvgl_glyph_cache_get_budget();
+
+const GlyphCacheStats &lvgl_glyph_cache_get_stats();
+void lvgl_glyph_cache_reset_stats();
+
+#endif // LVGL_GLYPH_CACHE_H
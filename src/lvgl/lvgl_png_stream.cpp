@@ -0,0 +1,1173 @@
+// Own header
+#include "lvgl_png_stream.h"
+#include <Arduino.h>
+#include "../config.h"
+#include "../debug.h"
+
+#include <string.h>
+
+#define PNG_CHUNK_IHDR 0x49484452
+#define PNG_CHUNK_PLTE 0x504C5445
+#define PNG_CHUNK_TRNS 0x74524E53
+#define PNG_CHUNK_IDAT 0x49444154
+#define PNG_CHUNK_IEND 0x49454E44
+
+#define INFLATE_MAX_BITS 15
+#define INFLATE_MAX_LCODES 286
+#define INFLATE_MAX_DCODES 30
+#define INFLATE_FIXED_LCODES 288
+#define INFLATE_FAST_BITS 9 // Literal/length codes up to this length decode with one lookup
+
+static const uint8_t png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+// Canonical Huffman code: codes per length and symbols ordered by code;
+// `fast` (optional) maps the next INFLATE_FAST_BITS input bits to
+// symbol << 4 | code length, 0 for longer codes
+typedef struct
+{
+  uint16_t *count;
+  uint16_t *symbol;
+  uint16_t *fast;
+} huffman_t;
+
+enum inflate_block_t
+{
+  BLOCK_HEADER,
+  BLOCK_STORED,
+  BLOCK_CODES,
+};
+
+struct png_stream_t
+{
+  lv_fs_file_t file;
+  char path[PNG_STREAM_PATH_LEN];
+
+  // File bytes through a small window, IDAT payload across chunks
+  uint8_t in[PNG_STREAM_READ_WINDOW];
+  uint32_t in_pos;
+  uint32_t in_len;
+  uint32_t chunk_left;
+
+  // Inflate state; `bit_buf` holds up to 16 bits
+  uint32_t bit_buf;
+  uint32_t bit_count;
+  uint8_t block;
+  bool last_block;
+  uint32_t stored_left;
+  uint32_t match_len;
+  uint32_t match_dist;
+  uint16_t len_count[INFLATE_MAX_BITS + 1];
+  uint16_t len_symbol[INFLATE_FIXED_LCODES];
+  uint16_t len_fast[1 << INFLATE_FAST_BITS];
+  uint16_t dist_count[INFLATE_MAX_BITS + 1];
+  uint16_t dist_symbol[INFLATE_MAX_DCODES];
+  huffman_t lencode;
+  huffman_t distcode;
+
+  // Sliding window: the last `window_size` inflated bytes
+  uint8_t *window;
+  uint32_t window_size;
+  uint32_t window_pos;
+  uint32_t window_fill;
+
+  // Image
+  uint32_t w;
+  uint32_t h;
+  uint8_t color_type;
+  uint8_t bit_depth;
+  uint32_t bpp;       // Bytes per complete pixel for the filters, at least 1
+  uint32_t row_bytes; // Filtered row without the filter type byte
+  uint8_t *prev;
+  uint8_t *cur;
+  uint32_t row;       // Next row to decode
+  uint8_t palette[256][4]; // B, G, R, A
+  bool has_key;
+  uint16_t key[3];    // tRNS color key (gray or R, G, B)
+};
+
+static bool enabled = PNG_STREAM_DECODE;
+static png_stream_t *parked = nullptr;
+static PngStreamStats stats;
+
+// Per-open state of the LVGL decoder
+typedef struct
+{
+  png_stream_t *stream;
+  lv_draw_buf_t *strip;
+} png_session_t;
+
+static uint32_t read_u32_be(const uint8_t *p)
+{
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static bool raw_fill(png_stream_t *s)
+{
+  uint32_t n = 0;
+  if (lv_fs_read(&s->file, s->in, sizeof(s->in), &n) != LV_FS_RES_OK || n == 0)
+  {
+    return false;
+  }
+  s->in_pos = 0;
+  s->in_len = n;
+  return true;
+}
+
+static inline bool raw_byte(png_stream_t *s, uint8_t *b)
+{
+  if (s->in_pos >= s->in_len && !raw_fill(s))
+  {
+    return false;
+  }
+  *b = s->in[s->in_pos++];
+  return true;
+}
+
+static bool raw_bytes(png_stream_t *s, uint8_t *out, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (!raw_byte(s, &out[i]))
+      return false;
+  }
+  return true;
+}
+
+static bool raw_u32(png_stream_t *s, uint32_t *value)
+{
+  uint8_t b[4];
+  if (!raw_bytes(s, b, 4))
+  {
+    return false;
+  }
+  *value = read_u32_be(b);
+  return true;
+}
+
+static bool raw_skip(png_stream_t *s, uint32_t n)
+{
+  uint32_t buffered = s->in_len - s->in_pos;
+  if (n <= buffered)
+  {
+    s->in_pos += n;
+    return true;
+  }
+  s->in_pos = s->in_len;
+  return lv_fs_seek(&s->file, n - buffered, LV_FS_SEEK_CUR) == LV_FS_RES_OK;
+}
+
+// Next byte of the zlib stream; consecutive IDAT chunks form one stream
+static inline bool idat_byte(png_stream_t *s, uint8_t *b)
+{
+  while (s->chunk_left == 0)
+  {
+    uint32_t crc, len, type;
+    if (!raw_u32(s, &crc) || !raw_u32(s, &len) || !raw_u32(s, &type) || type != PNG_CHUNK_IDAT)
+    {
+      return false;
+    }
+    s->chunk_left = len;
+  }
+  s->chunk_left--;
+  return raw_byte(s, b);
+}
+
+static bool bits(png_stream_t *s, uint32_t need, uint32_t *value)
+{
+  uint32_t buf = s->bit_buf;
+  while (s->bit_count < need)
+  {
+    uint8_t b;
+    if (!idat_byte(s, &b))
+    {
+      return false;
+    }
+    buf |= (uint32_t)b << s->bit_count;
+    s->bit_count += 8;
+  }
+  s->bit_buf = buf >> need;
+  s->bit_count -= need;
+  *value = buf & ((1u << need) - 1);
+  return true;
+}
+
+// Lookup entries for the codes of up to INFLATE_FAST_BITS bits; deflate sends
+// codes starting with the most significant bit, so the index is reversed
+static void build_fast(huffman_t *h)
+{
+  uint32_t code = 0;
+  uint32_t index = 0;
+  for (uint32_t len = 1; len <= INFLATE_FAST_BITS; len++)
+  {
+    for (uint32_t i = 0; i < h->count[len]; i++, code++, index++)
+    {
+      uint32_t reversed = 0;
+      for (uint32_t bit = 0; bit < len; bit++)
+      {
+        reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+      }
+      for (uint32_t fill = reversed; fill < (1u << INFLATE_FAST_BITS); fill += 1u << len)
+      {
+        h->fast[fill] = h->symbol[index] << 4 | len;
+      }
+    }
+    code <<= 1;
+  }
+}
+
+// Build a code from the code lengths; < 0 if over-subscribed, > 0 if incomplete
+static int construct(huffman_t *h, const uint8_t *length, int n)
+{
+  uint16_t offs[INFLATE_MAX_BITS + 1];
+
+  if (h->fast != nullptr)
+  {
+    memset(h->fast, 0, (1 << INFLATE_FAST_BITS) * sizeof(uint16_t));
+  }
+  memset(h->count, 0, (INFLATE_MAX_BITS + 1) * sizeof(uint16_t));
+  for (int symbol = 0; symbol < n; symbol++)
+  {
+    h->count[length[symbol]]++;
+  }
+  if (h->count[0] == n)
+  {
+    return 0;
+  }
+
+  int left = 1;
+  for (int len = 1; len <= INFLATE_MAX_BITS; len++)
+  {
+    left <<= 1;
+    left -= h->count[len];
+    if (left < 0)
+      return left;
+  }
+
+  offs[1] = 0;
+  for (int len = 1; len < INFLATE_MAX_BITS; len++)
+  {
+    offs[len + 1] = offs[len] + h->count[len];
+  }
+  for (int symbol = 0; symbol < n; symbol++)
+  {
+    if (length[symbol] != 0)
+      h->symbol[offs[length[symbol]]++] = symbol;
+  }
+  if (h->fast != nullptr)
+  {
+    build_fast(h);
+  }
+  return left;
+}
+
+// Decode one symbol: one lookup for short codes, else bit by bit
+static int decode(png_stream_t *s, const huffman_t *h)
+{
+  if (h->fast != nullptr)
+  {
+    // Near the end of the stream fewer bits may be left
+    while (s->bit_count < INFLATE_FAST_BITS)
+    {
+      uint8_t b;
+      if (!idat_byte(s, &b))
+      {
+        break;
+      }
+      s->bit_buf |= (uint32_t)b << s->bit_count;
+      s->bit_count += 8;
+    }
+
+    uint16_t entry = h->fast[s->bit_buf & ((1u << INFLATE_FAST_BITS) - 1)];
+    uint32_t len = entry & 0x0F;
+    if (len != 0 && len <= s->bit_count)
+    {
+      s->bit_buf >>= len;
+      s->bit_count -= len;
+      return entry >> 4;
+    }
+  }
+
+  int code = 0, first = 0, index = 0;
+  uint32_t buf = s->bit_buf;
+  int left = s->bit_count;
+  int len = 1;
+  const uint16_t *next = h->count + 1;
+
+  while (true)
+  {
+    while (left--)
+    {
+      code |= buf & 1;
+      buf >>= 1;
+      int count = *next++;
+      if (code - count < first)
+      {
+        s->bit_buf = buf;
+        // Within the buffered bits, or fewer than 8 of the last byte read
+        s->bit_count = (uint32_t)len <= s->bit_count ? s->bit_count - len : (s->bit_count - len) & 7;
+        return h->symbol[index + (code - first)];
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+      len++;
+    }
+
+    left = (INFLATE_MAX_BITS + 1) - len;
+    if (left == 0)
+    {
+      return -1;
+    }
+    uint8_t b;
+    if (!idat_byte(s, &b))
+    {
+      return -1;
+    }
+    buf = b;
+    if (left > 8)
+      left = 8;
+  }
+}
+
+static bool fixed_codes(png_stream_t *s)
+{
+  uint8_t lengths[INFLATE_FIXED_LCODES];
+  int symbol = 0;
+  for (; symbol < 144; symbol++)
+    lengths[symbol] = 8;
+  for (; symbol < 256; symbol++)
+    lengths[symbol] = 9;
+  for (; symbol < 280; symbol++)
+    lengths[symbol] = 7;
+  for (; symbol < INFLATE_FIXED_LCODES; symbol++)
+    lengths[symbol] = 8;
+  construct(&s->lencode, lengths, INFLATE_FIXED_LCODES);
+
+  for (symbol = 0; symbol < INFLATE_MAX_DCODES; symbol++)
+    lengths[symbol] = 5;
+  construct(&s->distcode, lengths, INFLATE_MAX_DCODES);
+  return true;
+}
+
+static bool dynamic_codes(png_stream_t *s)
+{
+  static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+  uint8_t lengths[INFLATE_MAX_LCODES + INFLATE_MAX_DCODES];
+
+  uint32_t nlen, ndist, ncode;
+  if (!bits(s, 5, &nlen) || !bits(s, 5, &ndist) || !bits(s, 4, &ncode))
+  {
+    return false;
+  }
+  nlen += 257;
+  ndist += 1;
+  ncode += 4;
+  if (nlen > INFLATE_MAX_LCODES || ndist > INFLATE_MAX_DCODES)
+  {
+    return false;
+  }
+
+  uint32_t index = 0;
+  for (; index < ncode; index++)
+  {
+    uint32_t len;
+    if (!bits(s, 3, &len))
+      return false;
+    lengths[order[index]] = len;
+  }
+  for (; index < 19; index++)
+  {
+    lengths[order[index]] = 0;
+  }
+
+  // Code length code, decoded with the literal/length tables
+  if (construct(&s->lencode, lengths, 19) != 0)
+  {
+    return false;
+  }
+
+  index = 0;
+  while (index < nlen + ndist)
+  {
+    int symbol = decode(s, &s->lencode);
+    if (symbol < 0)
+    {
+      return false;
+    }
+    if (symbol < 16)
+    {
+      lengths[index++] = symbol;
+      continue;
+    }
+
+    uint8_t len = 0;
+    uint32_t repeat;
+    if (symbol == 16)
+    {
+      if (index == 0 || !bits(s, 2, &repeat))
+        return false;
+      len = lengths[index - 1];
+      repeat += 3;
+    }
+    else if (symbol == 17)
+    {
+      if (!bits(s, 3, &repeat))
+        return false;
+      repeat += 3;
+    }
+    else
+    {
+      if (!bits(s, 7, &repeat))
+        return false;
+      repeat += 11;
+    }
+    if (index + repeat > nlen + ndist)
+    {
+      return false;
+    }
+    while (repeat--)
+    {
+      lengths[index++] = len;
+    }
+  }
+
+  // End-of-block code required; incomplete codes only with a single code
+  if (lengths[256] == 0)
+  {
+    return false;
+  }
+  int err = construct(&s->lencode, lengths, nlen);
+  if (err < 0 || (err > 0 && nlen - s->lencode.count[0] != 1))
+  {
+    return false;
+  }
+  err = construct(&s->distcode, lengths + nlen, ndist);
+  if (err < 0 || (err > 0 && ndist - s->distcode.count[0] != 1))
+  {
+    return false;
+  }
+  return true;
+}
+
+static inline void emit(png_stream_t *s, uint8_t b)
+{
+  s->window[s->window_pos] = b;
+  if (++s->window_pos == s->window_size)
+  {
+    s->window_pos = 0;
+  }
+  if (s->window_fill < s->window_size)
+  {
+    s->window_fill++;
+  }
+}
+
+// Inflate exactly `n` bytes into `out`, continuing where the last call stopped
+static bool inflate_bytes(png_stream_t *s, uint8_t *out, uint32_t n)
+{
+  static const uint16_t len_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const uint8_t len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const uint16_t dist_base[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                         33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                         1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  static const uint8_t dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                         6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  while (n > 0)
+  {
+    // Pending match from the window
+    if (s->match_len > 0)
+    {
+      uint32_t from = s->window_pos >= s->match_dist ? s->window_pos - s->match_dist
+                                                     : s->window_pos + s->window_size - s->match_dist;
+      while (s->match_len > 0 && n > 0)
+      {
+        uint8_t b = s->window[from];
+        if (++from == s->window_size)
+        {
+          from = 0;
+        }
+        emit(s, b);
+        *out++ = b;
+        s->match_len--;
+        n--;
+      }
+      continue;
+    }
+
+    if (s->block == BLOCK_HEADER)
+    {
+      if (s->last_block)
+      {
+        return false; // Stream ended before the image
+      }
+
+      uint32_t last, type;
+      if (!bits(s, 1, &last) || !bits(s, 2, &type))
+      {
+        return false;
+      }
+      s->last_block = last != 0;
+
+      if (type == 0)
+      {
+        // Stored: byte aligned LEN and its complement; whole bytes
+        // already in the bit buffer come first
+        uint32_t skip = s->bit_count & 7;
+        s->bit_buf >>= skip;
+        s->bit_count -= skip;
+        uint32_t len, nlen;
+        if (!bits(s, 16, &len) || !bits(s, 16, &nlen))
+        {
+          return false;
+        }
+        if (len != (~nlen & 0xFFFF))
+        {
+          return false;
+        }
+        s->stored_left = len;
+        s->block = BLOCK_STORED;
+      }
+      else if (type == 1 || type == 2)
+      {
+        if (!(type == 1 ? fixed_codes(s) : dynamic_codes(s)))
+        {
+          return false;
+        }
+        s->block = BLOCK_CODES;
+      }
+      else
+      {
+        return false;
+      }
+      continue;
+    }
+
+    if (s->block == BLOCK_STORED)
+    {
+      if (s->stored_left == 0)
+      {
+        s->block = BLOCK_HEADER;
+        continue;
+      }
+      uint8_t b;
+      if (!idat_byte(s, &b))
+      {
+        return false;
+      }
+      emit(s, b);
+      *out++ = b;
+      s->stored_left--;
+      n--;
+      continue;
+    }
+
+    int symbol = decode(s, &s->lencode);
+    if (symbol < 0)
+    {
+      return false;
+    }
+    if (symbol < 256)
+    {
+      emit(s, symbol);
+      *out++ = symbol;
+      n--;
+      continue;
+    }
+    if (symbol == 256)
+    {
+      s->block = BLOCK_HEADER;
+      continue;
+    }
+
+    symbol -= 257;
+    if (symbol >= 29)
+    {
+      return false;
+    }
+    uint32_t extra;
+    if (!bits(s, len_extra[symbol], &extra))
+    {
+      return false;
+    }
+    s->match_len = len_base[symbol] + extra;
+
+    symbol = decode(s, &s->distcode);
+    if (symbol < 0 || symbol >= 30 || !bits(s, dist_extra[symbol], &extra))
+    {
+      return false;
+    }
+    s->match_dist = dist_base[symbol] + extra;
+    if (s->match_dist > s->window_fill)
+    {
+      return false; // Before the start of the stream or beyond the window
+    }
+  }
+  return true;
+}
+
+static inline uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+  int p = a + b - c;
+  int pa = p > a ? p - a : a - p;
+  int pb = p > b ? p - b : b - p;
+  int pc = p > c ? p - c : c - p;
+  if (pa <= pb && pa <= pc)
+    return a;
+  return pb <= pc ? b : c;
+}
+
+static bool unfilter(png_stream_t *s, uint8_t type)
+{
+  uint8_t *cur = s->cur;
+  const uint8_t *prev = s->prev;
+  uint32_t bpp = s->bpp;
+  uint32_t n = s->row_bytes;
+
+  switch (type)
+  {
+  case 0:
+    break;
+  case 1:
+    for (uint32_t i = bpp; i < n; i++)
+      cur[i] += cur[i - bpp];
+    break;
+  case 2:
+    for (uint32_t i = 0; i < n; i++)
+      cur[i] += prev[i];
+    break;
+  case 3:
+    for (uint32_t i = 0; i < bpp; i++)
+      cur[i] += prev[i] >> 1;
+    for (uint32_t i = bpp; i < n; i++)
+      cur[i] += (cur[i - bpp] + prev[i]) >> 1;
+    break;
+  case 4:
+    for (uint32_t i = 0; i < bpp; i++)
+      cur[i] += prev[i];
+    for (uint32_t i = bpp; i < n; i++)
+      cur[i] += paeth(cur[i - bpp], prev[i], prev[i - bpp]);
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+// Unfiltered row to ARGB8888 (B, G, R, A bytes)
+static void convert_row(const png_stream_t *s, uint8_t *out)
+{
+  const uint8_t *in = s->cur;
+  uint32_t w = s->w;
+
+  switch (s->color_type)
+  {
+  case 6: // RGBA
+    for (uint32_t x = 0; x < w; x++, in += 4, out += 4)
+    {
+      out[0] = in[2];
+      out[1] = in[1];
+      out[2] = in[0];
+      out[3] = in[3];
+    }
+    break;
+  case 2: // RGB
+    for (uint32_t x = 0; x < w; x++, in += 3, out += 4)
+    {
+      out[0] = in[2];
+      out[1] = in[1];
+      out[2] = in[0];
+      out[3] = s->has_key && in[0] == s->key[0] && in[1] == s->key[1] && in[2] == s->key[2] ? 0 : 255;
+    }
+    break;
+  case 4: // Gray + alpha
+    for (uint32_t x = 0; x < w; x++, in += 2, out += 4)
+    {
+      out[0] = out[1] = out[2] = in[0];
+      out[3] = in[1];
+    }
+    break;
+  case 0: // Gray
+    for (uint32_t x = 0; x < w; x++, in++, out += 4)
+    {
+      out[0] = out[1] = out[2] = in[0];
+      out[3] = s->has_key && in[0] == s->key[0] ? 0 : 255;
+    }
+    break;
+  default: // Palette, 1..8 bits per index, leftmost pixel in the high bits
+  {
+    uint32_t depth = s->bit_depth;
+    uint32_t mask = (1u << depth) - 1;
+    for (uint32_t x = 0; x < w; x++, out += 4)
+    {
+      uint32_t bit = x * depth;
+      uint32_t index = (in[bit >> 3] >> (8 - depth - (bit & 7))) & mask;
+      memcpy(out, s->palette[index], 4);
+    }
+    break;
+  }
+  }
+}
+
+// Supported IHDR fields; bytes per pixel for the filters and the row size
+static bool supported_header(const uint8_t *ihdr, uint32_t *w, uint32_t *h, uint32_t *bpp, uint32_t *row_bytes)
+{
+  *w = read_u32_be(ihdr);
+  *h = read_u32_be(ihdr + 4);
+  uint8_t depth = ihdr[8];
+  uint8_t color_type = ihdr[9];
+  uint8_t interlace = ihdr[12];
+
+  uint32_t channels;
+  switch (color_type)
+  {
+  case 0:
+    channels = 1;
+    break;
+  case 2:
+    channels = 3;
+    break;
+  case 3:
+    channels = 1;
+    break;
+  case 4:
+    channels = 2;
+    break;
+  case 6:
+    channels = 4;
+    break;
+  default:
+    return false;
+  }
+
+  bool depth_ok = color_type == 3 ? (depth == 1 || depth == 2 || depth == 4 || depth == 8) : depth == 8;
+  if (!depth_ok || interlace != 0 || *w == 0 || *h == 0 || *w > 4096 || *h > 4096)
+  {
+    return false;
+  }
+
+  uint32_t bits_per_pixel = channels * depth;
+  *bpp = bits_per_pixel >= 8 ? bits_per_pixel / 8 : 1;
+  *row_bytes = (*w * bits_per_pixel + 7) / 8;
+  return true;
+}
+
+png_stream_t *lvgl_png_stream_open(const char *path)
+{
+  png_stream_t *s = static_cast<png_stream_t *>(lv_malloc(sizeof(png_stream_t)));
+  if (s == nullptr)
+  {
+    return nullptr;
+  }
+  memset(s, 0, sizeof(png_stream_t));
+
+  if (lv_fs_open(&s->file, path, LV_FS_MODE_RD) != LV_FS_RES_OK)
+  {
+    lv_free(s);
+    return nullptr;
+  }
+  if (strlen(path) < sizeof(s->path))
+  {
+    strcpy(s->path, path);
+  }
+
+  // Signature and chunks up to the first IDAT
+  uint8_t head[13];
+  bool ok = raw_bytes(s, head, sizeof(png_signature)) && memcmp(head, png_signature, sizeof(png_signature)) == 0;
+  bool have_header = false;
+  while (ok)
+  {
+    uint32_t len, type;
+    if (!raw_u32(s, &len) || !raw_u32(s, &type))
+    {
+      ok = false;
+      break;
+    }
+
+    if (type == PNG_CHUNK_IHDR && len == 13)
+    {
+      ok = raw_bytes(s, head, 13) &&
+           supported_header(head, &s->w, &s->h, &s->bpp, &s->row_bytes) && raw_skip(s, 4);
+      s->bit_depth = head[8];
+      s->color_type = head[9];
+      have_header = ok;
+    }
+    else if (!have_header)
+    {
+      ok = false;
+    }
+    else if (type == PNG_CHUNK_PLTE && len <= 256 * 3 && len % 3 == 0)
+    {
+      for (uint32_t i = 0; ok && i < len / 3; i++)
+      {
+        uint8_t rgb[3];
+        ok = raw_bytes(s, rgb, 3);
+        s->palette[i][0] = rgb[2];
+        s->palette[i][1] = rgb[1];
+        s->palette[i][2] = rgb[0];
+        s->palette[i][3] = 255;
+      }
+      ok = ok && raw_skip(s, 4);
+    }
+    else if (type == PNG_CHUNK_TRNS && s->color_type == 3 && len <= 256)
+    {
+      for (uint32_t i = 0; ok && i < len; i++)
+      {
+        ok = raw_byte(s, &s->palette[i][3]);
+      }
+      ok = ok && raw_skip(s, 4);
+    }
+    else if (type == PNG_CHUNK_TRNS && (s->color_type == 0 || s->color_type == 2) &&
+             len == (s->color_type == 0 ? 2u : 6u))
+    {
+      uint8_t key[6];
+      ok = raw_bytes(s, key, len) && raw_skip(s, 4);
+      for (uint32_t i = 0; i < len / 2; i++)
+      {
+        s->key[i] = key[i * 2] << 8 | key[i * 2 + 1];
+      }
+      s->has_key = true;
+    }
+    else if (type == PNG_CHUNK_IDAT)
+    {
+      s->chunk_left = len;
+      break;
+    }
+    else if (type == PNG_CHUNK_IEND)
+    {
+      ok = false;
+    }
+    else
+    {
+      ok = raw_skip(s, len + 4);
+    }
+  }
+
+  // zlib header: deflate, no preset dictionary; CINFO gives the window size
+  uint8_t cmf = 0, flg = 0;
+  ok = ok && idat_byte(s, &cmf) && idat_byte(s, &flg) && (cmf & 0x0F) == 8 && (cmf >> 4) <= 7 &&
+       (cmf << 8 | flg) % 31 == 0 && (flg & 0x20) == 0;
+
+  if (ok)
+  {
+    // Distances never reach before the start of the stream
+    uint32_t total = s->h * (s->row_bytes + 1);
+    s->window_size = 1u << ((cmf >> 4) + 8);
+    if (s->window_size > total)
+    {
+      s->window_size = total;
+    }
+
+    s->window = static_cast<uint8_t *>(lv_malloc(s->window_size + 2 * s->row_bytes));
+    ok = s->window != nullptr;
+  }
+  if (!ok)
+  {
+    lv_fs_close(&s->file);
+    lv_free(s);
+    return nullptr;
+  }
+
+  s->prev = s->window + s->window_size;
+  s->cur = s->prev + s->row_bytes;
+  memset(s->prev, 0, s->row_bytes);
+  s->lencode.count = s->len_count;
+  s->lencode.symbol = s->len_symbol;
+  s->lencode.fast = s->len_fast;
+  s->distcode.count = s->dist_count;
+  s->distcode.symbol = s->dist_symbol;
+  s->distcode.fast = nullptr;
+  s->block = BLOCK_HEADER;
+  return s;
+}
+
+void lvgl_png_stream_get_size(const png_stream_t *stream, uint32_t *w, uint32_t *h)
+{
+  *w = stream->w;
+  *h = stream->h;
+}
+
+bool lvgl_png_stream_read_row(png_stream_t *stream, uint8_t *out)
+{
+  if (stream->row >= stream->h)
+  {
+    return false;
+  }
+
+  uint8_t filter;
+  if (!inflate_bytes(stream, &filter, 1) || !inflate_bytes(stream, stream->cur, stream->row_bytes) ||
+      !unfilter(stream, filter))
+  {
+    return false;
+  }
+  if (out != nullptr)
+  {
+    convert_row(stream, out);
+  }
+
+  uint8_t *prev = stream->prev;
+  stream->prev = stream->cur;
+  stream->cur = prev;
+  stream->row++;
+  return true;
+}
+
+uint32_t lvgl_png_stream_memory(const png_stream_t *stream)
+{
+  return sizeof(png_stream_t) + stream->window_size + 2 * stream->row_bytes;
+}
+
+void lvgl_png_stream_close(png_stream_t *stream)
+{
+  if (stream == nullptr)
+  {
+    return;
+  }
+  lv_fs_close(&stream->file);
+  lv_free(stream->window);
+  lv_free(stream);
+}
+
+void lvgl_png_stream_set_enabled(bool on)
+{
+  enabled = on;
+  lvgl_png_stream_release();
+}
+
+bool lvgl_png_stream_get_enabled()
+{
+  return enabled;
+}
+
+void lvgl_png_stream_release()
+{
+  lvgl_png_stream_close(parked);
+  parked = nullptr;
+}
+
+const PngStreamStats &lvgl_png_stream_get_stats()
+{
+  return stats;
+}
+
+void lvgl_png_stream_reset_stats()
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+// Header of a "*.png" file this decoder handles
+static lv_result_t decoder_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+  (void)decoder; // Unused
+
+  if (!enabled || dsc->src_type != LV_IMAGE_SRC_FILE)
+  {
+    return LV_RESULT_INVALID;
+  }
+
+  // Signature, IHDR length and type, IHDR data
+  uint8_t head[8 + 8 + 13];
+  uint32_t n = 0;
+  const char *ext = lv_fs_get_ext(static_cast<const char *>(dsc->src));
+  if (strcmp(ext, "png") != 0 || lv_fs_seek(&dsc->file, 0, LV_FS_SEEK_SET) != LV_FS_RES_OK ||
+      lv_fs_read(&dsc->file, head, sizeof(head), &n) != LV_FS_RES_OK || n != sizeof(head) ||
+      memcmp(head, png_signature, sizeof(png_signature)) != 0 || read_u32_be(head + 12) != PNG_CHUNK_IHDR)
+  {
+    return LV_RESULT_INVALID;
+  }
+
+  uint32_t w, h, bpp, row_bytes;
+  if (!supported_header(head + 16, &w, &h, &bpp, &row_bytes))
+  {
+    return LV_RESULT_INVALID;
+  }
+
+  header->cf = LV_COLOR_FORMAT_ARGB8888;
+  header->w = w;
+  header->h = h;
+  header->stride = w * 4;
+  return LV_RESULT_OK;
+}
+
+// Nothing decoded yet: dsc->decoded stays NULL, so LVGL asks for areas
+static lv_result_t decoder_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+  (void)decoder; // Unused
+
+  png_session_t *session = static_cast<png_session_t *>(lv_malloc(sizeof(png_session_t)));
+  if (session == nullptr)
+  {
+    return LV_RESULT_INVALID;
+  }
+  session->stream = nullptr;
+  session->strip = nullptr;
+  dsc->user_data = session;
+  return LV_RESULT_OK;
+}
+
+// Stream positioned at row `y`: continue the parked stream of the same image
+// if it has not passed `y`, else start over; rows above `y` are decoded
+// into the strip and dropped
+static bool session_seek(png_session_t *session, const char *path, uint32_t y)
+{
+  png_stream_t *s = session->stream;
+  if (s != nullptr && s->row > y)
+  {
+    lvgl_png_stream_close(s);
+    s = nullptr;
+  }
+
+  if (s == nullptr && parked != nullptr && strcmp(parked->path, path) == 0 && parked->row <= y)
+  {
+    s = parked;
+    parked = nullptr;
+    stats.resumes++;
+  }
+  if (s == nullptr)
+  {
+    s = lvgl_png_stream_open(path);
+    if (s == nullptr)
+    {
+      session->stream = nullptr;
+      return false;
+    }
+    stats.opens++;
+  }
+  session->stream = s;
+
+  if (session->strip == nullptr)
+  {
+    session->strip = lv_draw_buf_create(s->w, PNG_STREAM_STRIP_ROWS, LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+    if (session->strip == nullptr)
+    {
+      LOG_ERROR("PNG stream: out of memory");
+      return false;
+    }
+
+    uint32_t bytes = lvgl_png_stream_memory(s) + session->strip->data_size;
+    if (bytes > stats.peak_bytes)
+    {
+      stats.peak_bytes = bytes;
+    }
+  }
+
+  while (s->row < y)
+  {
+    if (!lvgl_png_stream_read_row(s, nullptr))
+    {
+      return false;
+    }
+    stats.skipped++;
+  }
+  return true;
+}
+
+// Next strip of `full_area` (relative to the image); LVGL starts with
+// decoded_area->y1 == LV_COORD_MIN and stops at LV_RESULT_INVALID
+static lv_result_t decoder_get_area(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc,
+                                    const lv_area_t *full_area, lv_area_t *decoded_area)
+{
+  (void)decoder; // Unused
+
+  png_session_t *session = static_cast<png_session_t *>(dsc->user_data);
+  int32_t y = decoded_area->y1 == LV_COORD_MIN ? full_area->y1 : decoded_area->y2 + 1;
+  int32_t last = full_area->y2 < (int32_t)dsc->header.h - 1 ? full_area->y2 : (int32_t)dsc->header.h - 1;
+  if (y < 0 || y > last || !session_seek(session, static_cast<const char *>(dsc->src), y))
+  {
+    return LV_RESULT_INVALID;
+  }
+
+  lv_draw_buf_t *strip = session->strip;
+  uint32_t rows = last - y + 1;
+  if (rows > PNG_STREAM_STRIP_ROWS)
+  {
+    rows = PNG_STREAM_STRIP_ROWS;
+  }
+  for (uint32_t i = 0; i < rows; i++)
+  {
+    if (!lvgl_png_stream_read_row(session->stream, strip->data + i * strip->header.stride))
+    {
+      return LV_RESULT_INVALID;
+    }
+  }
+  stats.rows += rows;
+
+  strip->header.h = rows;
+  dsc->decoded = strip;
+  decoded_area->x1 = 0;
+  decoded_area->x2 = dsc->header.w - 1;
+  decoded_area->y1 = y;
+  decoded_area->y2 = y + rows - 1;
+  return LV_RESULT_OK;
+}
+
+// A stream in the middle of the image is parked for the next band;
+// finished ones are freed
+static void decoder_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+  (void)decoder; // Unused
+
+  png_session_t *session = static_cast<png_session_t *>(dsc->user_data);
+  if (session == nullptr)
+  {
+    return;
+  }
+
+  png_stream_t *s = session->stream;
+  if (s != nullptr && s->row < s->h && s->path[0] != '\0')
+  {
+    lvgl_png_stream_release();
+    parked = s;
+  }
+  else
+  {
+    lvgl_png_stream_close(s);
+  }
+
+  if (session->strip != nullptr)
+  {
+    session->strip->header.h = PNG_STREAM_STRIP_ROWS;
+    lv_draw_buf_destroy(session->strip);
+  }
+  lv_free(session);
+  dsc->user_data = nullptr;
+  dsc->decoded = nullptr;
+}
+
+bool lvgl_png_stream_read(lv_image_decoder_dsc_t *dsc, uint8_t *out, uint32_t stride)
+{
+  lv_area_t full = {0, 0, (int32_t)dsc->header.w - 1, (int32_t)dsc->header.h - 1};
+  lv_area_t area = {LV_COORD_MIN, LV_COORD_MIN, LV_COORD_MIN, LV_COORD_MIN};
+  uint32_t row_bytes = dsc->header.w * 4;
+  int32_t next = 0;
+
+  while (lv_image_decoder_get_area(dsc, &full, &area) == LV_RESULT_OK)
+  {
+    const lv_draw_buf_t *strip = dsc->decoded;
+    for (int32_t y = area.y1; y <= area.y2; y++)
+    {
+      memcpy(out + y * stride, strip->data + (y - area.y1) * strip->header.stride, row_bytes);
+    }
+    next = area.y2 + 1;
+  }
+  return next == (int32_t)dsc->header.h;
+}
+
+void lvgl_png_stream_init()
+{
+  lv_image_decoder_t *decoder = lv_image_decoder_create();
+  if (decoder == nullptr)
+  {
+    LOG_ERROR("PNG stream: decoder not registered");
+    return;
+  }
+
+  lv_image_decoder_set_info_cb(decoder, decoder_info);
+  lv_image_decoder_set_open_cb(decoder, decoder_open);
+  lv_image_decoder_set_get_area_cb(decoder, decoder_get_area);
+  lv_image_decoder_set_close_cb(decoder, decoder_close);
+  decoder->name = "PNG_STREAM";
+}
@@ -0,0 +1,58 @@
+#ifndef LVGL_PNG_STREAM_H
+#define LVGL_PNG_STREAM_H
+
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// Streaming PNG decoder for LVGL
+// Inflates and unfilters a PNG file row by row while LVGL draws it: each strip
+// of PNG_STREAM_STRIP_ROWS rows is converted to ARGB8888 and handed to LVGL to
+// blend (get_area_cb), so no full-size image is allocated. Memory is the
+// deflate window (size from the zlib header, at most 32 KB and never more than
+// the image data), two rows and the strip, whatever the image size.
+// Handles 8-bit gray, gray + alpha, RGB and RGBA and 1..8-bit palette images,
+// not interlaced; other PNGs are left to LODEPNG. CRCs and the Adler-32
+// checksum are not verified.
+#define PNG_STREAM_READ_WINDOW 256
+#define PNG_STREAM_PATH_LEN 48
+
+// Decoder counters since the last reset
+struct PngStreamStats
+{
+  uint32_t opens;     // Streams started at the first row
+  uint32_t resumes;   // Streams continued from the previous draw of the image
+  uint32_t rows;      // Rows handed to LVGL
+  uint32_t skipped;   // Rows decoded only to reach a lower area
+  uint32_t peak_bytes; // Largest stream + strip allocation
+};
+
+typedef struct png_stream_t png_stream_t;
+
+// Register the decoder with LVGL (after lv_init; tried before LODEPNG)
+void lvgl_png_stream_init();
+
+// Disabled, every PNG is decoded by LODEPNG into a full image
+void lvgl_png_stream_set_enabled(bool enabled);
+bool lvgl_png_stream_get_enabled();
+
+// A stream left at a strip boundary is kept, with its file open, for the
+// next band of the same image; free it, e.g. before measuring the heap
+void lvgl_png_stream_release();
+
+// Copy an opened image LVGL decodes by area (dsc->decoded == NULL after
+// lv_image_decoder_open) into `out`, `stride` bytes per row
+bool lvgl_png_stream_read(lv_image_decoder_dsc_t *dsc, uint8_t *out, uint32_t stride);
+
+const PngStreamStats &lvgl_png_stream_get_stats();
+void lvgl_png_stream_reset_stats();
+
+// Direct use: open "S:/..." (nullptr if not a supported PNG), then read the
+// rows top to bottom as ARGB8888
+png_stream_t *lvgl_png_stream_open(const char *path);
+void lvgl_png_stream_get_size(const png_stream_t *stream, uint32_t *w, uint32_t *h);
+bool lvgl_png_stream_read_row(png_stream_t *stream, uint8_t *out);
+uint32_t lvgl_png_stream_memory(const png_stream_t *stream);
+void lvgl_png_stream_close(png_stream_t *stream);
+
+#endif // LVGL_PNG_STREAM_H
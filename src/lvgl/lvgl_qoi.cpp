@@ -0,0 +1,278 @@
+// Own header
+#include "lvgl_qoi.h"
+#include <Arduino.h>
+#include "../debug.h"
+
+#include <string.h>
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xC0
+#define QOI_OP_RGB 0xFE
+#define QOI_OP_RGBA 0xFF
+
+// Input bytes: a memory block, or a file read through `window`
+typedef struct
+{
+  const uint8_t *data;
+  uint32_t size;
+  uint32_t pos;
+  lv_fs_file_t *file;
+  uint8_t *window; // QOI_READ_WINDOW bytes
+} qoi_reader_t;
+
+static bool refill(qoi_reader_t *r)
+{
+  uint32_t n = 0;
+  if (r->file == nullptr || lv_fs_read(r->file, r->window, QOI_READ_WINDOW, &n) != LV_FS_RES_OK || n == 0)
+  {
+    return false;
+  }
+  r->data = r->window;
+  r->size = n;
+  r->pos = 0;
+  return true;
+}
+
+static inline bool next_byte(qoi_reader_t *r, uint8_t *b)
+{
+  if (r->pos >= r->size && !refill(r))
+  {
+    return false;
+  }
+  *b = r->data[r->pos++];
+  return true;
+}
+
+static uint32_t read_u32_be(const uint8_t *p)
+{
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+bool lvgl_qoi_info(const uint8_t *data, uint32_t size, uint32_t *w, uint32_t *h)
+{
+  if (size < QOI_HEADER_SIZE || memcmp(data, "qoif", 4) != 0 || (data[12] != 3 && data[12] != 4))
+  {
+    return false;
+  }
+
+  *w = read_u32_be(data + 4);
+  *h = read_u32_be(data + 8);
+  return *w > 0 && *h > 0 && *w <= QOI_MAX_SIZE && *h <= QOI_MAX_SIZE;
+}
+
+// Decode the pixels following the header into ARGB8888 (B, G, R, A bytes)
+static bool decode_pixels(qoi_reader_t *r, uint32_t w, uint32_t h, uint8_t *out, uint32_t stride)
+{
+  uint8_t index[64][4];
+  memset(index, 0, sizeof(index));
+
+  uint8_t px_r = 0, px_g = 0, px_b = 0, px_a = 255;
+  uint32_t run = 0;
+
+  for (uint32_t y = 0; y < h; y++)
+  {
+    uint8_t *dst = out + y * stride;
+    for (uint32_t x = 0; x < w; x++, dst += 4)
+    {
+      if (run > 0)
+      {
+        run--;
+      }
+      else
+      {
+        uint8_t op;
+        if (!next_byte(r, &op))
+        {
+          return false;
+        }
+
+        if (op == QOI_OP_RGB)
+        {
+          if (!next_byte(r, &px_r) || !next_byte(r, &px_g) || !next_byte(r, &px_b))
+            return false;
+        }
+        else if (op == QOI_OP_RGBA)
+        {
+          if (!next_byte(r, &px_r) || !next_byte(r, &px_g) || !next_byte(r, &px_b) || !next_byte(r, &px_a))
+            return false;
+        }
+        else
+        {
+          switch (op & 0xC0)
+          {
+          case QOI_OP_INDEX:
+            px_r = index[op][0];
+            px_g = index[op][1];
+            px_b = index[op][2];
+            px_a = index[op][3];
+            break;
+          case QOI_OP_DIFF:
+            px_r += ((op >> 4) & 0x03) - 2;
+            px_g += ((op >> 2) & 0x03) - 2;
+            px_b += (op & 0x03) - 2;
+            break;
+          case QOI_OP_LUMA:
+          {
+            uint8_t b2;
+            if (!next_byte(r, &b2))
+              return false;
+            int dg = (op & 0x3F) - 32;
+            px_r += dg - 8 + ((b2 >> 4) & 0x0F);
+            px_g += dg;
+            px_b += dg - 8 + (b2 & 0x0F);
+            break;
+          }
+          default: // QOI_OP_RUN: this pixel and `run` more
+            run = op & 0x3F;
+            break;
+          }
+        }
+
+        uint8_t *slot = index[(px_r * 3 + px_g * 5 + px_b * 7 + px_a * 11) & 63];
+        slot[0] = px_r;
+        slot[1] = px_g;
+        slot[2] = px_b;
+        slot[3] = px_a;
+      }
+
+      dst[0] = px_b;
+      dst[1] = px_g;
+      dst[2] = px_r;
+      dst[3] = px_a;
+    }
+  }
+  return true;
+}
+
+bool lvgl_qoi_decode(const uint8_t *data, uint32_t size, uint8_t *out, uint32_t stride)
+{
+  uint32_t w, h;
+  if (!lvgl_qoi_info(data, size, &w, &h))
+  {
+    return false;
+  }
+
+  // No window needed for data in memory
+  qoi_reader_t reader;
+  reader.data = data + QOI_HEADER_SIZE;
+  reader.size = size - QOI_HEADER_SIZE;
+  reader.pos = 0;
+  reader.file = nullptr;
+  reader.window = nullptr;
+  return decode_pixels(&reader, w, h, out, stride);
+}
+
+// Header of a QOI source: "*.qoi" file or image descriptor with QOI data
+static lv_result_t decoder_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+  (void)decoder; // Unused
+
+  uint8_t head[QOI_HEADER_SIZE];
+  if (dsc->src_type == LV_IMAGE_SRC_FILE)
+  {
+    const char *ext = lv_fs_get_ext(static_cast<const char *>(dsc->src));
+    uint32_t n = 0;
+    if (strcmp(ext, "qoi") != 0 || lv_fs_seek(&dsc->file, 0, LV_FS_SEEK_SET) != LV_FS_RES_OK ||
+        lv_fs_read(&dsc->file, head, sizeof(head), &n) != LV_FS_RES_OK || n != sizeof(head))
+    {
+      return LV_RESULT_INVALID;
+    }
+  }
+  else if (dsc->src_type == LV_IMAGE_SRC_VARIABLE)
+  {
+    const lv_image_dsc_t *image = static_cast<const lv_image_dsc_t *>(dsc->src);
+    if (image->data == nullptr || image->data_size < sizeof(head))
+    {
+      return LV_RESULT_INVALID;
+    }
+    memcpy(head, image->data, sizeof(head));
+  }
+  else
+  {
+    return LV_RESULT_INVALID;
+  }
+
+  uint32_t w, h;
+  if (!lvgl_qoi_info(head, sizeof(head), &w, &h))
+  {
+    return LV_RESULT_INVALID;
+  }
+
+  header->cf = LV_COLOR_FORMAT_ARGB8888;
+  header->w = w;
+  header->h = h;
+  header->stride = w * 4;
+  return LV_RESULT_OK;
+}
+
+// Decode the whole image into a draw buffer
+static lv_result_t decoder_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+  (void)decoder; // Unused
+
+  lv_draw_buf_t *decoded = lv_draw_buf_create(dsc->header.w, dsc->header.h, LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+  if (decoded == nullptr)
+  {
+    LOG_ERROR("QOI: out of memory");
+    return LV_RESULT_INVALID;
+  }
+
+  bool ok = false;
+  if (dsc->src_type == LV_IMAGE_SRC_FILE)
+  {
+    // Own handle: LVGL only keeps the file open for the header
+    lv_fs_file_t file;
+    if (lv_fs_open(&file, static_cast<const char *>(dsc->src), LV_FS_MODE_RD) == LV_FS_RES_OK)
+    {
+      uint8_t window[QOI_READ_WINDOW];
+      qoi_reader_t reader;
+      reader.data = window;
+      reader.size = 0;
+      reader.pos = 0;
+      reader.file = &file;
+      reader.window = window;
+      ok = lv_fs_seek(&file, QOI_HEADER_SIZE, LV_FS_SEEK_SET) == LV_FS_RES_OK &&
+           decode_pixels(&reader, dsc->header.w, dsc->header.h, decoded->data, decoded->header.stride);
+      lv_fs_close(&file);
+    }
+  }
+  else
+  {
+    const lv_image_dsc_t *image = static_cast<const lv_image_dsc_t *>(dsc->src);
+    ok = lvgl_qoi_decode(image->data, image->data_size, decoded->data, decoded->header.stride);
+  }
+
+  if (!ok)
+  {
+    lv_draw_buf_destroy(decoded);
+    return LV_RESULT_INVALID;
+  }
+
+  dsc->decoded = decoded;
+  return LV_RESULT_OK;
+}
+
+static void decoder_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+  (void)decoder; // Unused
+
+  lv_draw_buf_destroy(const_cast<lv_draw_buf_t *>(dsc->decoded));
+  dsc->decoded = nullptr;
+}
+
+void lvgl_qoi_init()
+{
+  lv_image_decoder_t *decoder = lv_image_decoder_create();
+  if (decoder == nullptr)
+  {
+    LOG_ERROR("QOI: decoder not registered");
+    return;
+  }
+
+  lv_image_decoder_set_info_cb(decoder, decoder_info);
+  lv_image_decoder_set_open_cb(decoder, decoder_open);
+  lv_image_decoder_set_close_cb(decoder, decoder_close);
+  decoder->name = "QOI";
+}
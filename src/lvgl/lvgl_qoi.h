@@ -0,0 +1,31 @@
+#ifndef LVGL_QOI_H
+#define LVGL_QOI_H
+
+#include <stdint.h>
+
+#include <lvgl.h>
+
+// QOI image decoder for LVGL ("Quite OK Image" format, qoiformat.org)
+// Lossless RGBA like PNG, but decoded in one pass with byte-sized ops and a
+// 64-entry color index: no inflate, no filters, no intermediate buffers.
+// Decodes "*.qoi" files and lv_image_dsc_t data starting with "qoif" into
+// ARGB8888, reading files through a small window. The .qoi files are written
+// by resources/compile_icons.py.
+#define QOI_HEADER_SIZE 14
+#define QOI_READ_WINDOW 256
+#define QOI_MAX_SIZE 1024 // Largest width/height accepted
+
+// Decoder memory besides the output buffer (color index + read window)
+#define QOI_WORKING_BYTES (64 * 4 + QOI_READ_WINDOW)
+
+// Register the decoder with LVGL (after lv_init)
+void lvgl_qoi_init();
+
+// Decode `size` bytes of QOI data into `out` (ARGB8888, `stride` bytes per
+// row, w x h from the header); false if the data is not a valid image
+bool lvgl_qoi_decode(const uint8_t *data, uint32_t size, uint8_t *out, uint32_t stride);
+
+// Width and height from a QOI header; false if `data` is not one
+bool lvgl_qoi_info(const uint8_t *data, uint32_t size, uint32_t *w, uint32_t *h);
+
+#endif // LVGL_QOI_H
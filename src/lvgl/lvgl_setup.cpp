@@ -1,24 +1,156 @@
 // Own header
 #include "lvgl_setup.h"
 #include "lvgl_fs_spiffs.h"
+#include "lvgl_png_stream.h"
+#include "lvgl_qoi.h"
+#include "rgb565_swap.h"
+#include "../debug.h"
+#include "trace.h"
+
+#include <stdlib.h>
+
+#ifdef ESP_PLATFORM
+#include <driver/ledc.h>
+#include <esp_heap_caps.h>
+#include <esp_idf_version.h>
+#include <esp_sleep.h>
+#endif
+
+#if DISPLAY_TRANSPORT == DISPLAY_TRANSPORT_ESP_LCD
+#include "transport_esp_lcd.h"
+#elif DISPLAY_TRANSPORT == DISPLAY_TRANSPORT_FRAMEBUFFER
+#include "transport_framebuffer.h"
+#else
+#include "transport_adafruit.h"
+#endif
 
 // Global objects
-Adafruit_ST7789 tft = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
 lv_display_t *disp = nullptr;
-static lv_color_t buf[LVGL_BUFFER_SIZE];
+static DisplayTransport *active_transport = nullptr;
+static DisplayFlush *flush_pipeline = nullptr;
+static AreaCoalescer *area_coalescer = nullptr;
 
-// Display flush function for LVGL v9
-void my_disp_flush(lv_display_t *disp_drv, const lv_area_t *area, uint8_t *px_map)
+// Draw buffers of the active strategy
+// 64-byte alignment also covers the 16 bytes the SIMD swap stage needs
+struct BufferSet
+{
+  int strategy;
+  void *draw[2];  // LVGL draw buffers (full frame in direct mode)
+  void *bounce[2]; // Direct mode only: internal DMA buffers streamed to the panel
+  size_t internal_bytes;
+  size_t psram_bytes;
+};
+
+static BufferSet buffers = {-1, {nullptr, nullptr}, {nullptr, nullptr}, 0, 0};
+
+// LVGL tick source, so timers and the refresh period advance
+static uint32_t lvgl_tick_cb()
+{
+  return millis();
+}
+
+static void flush_ready_cb(void *user_ctx)
+{
+  (void)user_ctx; // Unused
+  lv_display_flush_ready(disp);
+}
+
+// LVGL waits here for the buffer it is about to render into; the transfer is
+// reported by polling, so LVGL never depends on the DMA interrupt
+static void flush_wait_cb(lv_display_t *disp_drv)
+{
+  (void)disp_drv; // Unused
+  flush_pipeline->waitIdle();
+}
+
+void *lvgl_buffer_alloc(size_t bytes, bool psram)
+{
+  bytes = (bytes + LVGL_BUFFER_ALIGN - 1) & ~(size_t)(LVGL_BUFFER_ALIGN - 1);
+#ifdef ESP_PLATFORM
+  uint32_t caps = psram ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : (MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  return heap_caps_aligned_alloc(LVGL_BUFFER_ALIGN, bytes, caps);
+#else
+  (void)psram; // Unused
+  return aligned_alloc(LVGL_BUFFER_ALIGN, bytes);
+#endif
+}
+
+void lvgl_buffer_free(void *ptr)
+{
+#ifdef ESP_PLATFORM
+  heap_caps_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+static void buffer_set_free(BufferSet &set)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    lvgl_buffer_free(set.draw[i]);
+    lvgl_buffer_free(set.bounce[i]);
+    set.draw[i] = nullptr;
+    set.bounce[i] = nullptr;
+  }
+  set.strategy = -1;
+  set.internal_bytes = 0;
+  set.psram_bytes = 0;
+}
+
+// Allocate everything a strategy needs, false (and nothing kept) on failure
+static bool buffer_set_alloc(BufferSet &set, int strategy)
 {
-  uint32_t w = (area->x2 - area->x1 + 1);
-  uint32_t h = (area->y2 - area->y1 + 1);
+  set.strategy = strategy;
 
-  tft.startWrite();
-  tft.setAddrWindow(area->x1, area->y1, w, h);
-  tft.writePixels((uint16_t *)px_map, w * h);
-  tft.endWrite();
+  if (strategy == LVGL_BUFFERS_DIRECT_PSRAM)
+  {
+    size_t frame_bytes = (size_t)SCREEN_HEIGHT *
+                         lv_draw_buf_width_to_stride(SCREEN_WIDTH, LV_COLOR_FORMAT_RGB565);
+    size_t bounce_bytes = (size_t)SCREEN_WIDTH * LVGL_DIRECT_BOUNCE_LINES * (LV_COLOR_DEPTH / 8);
+    set.draw[0] = lvgl_buffer_alloc(frame_bytes, true);
+    set.bounce[0] = lvgl_buffer_alloc(bounce_bytes, false);
+    set.bounce[1] = lvgl_buffer_alloc(bounce_bytes, false);
+    set.psram_bytes = frame_bytes;
+    set.internal_bytes = 2 * bounce_bytes;
+  }
+  else
+  {
+    set.draw[0] = lvgl_buffer_alloc(LVGL_BUFFER_BYTES, false);
+    set.internal_bytes = LVGL_BUFFER_BYTES;
+    if (strategy == LVGL_BUFFERS_PARTIAL_DOUBLE)
+    {
+      set.draw[1] = lvgl_buffer_alloc(LVGL_BUFFER_BYTES, false);
+      set.internal_bytes += LVGL_BUFFER_BYTES;
+    }
+  }
 
-  lv_display_flush_ready(disp_drv);
+  bool ok = set.draw[0] != nullptr &&
+            (strategy != LVGL_BUFFERS_PARTIAL_DOUBLE || set.draw[1] != nullptr) &&
+            (strategy != LVGL_BUFFERS_DIRECT_PSRAM || (set.bounce[0] != nullptr && set.bounce[1] != nullptr));
+  if (!ok)
+  {
+    buffer_set_free(set);
+  }
+  return ok;
+}
+
+// Display flush function for LVGL v9
+void my_disp_flush(lv_display_t *disp_drv, const lv_area_t *area, uint8_t *px_map)
+{
+  TRACE_SCOPE("flush");
+  if (buffers.strategy == LVGL_BUFFERS_DIRECT_PSRAM)
+  {
+    // px_map is the whole frame; send just the invalidated area
+    uint32_t stride_px = lv_draw_buf_width_to_stride(SCREEN_WIDTH, LV_COLOR_FORMAT_RGB565) / 2;
+    flush_pipeline->submitRect(area->x1, area->y1, area->x2, area->y2, (const uint16_t *)px_map,
+                               stride_px, lv_display_flush_is_last(disp_drv));
+  }
+  else
+  {
+    flush_pipeline->submit(area->x1, area->y1, area->x2, area->y2, (uint16_t *)px_map,
+                           lv_display_flush_is_last(disp_drv));
+  }
 }
 
 void lvgl_setup_backlight()
@@ -27,35 +159,250 @@ void lvgl_setup_backlight()
   analogWrite(TFT_BL, TFT_BACKLIGHT_PWM);
 }
 
-void lvgl_setup_spi()
+#ifdef ESP_PLATFORM
+// LEDC timer and channel for the light sleep PWM, clear of the ones
+// analogWrite() hands out from 0 up
+#define BACKLIGHT_LEDC_TIMER LEDC_TIMER_3
+#define BACKLIGHT_LEDC_CHANNEL LEDC_CHANNEL_7
+
+// Backlight PWM from RC_FAST (~17.5 MHz), kept powered in light sleep
+static bool backlight_rc_fast_pwm()
 {
-  SPI.begin(TFT_SCLK, -1, TFT_MOSI, TFT_CS);
-  SPI.setFrequency(SPI_FREQUENCY);
+  ledc_timer_config_t timer = {};
+  timer.speed_mode = LEDC_LOW_SPEED_MODE;
+  timer.duty_resolution = LEDC_TIMER_8_BIT;
+  timer.timer_num = BACKLIGHT_LEDC_TIMER;
+  timer.freq_hz = TFT_BACKLIGHT_PWM_FREQ;
+// RC_FAST names since IDF 5.1
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+  timer.clk_cfg = LEDC_USE_RC_FAST_CLK;
+#else
+  timer.clk_cfg = LEDC_USE_RTC8M_CLK;
+#endif
+  if (ledc_timer_config(&timer) != ESP_OK)
+  {
+    return false;
+  }
+
+  ledc_channel_config_t channel = {};
+  channel.gpio_num = TFT_BL;
+  channel.speed_mode = LEDC_LOW_SPEED_MODE;
+  channel.channel = BACKLIGHT_LEDC_CHANNEL;
+  channel.timer_sel = BACKLIGHT_LEDC_TIMER;
+  channel.duty = TFT_BACKLIGHT_PWM;
+  if (ledc_channel_config(&channel) != ESP_OK)
+  {
+    return false;
+  }
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+  return esp_sleep_pd_config(ESP_PD_DOMAIN_RC_FAST, ESP_PD_OPTION_ON) == ESP_OK;
+#else
+  return esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON) == ESP_OK;
+#endif
 }
+#endif
 
-void lvgl_setup_display()
+// analogWrite()'s LEDC runs from the APB clock, which stops in light sleep
+// and would blank the backlight. Move it to RC_FAST at the same brightness,
+// or drive a steady full level with IDLE_BACKLIGHT_FULL (or if that fails).
+void lvgl_backlight_light_sleep()
 {
-#if DISPLAY_HORIZONTAL
-  tft.init(SCREEN_HEIGHT, SCREEN_WIDTH); // Init with physical dimensions
+  pinMode(TFT_BL, OUTPUT); // Detaches analogWrite()'s LEDC channel
+#if defined(ESP_PLATFORM) && !IDLE_BACKLIGHT_FULL
+  if (backlight_rc_fast_pwm())
+  {
+    LOG_INFOF("Backlight: %d%% PWM from RC_FAST through light sleep\n", BACKLIGHT_BRIGHTNESS);
+    return;
+  }
+  LOG_ERROR("Backlight: RC_FAST PWM not available, full brightness during light sleep");
+#endif
+  digitalWrite(TFT_BL, TFT_BACKLIGHT_ON);
+}
+
+// Create and start the transport selected by DISPLAY_TRANSPORT
+DisplayTransport *lvgl_setup_display()
+{
+#if DISPLAY_TRANSPORT == DISPLAY_TRANSPORT_ESP_LCD
+  static EspLcdTransport transport;
+#elif DISPLAY_TRANSPORT == DISPLAY_TRANSPORT_FRAMEBUFFER
+  static FramebufferTransport transport(SCREEN_WIDTH, SCREEN_HEIGHT);
 #else
-  tft.init(SCREEN_WIDTH, SCREEN_HEIGHT);
+  static AdafruitTransport transport;
 #endif
-  tft.setRotation(TFT_ROTATION);
+
+  if (!transport.begin())
+  {
+    LOG_ERRORF("Display transport '%s' failed to start\n", transport.name());
+  }
+  return &transport;
 }
 
-void lvgl_init_display()
+void lvgl_init_display(DisplayTransport *transport)
 {
+  active_transport = transport;
+  flush_pipeline = new DisplayFlush(transport, flush_ready_cb, nullptr);
+  flush_pipeline->begin();
+
   lv_init();
+  lv_tick_set_cb(lvgl_tick_cb);
   disp = lv_display_create(SCREEN_WIDTH, SCREEN_HEIGHT);
   lv_display_set_flush_cb(disp, my_disp_flush);
-  lv_display_set_buffers(disp, buf, NULL, sizeof(buf), LV_DISPLAY_RENDER_MODE_PARTIAL);
+  lv_display_set_flush_wait_cb(disp, flush_wait_cb);
+
+  area_coalescer = new AreaCoalescer(flush_pipeline);
+  area_coalescer->setEnabled(DISPLAY_AREA_COALESCING);
+  area_coalescer->attach(disp);
+
+  if (!lvgl_set_buffer_strategy(LVGL_BUFFER_STRATEGY) && LVGL_BUFFER_STRATEGY != LVGL_BUFFERS_PARTIAL)
+  {
+    // Always leave LVGL with something to render into
+    lvgl_set_buffer_strategy(LVGL_BUFFERS_PARTIAL);
+  }
+}
+
+const char *lvgl_buffer_strategy_name(int strategy)
+{
+  switch (strategy)
+  {
+  case LVGL_BUFFERS_PARTIAL:
+    return "partial";
+  case LVGL_BUFFERS_PARTIAL_DOUBLE:
+    return "partial_double";
+  case LVGL_BUFFERS_DIRECT_PSRAM:
+    return "direct_psram";
+  default:
+    return "none";
+  }
+}
+
+int lvgl_get_buffer_strategy()
+{
+  return buffers.strategy;
+}
+
+bool lvgl_set_buffer_strategy(int strategy)
+{
+  if (disp == nullptr || strategy == buffers.strategy)
+  {
+    return disp != nullptr;
+  }
+
+  BufferSet next = {-1, {nullptr, nullptr}, {nullptr, nullptr}, 0, 0};
+  if (!buffer_set_alloc(next, strategy))
+  {
+    LOG_ERRORF("LVGL buffers '%s': allocation failed, keeping '%s'\n",
+               lvgl_buffer_strategy_name(strategy), lvgl_buffer_strategy_name(buffers.strategy));
+    return false;
+  }
+
+  // The old buffers may still be on the wire
+  flush_pipeline->waitIdle();
+
+  if (strategy == LVGL_BUFFERS_DIRECT_PSRAM)
+  {
+    size_t frame_bytes = next.psram_bytes;
+    flush_pipeline->setBounceBuffers((uint16_t *)next.bounce[0], (uint16_t *)next.bounce[1],
+                                     SCREEN_WIDTH * LVGL_DIRECT_BOUNCE_LINES);
+    lv_display_set_buffers(disp, next.draw[0], NULL, frame_bytes, LV_DISPLAY_RENDER_MODE_DIRECT);
+  }
+  else
+  {
+    flush_pipeline->setBounceBuffers(nullptr, nullptr, 0);
+    lv_display_set_buffers(disp, next.draw[0], next.draw[1], LVGL_BUFFER_BYTES,
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+  }
+
+  buffer_set_free(buffers);
+  buffers = next;
+
+  // Direct mode keeps the previous frame, so start from a complete one
+  lv_obj_invalidate(lv_screen_active());
+
+  size_t partial_double_bytes = 2 * LVGL_BUFFER_BYTES;
+  LOG_INFOF("LVGL buffers '%s': internal %lu B, PSRAM %lu B, internal saving vs partial_double %ld B\n",
+            lvgl_buffer_strategy_name(strategy), (unsigned long)buffers.internal_bytes,
+            (unsigned long)buffers.psram_bytes,
+            (long)partial_double_bytes - (long)buffers.internal_bytes);
+  return true;
+}
+
+DisplayTransport *lvgl_get_transport()
+{
+  return active_transport;
+}
+
+const DisplayFlush::Stats &lvgl_get_flush_stats()
+{
+  return flush_pipeline->getStats();
+}
+
+AreaCoalescer *lvgl_get_area_coalescer()
+{
+  return area_coalescer;
+}
+
+float lvgl_benchmark_flush(uint32_t frames)
+{
+  if (disp == nullptr || frames == 0)
+  {
+    return 0.0f;
+  }
+
+  flush_pipeline->resetStats();
+  unsigned long start = micros();
+
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(disp);
+  }
+
+  // The last band may still be on the wire
+  flush_pipeline->waitIdle();
+
+  unsigned long elapsed_us = micros() - start;
+  const DisplayFlush::Stats &stats = flush_pipeline->getStats();
+  float fps = elapsed_us > 0 ? (stats.frames * 1000000.0f) / elapsed_us : 0.0f;
+
+  LOG_INFOF("Flush benchmark [%s, %s]: %lu frames in %lu ms, %.1f fps, %lu us per full refresh\n",
+            active_transport->name(), lvgl_buffer_strategy_name(buffers.strategy),
+            (unsigned long)stats.frames, elapsed_us / 1000, fps,
+            stats.frames > 0 ? elapsed_us / stats.frames : 0UL);
+  LOG_INFOF("  flushes=%lu overlapped=%lu swaps=%lu dropped=%lu order_errors=%lu\n",
+            (unsigned long)stats.flushes, (unsigned long)stats.overlapped,
+            (unsigned long)stats.buffer_swaps, (unsigned long)stats.dropped,
+            (unsigned long)stats.order_errors);
+  return fps;
+}
+
+void lvgl_benchmark_buffer_strategies(uint32_t frames)
+{
+  if (disp == nullptr || frames == 0)
+  {
+    return;
+  }
+
+  // Swap stage throughput on one render band
+  rgb565_swap_benchmark(LVGL_BUFFER_SIZE, 200);
+
+  int original = buffers.strategy;
+  static const int strategies[] = {LVGL_BUFFERS_PARTIAL, LVGL_BUFFERS_PARTIAL_DOUBLE, LVGL_BUFFERS_DIRECT_PSRAM};
+  for (int strategy : strategies)
+  {
+    if (lvgl_set_buffer_strategy(strategy))
+    {
+      lvgl_benchmark_flush(frames);
+    }
+  }
+  lvgl_set_buffer_strategy(original);
 }
 
 void lvgl_setup()
 {
   lvgl_setup_backlight();
-  lvgl_setup_spi();
-  lvgl_setup_display();
-  lvgl_init_display();
+  lvgl_init_display(lvgl_setup_display());
   lvgl_fs_spiffs_init(); // Initialize SPIFFS filesystem driver
+  lvgl_qoi_init();       // QOI decoder next to LODEPNG and the bin decoder
+  lvgl_png_stream_init(); // Tried before LODEPNG for the PNGs it supports
 }
@@ -3,11 +3,8 @@
 
 // System libraries
 #include <Arduino.h>
-#include <SPI.h>
 
 // Third-party libraries
-#include <Adafruit_GFX.h>
-#include <Adafruit_ST7789.h>
 #include <lvgl.h>
 
 // ESP32-S3-LCD-1.47-Tiny-Board display pins
@@ -18,7 +15,8 @@
 #define TFT_RST 39            // Reset pin
 #define TFT_BL 48             // LED back-light control pin
 #define TFT_BACKLIGHT_ON HIGH // Level to turn ON back-light (HIGH or LOW)
-#define TFT_BACKLIGHT_PWM 180 // PWM value for backlight (0-255, 180 = ~70% brightness)
+#define TFT_BACKLIGHT_PWM (BACKLIGHT_BRIGHTNESS * 255 / 100) // PWM duty (0-255)
+#define TFT_BACKLIGHT_PWM_FREQ 5000 // Hz, light sleep PWM
 
 // Display dimensions for ESP32-S3-LCD-1.47-Tiny-Board
 // Physical panel: 172x320 pixels
@@ -40,18 +38,49 @@
 // LVGL buffer settings
 #define LVGL_BUFFER_LINES 15 // Buffer for 15 lines (optimized for 172px width)
 #define LVGL_BUFFER_SIZE (SCREEN_WIDTH * LVGL_BUFFER_LINES)
+#define LVGL_BUFFER_BYTES (LVGL_BUFFER_SIZE * (LV_COLOR_DEPTH / 8))
+
+// Direct mode: lines per bounce buffer used to stream dirty areas out of PSRAM
+#define LVGL_DIRECT_BOUNCE_LINES 8
+
+// Draw buffer allocation alignment (PSRAM cache line / DMA burst)
+#define LVGL_BUFFER_ALIGN 64
+
+// Project headers
+#include "area_coalescer.h"
+#include "display_flush.h"
+#include "display_transport.h"
 
 // External references
-extern Adafruit_ST7789 tft;
 extern lv_display_t *disp;
 
 // Function declarations
-void lvgl_setup_display();
-void lvgl_setup_spi();
+DisplayTransport *lvgl_setup_display();
 void lvgl_setup_backlight();
-void lvgl_init_display();
+void lvgl_backlight_light_sleep(); // Keep the backlight lit through light sleep
+void lvgl_init_display(DisplayTransport *transport);
 void my_disp_flush(lv_display_t *disp_drv, const lv_area_t *area, uint8_t *px_map);
 
+// Active panel transport and flush statistics
+DisplayTransport *lvgl_get_transport();
+const DisplayFlush::Stats &lvgl_get_flush_stats();
+AreaCoalescer *lvgl_get_area_coalescer();
+
+// LVGL_BUFFER_ALIGN-aligned pixel buffer: PSRAM, or internal DMA-capable SRAM
+void *lvgl_buffer_alloc(size_t bytes, bool psram);
+void lvgl_buffer_free(void *ptr);
+
+// Switch the draw buffers at runtime (LVGL_BUFFERS_*), false if allocation failed
+bool lvgl_set_buffer_strategy(int strategy);
+int lvgl_get_buffer_strategy();
+const char *lvgl_buffer_strategy_name(int strategy);
+
+// Time `frames` full-screen refreshes and return the achieved frame rate
+float lvgl_benchmark_flush(uint32_t frames);
+
+// Run the flush benchmark once per buffer strategy, then restore the current one
+void lvgl_benchmark_buffer_strategies(uint32_t frames);
+
 // Main setup function
 void lvgl_setup();
 
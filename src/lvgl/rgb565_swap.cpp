@@ -0,0 +1,215 @@
+// Own header
+#include "rgb565_swap.h"
+#include <Arduino.h>
+#include "../debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+
+#if RGB565_SWAP_USE_PIE && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define RGB565_SWAP_HAS_PIE 1
+#else
+#define RGB565_SWAP_HAS_PIE 0
+#endif
+
+// Swap the bytes of both halves of a 32-bit word
+static inline uint32_t swap_halfwords(uint32_t w)
+{
+  return ((w & 0x00FF00FFu) << 8) | ((w >> 8) & 0x00FF00FFu);
+}
+
+void rgb565_swap_ref(uint16_t *dst, const uint16_t *src, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint16_t p = src[i];
+    dst[i] = (uint16_t)((p >> 8) | (p << 8));
+  }
+}
+
+// Two pixels per 32-bit load/store, both pointers 4-byte aligned
+static void rgb565_swap_words(uint16_t *dst, const uint16_t *src, uint32_t pairs)
+{
+  const uint32_t *s = (const uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+
+  // Unrolled by four words (eight pixels)
+  while (pairs >= 4)
+  {
+    uint32_t w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+    d[0] = swap_halfwords(w0);
+    d[1] = swap_halfwords(w1);
+    d[2] = swap_halfwords(w2);
+    d[3] = swap_halfwords(w3);
+    s += 4;
+    d += 4;
+    pairs -= 4;
+  }
+  while (pairs--)
+  {
+    *d++ = swap_halfwords(*s++);
+  }
+}
+
+#if RGB565_SWAP_HAS_PIE
+// 16 pixels per iteration: unzip the two 128-bit halves into even/odd bytes,
+// then zip them back in the opposite order. Both pointers 16-byte aligned.
+static void rgb565_swap_pie(uint16_t *dst, const uint16_t *src, uint32_t blocks)
+{
+  asm volatile(
+      "1:\n"
+      "ee.vld.128.ip q0, %[s], 16\n"
+      "ee.vld.128.ip q1, %[s], 16\n"
+      "ee.vunzip.8 q0, q1\n"
+      "ee.vzip.8 q1, q0\n"
+      "ee.vst.128.ip q1, %[d], 16\n"
+      "ee.vst.128.ip q0, %[d], 16\n"
+      "addi %[n], %[n], -1\n"
+      "bnez %[n], 1b\n"
+      : [s] "+r"(src), [d] "+r"(dst), [n] "+r"(blocks)
+      :
+      : "memory");
+}
+#endif
+
+void rgb565_swap(uint16_t *dst, const uint16_t *src, uint32_t count)
+{
+  // Head: align to a 32-bit boundary (only possible if both share alignment)
+  if ((((uintptr_t)src ^ (uintptr_t)dst) & 3) != 0)
+  {
+    rgb565_swap_ref(dst, src, count);
+    return;
+  }
+  if (((uintptr_t)src & 3) != 0 && count > 0)
+  {
+    rgb565_swap_ref(dst, src, 1);
+    src++;
+    dst++;
+    count--;
+  }
+
+#if RGB565_SWAP_HAS_PIE
+  // Word-swap up to a 16-byte boundary, then hand the bulk to PIE
+  if ((((uintptr_t)src ^ (uintptr_t)dst) & 15) == 0)
+  {
+    uint32_t head = (uint32_t)((16 - ((uintptr_t)src & 15)) & 15) / 2;
+    if (head <= count)
+    {
+      rgb565_swap_words(dst, src, head / 2);
+      src += head;
+      dst += head;
+      count -= head;
+
+      uint32_t blocks = count / 16;
+      if (blocks > 0)
+      {
+        rgb565_swap_pie(dst, src, blocks);
+        src += blocks * 16;
+        dst += blocks * 16;
+        count -= blocks * 16;
+      }
+    }
+  }
+#endif
+
+  rgb565_swap_words(dst, src, count / 2);
+  if (count & 1)
+  {
+    rgb565_swap_ref(dst + count - 1, src + count - 1, 1);
+  }
+}
+
+void rgb565_pack_rect(uint16_t *dst, const uint16_t *src, uint32_t src_stride_px, uint32_t w, uint32_t h)
+{
+  for (uint32_t row = 0; row < h; row++)
+  {
+    rgb565_swap(dst, src, w);
+    dst += w;
+    src += src_stride_px;
+  }
+}
+
+const char *rgb565_swap_kernel_name()
+{
+#if RGB565_SWAP_HAS_PIE
+  return "pie";
+#else
+  return "word32";
+#endif
+}
+
+static float mb_per_s(uint32_t bytes, uint32_t rounds, unsigned long elapsed_us)
+{
+  return elapsed_us > 0 ? ((float)bytes * rounds) / (float)elapsed_us : 0.0f;
+}
+
+bool rgb565_swap_benchmark(uint32_t pixels, uint32_t rounds)
+{
+  // Slack for the misaligned variants below
+  uint16_t *src = (uint16_t *)malloc((pixels + 8) * sizeof(uint16_t));
+  uint16_t *expect = (uint16_t *)malloc((pixels + 8) * sizeof(uint16_t));
+  uint16_t *out = (uint16_t *)malloc((pixels + 8) * sizeof(uint16_t));
+  if (src == nullptr || expect == nullptr || out == nullptr)
+  {
+    free(src);
+    free(expect);
+    free(out);
+    return false;
+  }
+
+  uint32_t seed = 0x12345678u;
+  for (uint32_t i = 0; i < pixels + 8; i++)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    src[i] = (uint16_t)(seed >> 16);
+  }
+
+  // Verify every head/tail combination against the reference
+  bool ok = true;
+  for (uint32_t offset = 0; offset < 8 && ok; offset++)
+  {
+    for (uint32_t len = 0; len < 48 && len <= pixels && ok; len++)
+    {
+      rgb565_swap_ref(expect, src + offset, len);
+      rgb565_swap(out + offset, src + offset, len);
+      ok = memcmp(expect, out + offset, len * sizeof(uint16_t)) == 0;
+    }
+  }
+  rgb565_swap_ref(expect, src, pixels);
+  rgb565_swap(out, src, pixels);
+  ok = ok && memcmp(expect, out, pixels * sizeof(uint16_t)) == 0;
+
+  // In place must match too
+  memcpy(out, src, pixels * sizeof(uint16_t));
+  rgb565_swap(out, out, pixels);
+  ok = ok && memcmp(expect, out, pixels * sizeof(uint16_t)) == 0;
+
+  uint32_t bytes = pixels * sizeof(uint16_t);
+
+  unsigned long start = micros();
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    rgb565_swap_ref(out, src, pixels);
+  }
+  float ref_mbps = mb_per_s(bytes, rounds, micros() - start);
+
+  start = micros();
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    rgb565_swap(out, src, pixels);
+  }
+  float fast_mbps = mb_per_s(bytes, rounds, micros() - start);
+
+  LOG_INFOF("RGB565 swap %s: %lu px x %lu rounds, reference %.1f MB/s, %s %.1f MB/s\n",
+            ok ? "OK" : "MISMATCH", (unsigned long)pixels, (unsigned long)rounds,
+            ref_mbps, rgb565_swap_kernel_name(), fast_mbps);
+
+  free(src);
+  free(expect);
+  free(out);
+  return ok;
+}
@@ -0,0 +1,34 @@
+#ifndef RGB565_SWAP_H
+#define RGB565_SWAP_H
+
+#include <stdint.h>
+
+// RGB565 byte-swap / pack stage of the flush pipeline
+// LVGL renders little-endian RGB565, the ST7789 expects big-endian on the
+// wire. These kernels convert a whole transfer buffer in bulk instead of
+// leaving it to the panel driver pixel by pixel.
+
+// Use the ESP32-S3 PIE (128-bit SIMD) kernel when it is available
+#ifndef RGB565_SWAP_USE_PIE
+#define RGB565_SWAP_USE_PIE 1
+#endif
+
+// Portable reference kernel, one pixel at a time (dst may equal src)
+void rgb565_swap_ref(uint16_t *dst, const uint16_t *src, uint32_t count);
+
+// Default kernel: 32-bit word operations, PIE for 16-byte aligned runs on
+// the ESP32-S3 (dst may equal src)
+void rgb565_swap(uint16_t *dst, const uint16_t *src, uint32_t count);
+
+// Swap a w x h rectangle out of a wider buffer into a contiguous one
+void rgb565_pack_rect(uint16_t *dst, const uint16_t *src, uint32_t src_stride_px, uint32_t w, uint32_t h);
+
+// Name of the kernel rgb565_swap() dispatches to, for logs
+const char *rgb565_swap_kernel_name();
+
+// Check rgb565_swap() against the reference on `pixels` pixels (all
+// alignments), then log the throughput of both in MB/s. Returns false on a
+// mismatch.
+bool rgb565_swap_benchmark(uint32_t pixels, uint32_t rounds);
+
+#endif // RGB565_SWAP_H
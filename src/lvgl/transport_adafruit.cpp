@@ -0,0 +1,35 @@
+// Own header
+#include "transport_adafruit.h"
+#include "lvgl_setup.h"
+
+AdafruitTransport::AdafruitTransport() : tft(TFT_CS, TFT_DC, TFT_RST)
+{
+}
+
+bool AdafruitTransport::begin()
+{
+  SPI.begin(TFT_SCLK, -1, TFT_MOSI, TFT_CS);
+  SPI.setFrequency(SPI_FREQUENCY);
+
+#if DISPLAY_HORIZONTAL
+  tft.init(SCREEN_HEIGHT, SCREEN_WIDTH); // Init with physical dimensions
+#else
+  tft.init(SCREEN_WIDTH, SCREEN_HEIGHT);
+#endif
+  tft.setRotation(TFT_ROTATION);
+  return true;
+}
+
+bool AdafruitTransport::writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels)
+{
+  uint32_t w = (x2 - x1 + 1);
+  uint32_t h = (y2 - y1 + 1);
+
+  tft.startWrite();
+  tft.setAddrWindow(x1, y1, w, h);
+  tft.writePixels(pixels, w * h, true, true); // Already big-endian
+  tft.endWrite();
+
+  notifyTransferDone();
+  return true;
+}
@@ -0,0 +1,32 @@
+#ifndef TRANSPORT_ADAFRUIT_H
+#define TRANSPORT_ADAFRUIT_H
+
+// System libraries
+#include <SPI.h>
+
+// Third-party libraries
+#include <Adafruit_GFX.h>
+#include <Adafruit_ST7789.h>
+
+// Project headers
+#include "display_transport.h"
+
+// Blocking transport through Adafruit_ST7789::writePixels
+// Pixels arrive pre-swapped from the flush pipeline, so the library sends the
+// buffer as raw bytes; the call returns only after the last byte is out.
+class AdafruitTransport : public DisplayTransport
+{
+private:
+  Adafruit_ST7789 tft;
+
+public:
+  AdafruitTransport();
+
+  bool begin() override;
+  bool writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels) override;
+  bool isAsync() const override { return false; }
+  bool wantsBigEndian() const override { return true; }
+  const char *name() const override { return "adafruit"; }
+};
+
+#endif // TRANSPORT_ADAFRUIT_H
@@ -0,0 +1,114 @@
+// Own header
+#include "transport_esp_lcd.h"
+#include "lvgl_setup.h"
+
+// ESP-IDF
+#include <driver/spi_master.h>
+#include <esp_idf_version.h>
+#include <esp_lcd_panel_vendor.h>
+
+#define LCD_HOST SPI2_HOST
+#define LCD_TRANS_QUEUE_DEPTH 10
+
+// The 172px panel sits in the middle of the ST7789's 240-column RAM
+#define LCD_PANEL_GAP 34
+
+EspLcdTransport::EspLcdTransport()
+    : io_handle(nullptr), panel_handle(nullptr), transfers_done(0), transfers_reported(0)
+{
+}
+
+// SPI DMA transfer-done interrupt: nothing but an inline store, so no code in
+// flash runs here (the flash cache is off while flash is written)
+bool IRAM_ATTR EspLcdTransport::onColorTransDone(esp_lcd_panel_io_handle_t panel_io,
+                                                 esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+  (void)panel_io; // Unused
+  (void)edata;    // Unused
+
+  // Only writer, so no read-modify-write is needed
+  EspLcdTransport *self = static_cast<EspLcdTransport *>(user_ctx);
+  self->transfers_done.store(self->transfers_done.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  return false;
+}
+
+void EspLcdTransport::poll()
+{
+  uint32_t done = transfers_done.load(std::memory_order_acquire);
+  while (transfers_reported != done)
+  {
+    transfers_reported++;
+    notifyTransferDone();
+  }
+}
+
+bool EspLcdTransport::begin()
+{
+  spi_bus_config_t bus_cfg = {};
+  bus_cfg.mosi_io_num = TFT_MOSI;
+  bus_cfg.miso_io_num = -1;
+  bus_cfg.sclk_io_num = TFT_SCLK;
+  bus_cfg.quadwp_io_num = -1;
+  bus_cfg.quadhd_io_num = -1;
+  bus_cfg.max_transfer_sz = LVGL_BUFFER_SIZE * sizeof(uint16_t);
+  if (spi_bus_initialize(LCD_HOST, &bus_cfg, SPI_DMA_CH_AUTO) != ESP_OK)
+  {
+    return false;
+  }
+
+  esp_lcd_panel_io_spi_config_t io_cfg = {};
+  io_cfg.cs_gpio_num = TFT_CS;
+  io_cfg.dc_gpio_num = TFT_DC;
+  io_cfg.spi_mode = 0;
+  io_cfg.pclk_hz = SPI_FREQUENCY;
+  io_cfg.trans_queue_depth = LCD_TRANS_QUEUE_DEPTH;
+  io_cfg.on_color_trans_done = onColorTransDone;
+  io_cfg.user_ctx = this;
+  io_cfg.lcd_cmd_bits = 8;
+  io_cfg.lcd_param_bits = 8;
+  if (esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_HOST, &io_cfg, &io_handle) != ESP_OK)
+  {
+    return false;
+  }
+
+  esp_lcd_panel_dev_config_t panel_cfg = {};
+  panel_cfg.reset_gpio_num = TFT_RST;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+  panel_cfg.rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB;
+#else
+  panel_cfg.color_space = ESP_LCD_COLOR_SPACE_RGB;
+#endif
+  panel_cfg.bits_per_pixel = 16;
+  if (esp_lcd_new_panel_st7789(io_handle, &panel_cfg, &panel_handle) != ESP_OK)
+  {
+    return false;
+  }
+
+  esp_lcd_panel_reset(panel_handle);
+  esp_lcd_panel_init(panel_handle);
+  esp_lcd_panel_invert_color(panel_handle, true);
+
+  // Same MADCTL and RAM offsets Adafruit_ST7789 uses for TFT_ROTATION
+#if DISPLAY_HORIZONTAL
+  esp_lcd_panel_swap_xy(panel_handle, true);
+  esp_lcd_panel_mirror(panel_handle, true, false);
+  esp_lcd_panel_set_gap(panel_handle, 0, LCD_PANEL_GAP);
+#else
+  esp_lcd_panel_swap_xy(panel_handle, false);
+  esp_lcd_panel_mirror(panel_handle, true, true);
+  esp_lcd_panel_set_gap(panel_handle, LCD_PANEL_GAP, 0);
+#endif
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_lcd_panel_disp_on_off(panel_handle, true);
+#else
+  esp_lcd_panel_disp_off(panel_handle, false);
+#endif
+  return true;
+}
+
+bool EspLcdTransport::writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels)
+{
+  // Queued on the SPI DMA engine, returns before the transfer is done
+  return esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2 + 1, y2 + 1, pixels) == ESP_OK;
+}
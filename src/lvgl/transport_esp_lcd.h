@@ -0,0 +1,39 @@
+#ifndef TRANSPORT_ESP_LCD_H
+#define TRANSPORT_ESP_LCD_H
+
+// ESP-IDF
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+
+#include <atomic>
+
+// Project headers
+#include "display_transport.h"
+
+// Asynchronous transport on the ESP-IDF esp_lcd ST7789 driver
+// writePixels() only queues CASET/RASET/RAMWR and the pixel data on the SPI
+// DMA engine. The transfer-done interrupt only counts the finished transfer;
+// poll() reports it, so the flush pipeline and LVGL run in task context.
+class EspLcdTransport : public DisplayTransport
+{
+private:
+  esp_lcd_panel_io_handle_t io_handle;
+  esp_lcd_panel_handle_t panel_handle;
+  std::atomic<uint32_t> transfers_done; // Written by the interrupt only
+  uint32_t transfers_reported;
+
+  static bool onColorTransDone(esp_lcd_panel_io_handle_t panel_io,
+                               esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+
+public:
+  EspLcdTransport();
+
+  bool begin() override;
+  bool writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels) override;
+  bool isAsync() const override { return true; }
+  bool wantsBigEndian() const override { return true; }
+  const char *name() const override { return "esp_lcd_dma"; }
+  void poll() override;
+};
+
+#endif // TRANSPORT_ESP_LCD_H
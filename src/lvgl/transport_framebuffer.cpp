@@ -0,0 +1,293 @@
+// Own header
+#include "transport_framebuffer.h"
+#include <Arduino.h>
+#include "../debug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// PNG writer helpers: stored (uncompressed) deflate blocks keep the encoder
+// tiny and dependency-free; the dumps are for inspection, not for size
+#define PNG_STORED_BLOCK_MAX 65535
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    for (int k = 0; k < 8; k++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+// Writes chunk payload bytes while keeping the chunk CRC up to date
+struct PngChunkWriter
+{
+  FILE *f;
+  uint32_t crc;
+
+  void begin(uint32_t length, const char *type)
+  {
+    uint8_t hdr[8];
+    put_be32(hdr, length);
+    memcpy(hdr + 4, type, 4);
+    fwrite(hdr, 1, 8, f);
+    crc = crc32_update(0, hdr + 4, 4);
+  }
+
+  void write(const uint8_t *data, size_t len)
+  {
+    fwrite(data, 1, len, f);
+    crc = crc32_update(crc, data, len);
+  }
+
+  void end()
+  {
+    uint8_t tail[4];
+    put_be32(tail, crc);
+    fwrite(tail, 1, 4, f);
+  }
+};
+
+static uint32_t now_us()
+{
+  return (uint32_t)micros();
+}
+
+FramebufferTransport::FramebufferTransport(uint16_t width, uint16_t height)
+    : width(width), height(height), framebuffer(nullptr)
+{
+  resetStats();
+}
+
+FramebufferTransport::~FramebufferTransport()
+{
+  free(framebuffer);
+}
+
+bool FramebufferTransport::begin()
+{
+  if (framebuffer == nullptr)
+  {
+    framebuffer = (uint16_t *)calloc((size_t)width * height, sizeof(uint16_t));
+  }
+  last_flush_end_us = now_us();
+  return framebuffer != nullptr;
+}
+
+bool FramebufferTransport::writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels)
+{
+  if (framebuffer == nullptr || x1 < 0 || y1 < 0 || x2 >= width || y2 >= height || x2 < x1 || y2 < y1)
+  {
+    return false;
+  }
+
+  uint32_t start = now_us();
+  uint32_t w = (uint32_t)(x2 - x1 + 1);
+  uint32_t h = (uint32_t)(y2 - y1 + 1);
+
+  for (uint32_t row = 0; row < h; row++)
+  {
+    memcpy(&framebuffer[(size_t)(y1 + row) * width + x1], &pixels[row * w], w * sizeof(uint16_t));
+  }
+
+  uint32_t end = now_us();
+
+  FlushRecord &rec = records[stats.flushes % FRAMEBUFFER_FLUSH_LOG_SIZE];
+  rec.x1 = x1;
+  rec.y1 = y1;
+  rec.x2 = x2;
+  rec.y2 = y2;
+  rec.bytes = w * h * sizeof(uint16_t);
+  rec.render_us = start - last_flush_end_us;
+  rec.copy_us = end - start;
+
+  stats.flushes++;
+  stats.pixels += w * h;
+  stats.bytes += rec.bytes;
+  stats.render_us += rec.render_us;
+  stats.copy_us += rec.copy_us;
+  if (w * h > stats.max_flush_px)
+  {
+    stats.max_flush_px = w * h;
+  }
+
+  last_flush_end_us = end;
+  notifyTransferDone();
+  return true;
+}
+
+size_t FramebufferTransport::getFlushRecordCount() const
+{
+  return stats.flushes < FRAMEBUFFER_FLUSH_LOG_SIZE ? stats.flushes : FRAMEBUFFER_FLUSH_LOG_SIZE;
+}
+
+const FramebufferTransport::FlushRecord &FramebufferTransport::getFlushRecord(size_t index) const
+{
+  size_t first = stats.flushes < FRAMEBUFFER_FLUSH_LOG_SIZE ? 0 : stats.flushes % FRAMEBUFFER_FLUSH_LOG_SIZE;
+  return records[(first + index) % FRAMEBUFFER_FLUSH_LOG_SIZE];
+}
+
+void FramebufferTransport::resetStats()
+{
+  memset(&stats, 0, sizeof(stats));
+  memset(records, 0, sizeof(records));
+  last_flush_end_us = now_us();
+}
+
+void FramebufferTransport::printStats() const
+{
+  LOG_INFOF("Framebuffer: %lu flushes, %llu px, %llu bytes, render %llu us, copy %llu us, max area %lu px\n",
+            (unsigned long)stats.flushes, (unsigned long long)stats.pixels,
+            (unsigned long long)stats.bytes, (unsigned long long)stats.render_us,
+            (unsigned long long)stats.copy_us, (unsigned long)stats.max_flush_px);
+
+#if DEBUG_ENABLED
+  for (size_t i = 0; i < getFlushRecordCount(); i++)
+  {
+    const FlushRecord &rec = getFlushRecord(i);
+    DEBUG_LOGF("  flush (%ld,%ld)-(%ld,%ld) %lu bytes, render %lu us, copy %lu us\n",
+               (long)rec.x1, (long)rec.y1, (long)rec.x2, (long)rec.y2,
+               (unsigned long)rec.bytes, (unsigned long)rec.render_us, (unsigned long)rec.copy_us);
+  }
+#endif
+}
+
+// Expand one RGB565 pixel to 8 bits per channel
+void FramebufferTransport::toRGB888(uint32_t index, uint8_t *rgb) const
+{
+  uint16_t c = framebuffer[index];
+  uint8_t r = (c >> 11) & 0x1F;
+  uint8_t g = (c >> 5) & 0x3F;
+  uint8_t b = c & 0x1F;
+  rgb[0] = (uint8_t)((r << 3) | (r >> 2));
+  rgb[1] = (uint8_t)((g << 2) | (g >> 4));
+  rgb[2] = (uint8_t)((b << 3) | (b >> 2));
+}
+
+bool FramebufferTransport::dumpPPM(const char *path) const
+{
+  if (framebuffer == nullptr)
+  {
+    return false;
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr)
+  {
+    return false;
+  }
+
+  fprintf(f, "P6\n%u %u\n255\n", width, height);
+  uint8_t rgb[3];
+  for (uint32_t i = 0; i < (uint32_t)width * height; i++)
+  {
+    toRGB888(i, rgb);
+    fwrite(rgb, 1, 3, f);
+  }
+
+  bool ok = ferror(f) == 0;
+  fclose(f);
+  return ok;
+}
+
+bool FramebufferTransport::dumpPNG(const char *path) const
+{
+  if (framebuffer == nullptr)
+  {
+    return false;
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr)
+  {
+    return false;
+  }
+
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  fwrite(signature, 1, sizeof(signature), f);
+
+  PngChunkWriter chunk = {f, 0};
+
+  // IHDR: 8-bit truecolor, no interlace
+  uint8_t ihdr[13];
+  put_be32(ihdr, width);
+  put_be32(ihdr + 4, height);
+  ihdr[8] = 8;
+  ihdr[9] = 2;
+  ihdr[10] = 0;
+  ihdr[11] = 0;
+  ihdr[12] = 0;
+  chunk.begin(sizeof(ihdr), "IHDR");
+  chunk.write(ihdr, sizeof(ihdr));
+  chunk.end();
+
+  // IDAT: zlib stream made of stored blocks, each scanline prefixed by filter 0
+  uint32_t row_bytes = 1 + (uint32_t)width * 3;
+  uint32_t raw_len = row_bytes * height;
+  uint32_t blocks = (raw_len + PNG_STORED_BLOCK_MAX - 1) / PNG_STORED_BLOCK_MAX;
+  chunk.begin(2 + raw_len + blocks * 5 + 4, "IDAT");
+
+  static const uint8_t zlib_hdr[2] = {0x78, 0x01};
+  chunk.write(zlib_hdr, sizeof(zlib_hdr));
+
+  uint32_t adler_a = 1, adler_b = 0;
+  uint32_t block_left = 0;
+  uint32_t remaining = raw_len;
+
+  for (uint32_t pos = 0; pos < raw_len; pos++)
+  {
+    if (block_left == 0)
+    {
+      block_left = remaining < PNG_STORED_BLOCK_MAX ? remaining : PNG_STORED_BLOCK_MAX;
+      uint8_t hdr[5];
+      hdr[0] = (block_left == remaining) ? 1 : 0; // BFINAL on the last block
+      hdr[1] = (uint8_t)block_left;
+      hdr[2] = (uint8_t)(block_left >> 8);
+      hdr[3] = (uint8_t)~block_left;
+      hdr[4] = (uint8_t)(~block_left >> 8);
+      chunk.write(hdr, sizeof(hdr));
+    }
+
+    uint32_t y = pos / row_bytes;
+    uint32_t col = pos % row_bytes;
+    uint8_t byte = 0; // Filter type "None"
+    if (col != 0)
+    {
+      uint8_t rgb[3];
+      toRGB888(y * width + (col - 1) / 3, rgb);
+      byte = rgb[(col - 1) % 3];
+    }
+
+    chunk.write(&byte, 1);
+    adler_a = (adler_a + byte) % 65521;
+    adler_b = (adler_b + adler_a) % 65521;
+    block_left--;
+    remaining--;
+  }
+
+  uint8_t adler[4];
+  put_be32(adler, (adler_b << 16) | adler_a);
+  chunk.write(adler, sizeof(adler));
+  chunk.end();
+
+  chunk.begin(0, "IEND");
+  chunk.end();
+
+  bool ok = ferror(f) == 0;
+  fclose(f);
+  return ok;
+}
@@ -0,0 +1,73 @@
+#ifndef TRANSPORT_FRAMEBUFFER_H
+#define TRANSPORT_FRAMEBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Project headers
+#include "display_transport.h"
+
+// Number of per-flush records kept for profiling (oldest are overwritten)
+#define FRAMEBUFFER_FLUSH_LOG_SIZE 128
+
+// In-memory RGB565 framebuffer transport
+// Copies every flushed area into a full-screen framebuffer instead of a panel
+// and records what each flush cost, so rendering can be profiled without the
+// board. The framebuffer can be written out as PPM or PNG.
+class FramebufferTransport : public DisplayTransport
+{
+public:
+  struct FlushRecord
+  {
+    int32_t x1, y1, x2, y2;
+    uint32_t bytes;     // RGB565 bytes transferred
+    uint32_t render_us; // Time since the previous flush returned (LVGL rendering)
+    uint32_t copy_us;   // Time spent copying into the framebuffer
+  };
+
+  struct Stats
+  {
+    uint32_t flushes;      // Areas flushed (one flush per area)
+    uint64_t pixels;       // Pixels flushed
+    uint64_t bytes;        // Bytes flushed
+    uint64_t render_us;    // Sum of FlushRecord::render_us
+    uint64_t copy_us;      // Sum of FlushRecord::copy_us
+    uint32_t max_flush_px; // Largest single area
+  };
+
+  FramebufferTransport(uint16_t width, uint16_t height);
+  ~FramebufferTransport();
+
+  bool begin() override;
+  bool writePixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *pixels) override;
+  bool isAsync() const override { return false; }
+  const char *name() const override { return "framebuffer"; }
+
+  const uint16_t *getFramebuffer() const { return framebuffer; }
+  uint16_t getWidth() const { return width; }
+  uint16_t getHeight() const { return height; }
+
+  // Profiling data since the last resetStats()
+  const Stats &getStats() const { return stats; }
+  size_t getFlushRecordCount() const;
+  const FlushRecord &getFlushRecord(size_t index) const; // 0 = oldest kept
+  void resetStats();
+  void printStats() const;
+
+  // Dump the framebuffer as binary PPM (P6) or uncompressed PNG
+  bool dumpPPM(const char *path) const;
+  bool dumpPNG(const char *path) const;
+
+private:
+  uint16_t width;
+  uint16_t height;
+  uint16_t *framebuffer;
+
+  Stats stats;
+  FlushRecord records[FRAMEBUFFER_FLUSH_LOG_SIZE];
+  uint32_t last_flush_end_us;
+
+  void toRGB888(uint32_t index, uint8_t *rgb) const;
+};
+
+#endif // TRANSPORT_FRAMEBUFFER_H
@@ -5,15 +5,49 @@
 // Project headers
 #include "config.h"
 #include "debug.h"
+#include "idle_scheduler.h"
+#include "trace.h"
 #include "lvgl/lvgl_setup.h"
 #include "ui/ui_weather.h"
 #include "weather/weather_api.h"
+#include "weather/weather_task.h"
 #include "wifi/wifi_setup.h"
 
 // Global objects
 WiFiSetup *wifi_setup;
 WeatherAPI *weather_api;
 WeatherUI *weather_ui;
+WeatherFetchTask *weather_task;
+IdleScheduler idle_scheduler;
+
+// Trace dumps are requested over serial, which does not wake the loop
+#define TRACE_POLL_INTERVAL_MS 100
+
+// A dropped connection has to be noticed without polling
+static void onWiFiDisconnected(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+  (void)event; // Unused
+  (void)info;  // Unused
+  idle_scheduler.wake();
+}
+
+// No weather yet (WiFi was down at boot): fetch now rather than at the next check
+static void onWiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+  (void)event; // Unused
+  (void)info;  // Unused
+  if (weather_task && weather_task->getFetches() == 0)
+  {
+    weather_task->requestFetch();
+  }
+}
+
+// Runs on the weather task: the loop takes the new data on its next wakeup
+static void onWeatherFetched(void *arg)
+{
+  (void)arg; // Unused
+  idle_scheduler.wake();
+}
 
 void setup()
 {
@@ -31,19 +65,40 @@ void setup()
   DEBUG_LOG("Initializing WiFi...");
   wifi_setup = new WiFiSetup();
   wifi_setup->init();
+  WiFi.onEvent(onWiFiDisconnected, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+
+  WiFi.onEvent(onWiFiGotIP, ARDUINO_EVENT_WIFI_STA_GOT_IP);
 
   // Connect to WiFi and setup weather
-  if (wifi_setup->connect())
+  bool connected = wifi_setup->connect();
+  if (connected)
   {
     LOG_INFO("WiFi connected!");
-    DEBUG_LOG("Initializing weather API...");
-    weather_api = new WeatherAPI();
-    weather_api->init();
-
-    DEBUG_LOG("Creating weather UI...");
-    weather_ui = new WeatherUI(weather_api);
-    weather_ui->createWeatherScreen();
+  }
+  else
+  {
+    // Show a basic screen; weather follows once WiFi comes up
+    LOG_ERROR("WiFi connection failed!");
+  }
 
+  DEBUG_LOG("Initializing weather API...");
+  weather_api = new WeatherAPI();
+  weather_api->init();
+
+  DEBUG_LOG("Creating weather UI...");
+  weather_ui = new WeatherUI(weather_api);
+  weather_ui->createWeatherScreen();
+
+#if WEATHER_TASK_ENABLED
+  // The first fetch starts right away; the screen shows without waiting for
+  // it. Offline, the task retries at every check and when WiFi connects.
+  DEBUG_LOG("Starting weather task...");
+  weather_task = new WeatherFetchTask(*weather_api);
+  weather_task->onFetched(onWeatherFetched, nullptr);
+  weather_task->start();
+#else
+  if (connected)
+  {
     DEBUG_LOG("Fetching initial weather data...");
     if (weather_api->fetchWeatherData())
     {
@@ -54,17 +109,21 @@ void setup()
     {
       LOG_ERROR("Weather fetch failed!");
     }
-
-    weather_ui->showWeatherScreen();
   }
-  else
+#endif
+
+  weather_ui->showWeatherScreen();
+
+#if DISPLAY_BENCHMARK_FRAMES > 0
+  lvgl_benchmark_buffer_strategies(DISPLAY_BENCHMARK_FRAMES);
+  weather_ui->getStaticLayerCache().measureSaving(DISPLAY_BENCHMARK_FRAMES);
+  weather_ui->benchmarkIcons(DISPLAY_BENCHMARK_FRAMES);
+  weather_ui->benchmarkLabels(DISPLAY_BENCHMARK_FRAMES);
+#endif
+
+  if (idle_scheduler.begin())
   {
-    LOG_ERROR("WiFi connection failed!");
-    // Show a basic screen even without WiFi
-    weather_api = new WeatherAPI();
-    weather_ui = new WeatherUI(weather_api);
-    weather_ui->createWeatherScreen();
-    weather_ui->showWeatherScreen();
+    lvgl_backlight_light_sleep();
   }
 
   LOG_INFO("=== Setup Complete ===\n");
@@ -72,16 +131,25 @@ void setup()
 
 void loop()
 {
-  // Periodic weather update check (every 5 minutes)
+#if WEATHER_TASK_ENABLED
+  // Fetched on the weather task; only this task touches LVGL
+  if (weather_task && weather_api->hasNewWeather())
+  {
+    DEBUG_LOG("Weather updated successfully");
+    weather_ui->updateWeatherDisplay();
+  }
+#else
+  // Periodic weather update check
   static unsigned long last_update_check = 0;
   unsigned long now = millis();
 
-  if (now - last_update_check >= 300000)
-  { // 5 minutes = 300000ms
+  if (now - last_update_check >= WEATHER_CHECK_INTERVAL_MS)
+  {
     last_update_check = now;
 
     if (weather_api && weather_api->needsUpdate())
     {
+      TRACE_SCOPE("weather_update");
       DEBUG_LOG("Fetching weather update...");
       if (weather_api->fetchWeatherData())
       {
@@ -97,13 +165,32 @@ void loop()
       }
     }
   }
+#endif
+
+  TRACE_BEGIN("lv_timer_handler");
+  uint32_t next_ms = lv_timer_handler(); // LV_NO_TIMER_READY == IDLE_NO_DEADLINE
+  TRACE_END("lv_timer_handler");
 
-  lv_timer_handler();
+#if TRACE_ENABLED
+  // Send 't' over serial to dump the trace ring as Chrome trace JSON
+  if (Serial.available() && Serial.read() == 't')
+  {
+    trace_dump_serial();
+  }
+#endif
 
   if (wifi_setup)
   {
     wifi_setup->handleReconnect();
+    next_ms = min(next_ms, wifi_setup->msUntilRetry());
   }
 
-  delay(5);
+  // Sleep until the earliest deadline
+#if !WEATHER_TASK_ENABLED
+  next_ms = min(next_ms, idle_ms_until(last_update_check, WEATHER_CHECK_INTERVAL_MS));
+#endif
+#if TRACE_ENABLED
+  next_ms = min(next_ms, (uint32_t)TRACE_POLL_INTERVAL_MS);
+#endif
+  idle_scheduler.idle(next_ms);
 }
@@ -0,0 +1,275 @@
+// Own header
+#include "trace.h"
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#if TRACE_ENABLED
+
+#include <atomic>
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#endif
+
+struct TraceEvent
+{
+  const char *name;
+  uint32_t ts_us; // Wraps after ~71 minutes; dumps use differences
+  uint32_t seq;   // Index + 1 once the slot is complete, 0 while written
+  char phase;     // 'B' or 'E'
+  uint8_t tid;    // Core
+  uint8_t depth;  // Spans open on the core before this event (at most 255)
+};
+
+static TraceEvent ring[TRACE_RING_SIZE];
+static std::atomic<uint32_t> ring_head(0);
+static volatile bool paused = false;
+
+// Spans open per core, counted while paused too, so the events kept after an
+// overwrite or a reset tell how many of their ends lost the begin
+static std::atomic<uint32_t> open_spans[2];
+
+static uint32_t trace_now_us()
+{
+#ifdef ESP_PLATFORM
+  return (uint32_t)esp_timer_get_time();
+#else
+  return (uint32_t)micros();
+#endif
+}
+
+static uint8_t trace_tid()
+{
+#ifdef ESP_PLATFORM
+  return (uint8_t)xPortGetCoreID();
+#else
+  return 0;
+#endif
+}
+
+// Writers only contend on the head index; a slot is claimed with one atomic add
+static void trace_record(const char *name, char phase)
+{
+  uint8_t tid = trace_tid();
+  uint32_t depth = phase == 'B' ? open_spans[tid & 1].fetch_add(1, std::memory_order_relaxed)
+                                : open_spans[tid & 1].fetch_sub(1, std::memory_order_relaxed);
+  if (paused)
+  {
+    return;
+  }
+
+  uint32_t index = ring_head.fetch_add(1, std::memory_order_relaxed);
+  TraceEvent &e = ring[index % TRACE_RING_SIZE];
+  e.seq = 0;
+  e.name = name;
+  e.ts_us = trace_now_us();
+  e.phase = phase;
+  e.tid = tid;
+  e.depth = depth < 255 ? (uint8_t)depth : 255;
+  std::atomic_thread_fence(std::memory_order_release);
+  e.seq = index + 1;
+}
+
+void trace_begin(const char *name)
+{
+  trace_record(name, 'B');
+}
+
+void trace_end(const char *name)
+{
+  trace_record(name, 'E');
+}
+
+uint32_t trace_recorded()
+{
+  return ring_head.load(std::memory_order_relaxed);
+}
+
+void trace_reset()
+{
+  paused = true;
+  memset(ring, 0, sizeof(ring));
+  ring_head.store(0, std::memory_order_relaxed);
+  paused = false;
+}
+
+// Range of indices still in the ring, oldest first
+static void trace_window(uint32_t *first, uint32_t *head)
+{
+  *head = ring_head.load(std::memory_order_acquire);
+  *first = *head > TRACE_RING_SIZE ? *head - TRACE_RING_SIZE : 0;
+}
+
+// Event at `index`, or nullptr if it was overwritten or is still being written
+static const TraceEvent *trace_event_at(uint32_t index)
+{
+  const TraceEvent *e = &ring[index % TRACE_RING_SIZE];
+  return e->seq == index + 1 ? e : nullptr;
+}
+
+uint32_t trace_dump_chrome(TraceWriter writer, void *ctx)
+{
+  // Stop recording so the window does not move while it is written
+  paused = true;
+
+  char line[160];
+  uint32_t count = 0;
+  uint32_t base_us = 0;
+  int open[2] = {-1, -1}; // Depth before each core's first kept event
+  uint32_t first, head;
+  trace_window(&first, &head);
+
+  writer("{\"traceEvents\":[\n", ctx);
+  for (uint32_t i = first; i < head; i++)
+  {
+    const TraceEvent *e = trace_event_at(i);
+    if (e == nullptr)
+    {
+      continue;
+    }
+
+    if (count == 0)
+    {
+      base_us = e->ts_us;
+    }
+    if (open[e->tid & 1] < 0)
+    {
+      open[e->tid & 1] = e->depth;
+    }
+    snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%u}",
+             count == 0 ? "" : ",\n", e->name, e->phase,
+             (unsigned long)(e->ts_us - base_us), (unsigned)e->tid);
+    writer(line, ctx);
+    count++;
+  }
+  // Spans already open at the first kept event end without their begin
+  snprintf(line, sizeof(line),
+           "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"wrapped\":%s,\"open_spans\":[%d,%d]}}\n",
+           first > 0 ? "true" : "false", open[0] > 0 ? open[0] : 0, open[1] > 0 ? open[1] : 0);
+  writer(line, ctx);
+
+  paused = false;
+  return count;
+}
+
+#define TRACE_MAX_DEPTH 32
+
+uint32_t trace_check_nesting(uint32_t *spans)
+{
+  // Open spans per core
+  const char *stack[2][TRACE_MAX_DEPTH];
+  int depth[2] = {0, 0};
+  int unmatched[2] = {-1, -1}; // Ends that may lack their begin, from each core's first kept event
+  uint32_t errors = 0;
+  uint32_t closed = 0;
+  uint32_t first, head;
+
+  paused = true;
+  trace_window(&first, &head);
+
+  for (uint32_t i = first; i < head; i++)
+  {
+    const TraceEvent *e = trace_event_at(i);
+    if (e == nullptr)
+    {
+      continue;
+    }
+
+    int t = e->tid & 1;
+    if (unmatched[t] < 0)
+    {
+      unmatched[t] = e->depth;
+    }
+    if (e->phase == 'B')
+    {
+      if (depth[t] < TRACE_MAX_DEPTH)
+      {
+        stack[t][depth[t]] = e->name;
+      }
+      depth[t]++;
+    }
+    else if (depth[t] == 0)
+    {
+      // Only the spans open before the kept events may end without a begin
+      if (unmatched[t] > 0)
+      {
+        unmatched[t]--;
+      }
+      else
+      {
+        errors++;
+      }
+    }
+    else
+    {
+      depth[t]--;
+      if (depth[t] < TRACE_MAX_DEPTH && strcmp(stack[t][depth[t]], e->name) != 0)
+      {
+        errors++;
+      }
+      closed++;
+    }
+  }
+  paused = false;
+
+  if (spans != nullptr)
+  {
+    *spans = closed;
+  }
+  return errors;
+}
+
+#else
+
+void trace_begin(const char *name)
+{
+  (void)name; // Unused
+}
+
+void trace_end(const char *name)
+{
+  (void)name; // Unused
+}
+
+uint32_t trace_dump_chrome(TraceWriter writer, void *ctx)
+{
+  writer("{\"traceEvents\":[]}\n", ctx);
+  return 0;
+}
+
+uint32_t trace_check_nesting(uint32_t *spans)
+{
+  if (spans != nullptr)
+  {
+    *spans = 0;
+  }
+  return 0;
+}
+
+uint32_t trace_recorded()
+{
+  return 0;
+}
+
+void trace_reset()
+{
+}
+
+#endif // TRACE_ENABLED
+
+static void serial_writer(const char *text, void *ctx)
+{
+  (void)ctx; // Unused
+  Serial.print(text);
+}
+
+void trace_dump_serial()
+{
+  Serial.println("=== TRACE BEGIN ===");
+  uint32_t count = trace_dump_chrome(serial_writer, nullptr);
+  Serial.println("=== TRACE END ===");
+  Serial.printf("Trace: %lu events dumped, %lu recorded\n", (unsigned long)count,
+                (unsigned long)trace_recorded());
+}
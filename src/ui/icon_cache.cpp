@@ -0,0 +1,202 @@
+// Own header
+#include "icon_cache.h"
+#include <Arduino.h>
+#include "../debug.h"
+#include "../lvgl/lvgl_png_stream.h"
+#include "../lvgl/lvgl_setup.h"
+
+#include <string.h>
+
+IconCache::IconCache(uint32_t budget) : budget(budget)
+{
+  memset(entries, 0, sizeof(entries));
+  use_clock = 0;
+  last_returned = nullptr;
+  memset(&stats, 0, sizeof(stats));
+}
+
+IconCache::~IconCache()
+{
+  clear();
+}
+
+void IconCache::resetStats()
+{
+  uint32_t bytes = stats.bytes;
+  uint32_t count = stats.entries;
+  memset(&stats, 0, sizeof(stats));
+  stats.bytes = bytes;
+  stats.entries = count;
+  stats.peak_bytes = bytes;
+}
+
+void IconCache::setBudget(uint32_t bytes)
+{
+  budget = bytes;
+  if (budget == 0)
+  {
+    clear();
+    return;
+  }
+
+  // The shown image stays until the next get()
+  makeRoom(0);
+}
+
+void IconCache::clear()
+{
+  for (uint32_t i = 0; i < ICON_CACHE_MAX_ENTRIES; i++)
+  {
+    if (entries[i].buffer != nullptr)
+    {
+      lvgl_buffer_free(entries[i].buffer);
+      memset(&entries[i], 0, sizeof(Entry));
+    }
+  }
+  stats.bytes = 0;
+  stats.entries = 0;
+  last_returned = nullptr;
+}
+
+IconCache::Entry *IconCache::find(const char *path)
+{
+  for (uint32_t i = 0; i < ICON_CACHE_MAX_ENTRIES; i++)
+  {
+    if (entries[i].buffer != nullptr && strcmp(entries[i].path, path) == 0)
+    {
+      return &entries[i];
+    }
+  }
+  return nullptr;
+}
+
+void IconCache::evict(Entry *entry)
+{
+  stats.bytes -= entry->image.data_size;
+  stats.entries--;
+  stats.evictions++;
+  lvgl_buffer_free(entry->buffer);
+  memset(entry, 0, sizeof(Entry));
+}
+
+// Evict least recently used entries until `bytes` more fit in the budget and
+// a slot is free; false if only the protected entry is left
+bool IconCache::makeRoom(uint32_t bytes)
+{
+  while (stats.bytes + bytes > budget || (bytes > 0 && stats.entries >= ICON_CACHE_MAX_ENTRIES))
+  {
+    Entry *oldest = nullptr;
+    for (uint32_t i = 0; i < ICON_CACHE_MAX_ENTRIES; i++)
+    {
+      Entry *e = &entries[i];
+      if (e->buffer != nullptr && e != last_returned && (oldest == nullptr || e->last_use < oldest->last_use))
+      {
+        oldest = e;
+      }
+    }
+
+    if (oldest == nullptr)
+    {
+      return false;
+    }
+    evict(oldest);
+  }
+  return true;
+}
+
+IconCache::Entry *IconCache::decode(const char *path)
+{
+  if (strlen(path) >= ICON_CACHE_PATH_LEN)
+  {
+    return nullptr;
+  }
+
+  lv_image_decoder_dsc_t dsc;
+  if (lv_image_decoder_open(&dsc, path, NULL) != LV_RESULT_OK)
+  {
+    LOG_ERRORF("IconCache: cannot decode %s\n", path);
+    return nullptr;
+  }
+
+  // Streamed images (lvgl_png_stream) are decoded straight into the entry
+  Entry *entry = nullptr;
+  const lv_draw_buf_t *decoded = dsc.decoded;
+  const lv_image_header_t &header = decoded != nullptr ? decoded->header : dsc.header;
+  uint32_t bytes = decoded != nullptr ? decoded->data_size : header.stride * header.h;
+
+  if (bytes > 0 && bytes <= budget && makeRoom(bytes))
+  {
+    for (uint32_t i = 0; i < ICON_CACHE_MAX_ENTRIES && entry == nullptr; i++)
+    {
+      if (entries[i].buffer == nullptr)
+      {
+        entry = &entries[i];
+      }
+    }
+
+    void *buffer = lvgl_buffer_alloc(bytes, true);
+    bool filled = buffer != nullptr;
+    if (filled && decoded != nullptr)
+    {
+      memcpy(buffer, decoded->data, bytes);
+    }
+    else if (filled)
+    {
+      filled = header.cf == LV_COLOR_FORMAT_ARGB8888 &&
+               lvgl_png_stream_read(&dsc, static_cast<uint8_t *>(buffer), header.stride);
+    }
+
+    if (!filled)
+    {
+      lvgl_buffer_free(buffer);
+      entry = nullptr;
+    }
+    else
+    {
+      strcpy(entry->path, path);
+      entry->buffer = buffer;
+      entry->image.header = header;
+      entry->image.header.flags &= LV_IMAGE_FLAGS_PREMULTIPLIED;
+      entry->image.data = static_cast<const uint8_t *>(buffer);
+      entry->image.data_size = bytes;
+
+      stats.bytes += bytes;
+      stats.entries++;
+      if (stats.bytes > stats.peak_bytes)
+      {
+        stats.peak_bytes = stats.bytes;
+      }
+    }
+  }
+
+  lv_image_decoder_close(&dsc);
+  return entry;
+}
+
+const lv_image_dsc_t *IconCache::get(const char *path)
+{
+  if (budget == 0)
+  {
+    return nullptr;
+  }
+
+  Entry *entry = find(path);
+  if (entry != nullptr)
+  {
+    stats.hits++;
+  }
+  else
+  {
+    stats.misses++;
+    entry = decode(path);
+    if (entry == nullptr)
+    {
+      stats.failures++;
+      return nullptr;
+    }
+  }
+
+  entry->last_use = ++use_clock;
+  last_returned = entry;
+  return &entry->image;
+}
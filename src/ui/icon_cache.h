@@ -0,0 +1,71 @@
+#ifndef ICON_CACHE_H
+#define ICON_CACHE_H
+
+#include <stdint.h>
+
+// Third-party libraries
+#include <lvgl.h>
+
+// Maximum number of cached images and source path length
+#define ICON_CACHE_MAX_ENTRIES 32
+#define ICON_CACHE_PATH_LEN 48
+
+// Decoded icon cache
+// Keeps decoded file images (PNG, .bin) in PSRAM, keyed by path, within a
+// byte budget; the least recently used entry is evicted first. get() returns
+// a RAM image descriptor LVGL draws without decoding. The most recently
+// returned entry is never evicted, as it is the one an image widget shows.
+class IconCache
+{
+public:
+  struct Stats
+  {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t failures;   // Decode failed or image larger than the budget
+    uint32_t bytes;      // Decoded bytes held
+    uint32_t entries;
+    uint32_t peak_bytes; // Highest `bytes` since resetStats()
+  };
+
+  explicit IconCache(uint32_t budget = 0);
+  ~IconCache();
+
+  // 0 disables the cache (see clear()); shrinking evicts down to the new
+  // budget, except the most recently returned entry
+  void setBudget(uint32_t bytes);
+  uint32_t getBudget() const { return budget; }
+
+  // Decoded image of `path` ("S:/icons/..."), decoded on a miss.
+  // nullptr if it cannot be cached; use the path itself then.
+  const lv_image_dsc_t *get(const char *path);
+
+  // Free all entries; image widgets must not show any of them anymore
+  void clear();
+
+  const Stats &getStats() const { return stats; }
+  void resetStats();
+
+private:
+  struct Entry
+  {
+    char path[ICON_CACHE_PATH_LEN];
+    lv_image_dsc_t image;
+    void *buffer;
+    uint32_t last_use;
+  };
+
+  Entry *find(const char *path);
+  Entry *decode(const char *path);
+  void evict(Entry *entry);
+  bool makeRoom(uint32_t bytes);
+
+  Entry entries[ICON_CACHE_MAX_ENTRIES];
+  uint32_t budget;
+  uint32_t use_clock;
+  Entry *last_returned;
+  Stats stats;
+};
+
+#endif // ICON_CACHE_H
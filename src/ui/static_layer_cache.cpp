@@ -0,0 +1,331 @@
+// Own header
+#include "static_layer_cache.h"
+#include <Arduino.h>
+#include "../debug.h"
+#include "../lvgl/lvgl_setup.h"
+
+#include <string.h>
+
+StaticLayerCache::StaticLayerCache()
+{
+  root = nullptr;
+  layer_count = 0;
+  hidden_count = 0;
+  buffer = nullptr;
+  memset(&draw_buf, 0, sizeof(draw_buf));
+  memset(&image, 0, sizeof(image));
+  enabled = true;
+  active = false;
+  applying = false;
+  dirty = true;
+  build_count = 0;
+  last_build_us = 0;
+}
+
+StaticLayerCache::~StaticLayerCache()
+{
+  if (active && root != nullptr)
+  {
+    release();
+  }
+  lvgl_buffer_free(buffer);
+}
+
+void StaticLayerCache::setRoot(lv_obj_t *root)
+{
+  this->root = root;
+  lv_obj_add_event_cb(root, onLayerEvent, LV_EVENT_STYLE_CHANGED, this);
+  lv_obj_add_event_cb(root, onLayerEvent, LV_EVENT_SIZE_CHANGED, this);
+  dirty = true;
+}
+
+void StaticLayerCache::addLayer(lv_obj_t *obj)
+{
+  if (layer_count >= STATIC_LAYER_MAX_LAYERS)
+  {
+    LOG_ERROR("StaticLayerCache: too many layers");
+    return;
+  }
+
+  memset(&layers[layer_count], 0, sizeof(Layer));
+  layers[layer_count].obj = obj;
+  layer_count++;
+
+  lv_obj_add_event_cb(obj, onLayerEvent, LV_EVENT_STYLE_CHANGED, this);
+  lv_obj_add_event_cb(obj, onLayerEvent, LV_EVENT_SIZE_CHANGED, this);
+  dirty = true;
+}
+
+void StaticLayerCache::setEnabled(bool enabled)
+{
+  this->enabled = enabled;
+
+  // Rebuilt from the layers' own drawing, not from the flattened cards
+  invalidate();
+}
+
+// Layout or theme changed: the bitmap no longer matches what the layers would draw
+void StaticLayerCache::onLayerEvent(lv_event_t *e)
+{
+  StaticLayerCache *self = static_cast<StaticLayerCache *>(lv_event_get_user_data(e));
+  if (!self->applying)
+  {
+    self->invalidate();
+  }
+}
+
+void StaticLayerCache::invalidate()
+{
+  if (active)
+  {
+    release();
+  }
+  dirty = true;
+}
+
+void StaticLayerCache::prepare()
+{
+  if (!enabled || root == nullptr)
+  {
+    return;
+  }
+
+  lv_obj_update_layout(root);
+  if (active && (dirty || layersMoved()))
+  {
+    release();
+    dirty = true;
+  }
+
+  if (dirty && build())
+  {
+    apply();
+    dirty = false;
+  }
+}
+
+bool StaticLayerCache::isLayer(const lv_obj_t *obj) const
+{
+  for (uint32_t i = 0; i < layer_count; i++)
+  {
+    if (layers[i].obj == obj)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool StaticLayerCache::layersMoved() const
+{
+  for (uint32_t i = 0; i < layer_count; i++)
+  {
+    lv_area_t now;
+    lv_obj_get_coords(layers[i].obj, &now);
+    if (memcmp(&now, &layers[i].coords, sizeof(now)) != 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Hide every visible non-layer object below `parent`; false if one did not
+// fit into `hidden` and is still visible
+bool StaticLayerCache::hideDynamic(lv_obj_t *parent)
+{
+  uint32_t count = lv_obj_get_child_count(parent);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    lv_obj_t *child = lv_obj_get_child(parent, i);
+    if (isLayer(child))
+    {
+      if (!hideDynamic(child))
+      {
+        return false;
+      }
+    }
+    else if (!lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
+    {
+      if (hidden_count >= STATIC_LAYER_MAX_HIDDEN)
+      {
+        return false;
+      }
+      lv_obj_add_flag(child, LV_OBJ_FLAG_HIDDEN);
+      hidden[hidden_count++] = child;
+    }
+  }
+  return true;
+}
+
+void StaticLayerCache::invalidateDynamic(lv_obj_t *parent)
+{
+  uint32_t count = lv_obj_get_child_count(parent);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    lv_obj_t *child = lv_obj_get_child(parent, i);
+    if (isLayer(child))
+    {
+      invalidateDynamic(child);
+    }
+    else
+    {
+      lv_obj_invalidate(child);
+    }
+  }
+}
+
+// Render root and layers (without any dynamic object) into the bitmap
+bool StaticLayerCache::build()
+{
+  int32_t w = lv_obj_get_width(root);
+  int32_t h = lv_obj_get_height(root);
+  uint32_t stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_RGB565);
+  uint32_t bytes = stride * h;
+
+  if (buffer == nullptr || image.data_size != bytes)
+  {
+    lvgl_buffer_free(buffer);
+    buffer = lvgl_buffer_alloc(bytes, true);
+    if (buffer == nullptr)
+    {
+      LOG_ERRORF("StaticLayerCache: no PSRAM for %lu B bitmap\n", (unsigned long)bytes);
+      return false;
+    }
+  }
+  lv_draw_buf_init(&draw_buf, w, h, LV_COLOR_FORMAT_RGB565, stride, buffer, bytes);
+
+  unsigned long start = micros();
+
+  // A dynamic object left visible would be baked into the bitmap
+  hidden_count = 0;
+  bool all_hidden = hideDynamic(root);
+  lv_result_t res = all_hidden ? lv_snapshot_take_to_draw_buf(root, LV_COLOR_FORMAT_RGB565, &draw_buf)
+                               : LV_RESULT_INVALID;
+  for (uint32_t i = 0; i < hidden_count; i++)
+  {
+    lv_obj_remove_flag(hidden[i], LV_OBJ_FLAG_HIDDEN);
+  }
+
+  last_build_us = micros() - start;
+  if (!all_hidden)
+  {
+    LOG_ERRORF("StaticLayerCache: more than %d dynamic objects, layers drawn live\n", STATIC_LAYER_MAX_HIDDEN);
+    return false;
+  }
+  if (res != LV_RESULT_OK)
+  {
+    LOG_ERROR("StaticLayerCache: snapshot failed");
+    return false;
+  }
+
+  image.header = draw_buf.header;
+  image.data = draw_buf.data;
+  image.data_size = bytes;
+
+  for (uint32_t i = 0; i < layer_count; i++)
+  {
+    lv_obj_get_coords(layers[i].obj, &layers[i].coords);
+  }
+
+  build_count++;
+  LOG_INFOF("StaticLayerCache: built %ldx%ld bitmap (%lu B) in %lu us\n",
+            (long)w, (long)h, (unsigned long)bytes, (unsigned long)last_build_us);
+  return true;
+}
+
+// Show the bitmap and stop the layers from drawing background and shadow
+void StaticLayerCache::apply()
+{
+  applying = true;
+
+  for (uint32_t i = 0; i < layer_count; i++)
+  {
+    Layer &layer = layers[i];
+    // Once flattened, the styles are not the layers' own; keep the first ones
+    if (!active)
+    {
+      layer.had_bg_opa = lv_obj_get_local_style_prop(layer.obj, LV_STYLE_BG_OPA, &layer.bg_opa,
+                                                     LV_PART_MAIN) == LV_STYLE_RES_FOUND;
+      layer.had_shadow_width = lv_obj_get_local_style_prop(layer.obj, LV_STYLE_SHADOW_WIDTH, &layer.shadow_width,
+                                                           LV_PART_MAIN) == LV_STYLE_RES_FOUND;
+    }
+    lv_obj_set_style_bg_opa(layer.obj, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_shadow_width(layer.obj, 0, LV_PART_MAIN);
+  }
+  lv_obj_set_style_bg_image_src(root, &image, LV_PART_MAIN);
+
+  active = true;
+  applying = false;
+}
+
+// Restore the layers' own drawing
+void StaticLayerCache::release()
+{
+  applying = true;
+
+  for (uint32_t i = 0; i < layer_count; i++)
+  {
+    Layer &layer = layers[i];
+    if (layer.had_bg_opa)
+    {
+      lv_obj_set_local_style_prop(layer.obj, LV_STYLE_BG_OPA, layer.bg_opa, LV_PART_MAIN);
+    }
+    else
+    {
+      lv_obj_remove_local_style_prop(layer.obj, LV_STYLE_BG_OPA, LV_PART_MAIN);
+    }
+
+    if (layer.had_shadow_width)
+    {
+      lv_obj_set_local_style_prop(layer.obj, LV_STYLE_SHADOW_WIDTH, layer.shadow_width, LV_PART_MAIN);
+    }
+    else
+    {
+      lv_obj_remove_local_style_prop(layer.obj, LV_STYLE_SHADOW_WIDTH, LV_PART_MAIN);
+    }
+  }
+  lv_obj_remove_local_style_prop(root, LV_STYLE_BG_IMAGE_SRC, LV_PART_MAIN);
+
+  active = false;
+  applying = false;
+}
+
+uint32_t StaticLayerCache::timeDynamicRedraws(uint32_t frames)
+{
+  // Settle pending invalidations first
+  lv_refr_now(NULL);
+
+  unsigned long start = micros();
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    invalidateDynamic(root);
+    lv_refr_now(NULL);
+  }
+  return (micros() - start) / frames;
+}
+
+int32_t StaticLayerCache::measureSaving(uint32_t frames)
+{
+  if (root == nullptr || frames == 0)
+  {
+    return 0;
+  }
+
+  bool was_enabled = enabled;
+
+  setEnabled(false);
+  uint32_t live_us = timeDynamicRedraws(frames);
+
+  setEnabled(true);
+  prepare();
+  uint32_t cached_us = timeDynamicRedraws(frames);
+
+  setEnabled(was_enabled);
+  prepare();
+
+  int32_t saved_us = (int32_t)live_us - (int32_t)cached_us;
+  LOG_INFOF("StaticLayerCache: update redraw %lu us live, %lu us cached, saves %ld us per update\n",
+            (unsigned long)live_us, (unsigned long)cached_us, (long)saved_us);
+  return saved_us;
+}
@@ -0,0 +1,96 @@
+#ifndef STATIC_LAYER_CACHE_H
+#define STATIC_LAYER_CACHE_H
+
+#include <stdint.h>
+
+// Third-party libraries
+#include <lvgl.h>
+
+// Maximum number of layer objects and of dynamic objects hidden while baking
+#define STATIC_LAYER_MAX_LAYERS 4
+#define STATIC_LAYER_MAX_HIDDEN 32
+
+// Static background layer cache
+// Renders the root object and the registered layer objects (backgrounds,
+// radii, shadows) once into a PSRAM bitmap with everything else hidden, then
+// shows that bitmap as the root's background image while the layers stop
+// drawing their own background and shadow. Redrawing a label then costs an
+// image copy instead of re-rendering the rounded cards and their shadows.
+// The bitmap is rebuilt when a layer moves, resizes or changes style (theme).
+// With more than STATIC_LAYER_MAX_HIDDEN dynamic objects nothing is cached and
+// the layers keep drawing live.
+class StaticLayerCache
+{
+public:
+  StaticLayerCache();
+  ~StaticLayerCache();
+
+  // Object that receives the cached bitmap as background (the screen)
+  void setRoot(lv_obj_t *root);
+
+  // Descendant of the root whose background and shadow are static
+  void addLayer(lv_obj_t *obj);
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const { return enabled; }
+  bool isActive() const { return active; }
+
+  // Rebuild the bitmap if needed; call before the screen is refreshed
+  void prepare();
+
+  // Draw the layers live again until the next prepare()
+  void invalidate();
+
+  uint32_t getLayerCount() const { return layer_count; }
+  lv_obj_t *getLayer(uint32_t index) const { return layers[index].obj; }
+
+  uint32_t getBuildCount() const { return build_count; }
+  uint32_t getLastBuildUs() const { return last_build_us; }
+  uint32_t getBytes() const { return image.data_size; }
+
+  // Time `frames` redraws of all dynamic objects with the layers drawn live
+  // and from the cache, log both and return the saving per redraw in us
+  int32_t measureSaving(uint32_t frames);
+
+private:
+  struct Layer
+  {
+    lv_obj_t *obj;
+    lv_area_t coords;
+    bool had_bg_opa;
+    bool had_shadow_width;
+    lv_style_value_t bg_opa;
+    lv_style_value_t shadow_width;
+  };
+
+  static void onLayerEvent(lv_event_t *e);
+  bool isLayer(const lv_obj_t *obj) const;
+  bool layersMoved() const;
+  bool build();
+  void apply();
+  void release();
+  bool hideDynamic(lv_obj_t *parent);
+  void invalidateDynamic(lv_obj_t *parent);
+  uint32_t timeDynamicRedraws(uint32_t frames);
+
+  lv_obj_t *root;
+  Layer layers[STATIC_LAYER_MAX_LAYERS];
+  uint32_t layer_count;
+
+  lv_obj_t *hidden[STATIC_LAYER_MAX_HIDDEN];
+  uint32_t hidden_count;
+
+  lv_draw_buf_t draw_buf;
+  lv_image_dsc_t image;
+  void *buffer;
+
+  bool enabled;
+  bool active;   // Bitmap shown, layers flattened
+  bool applying; // Ignore style events caused by apply()/release()
+  bool dirty;
+
+  uint32_t build_count;
+  uint32_t last_build_us;
+};
+
+#endif // STATIC_LAYER_CACHE_H
@@ -0,0 +1,129 @@
+// Own header
+#include "ui_transaction.h"
+#include <Arduino.h>
+#include "../debug.h"
+#include "trace.h"
+#include "weather_icons.h"
+
+#include <string.h>
+
+UiTransaction::UiTransaction()
+{
+  text_count = 0;
+  icon_widget = nullptr;
+  icon_code = 0;
+  icon_daytime = true;
+  shown_icon_widget = nullptr;
+  shown_icon_code = 0;
+  shown_icon_daytime = true;
+  begin_us = 0;
+  open = false;
+  resetStats();
+}
+
+void UiTransaction::resetStats()
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void UiTransaction::begin()
+{
+  text_count = 0;
+  icon_widget = nullptr;
+  begin_us = micros();
+  open = true;
+}
+
+void UiTransaction::setText(lv_obj_t *label, const char *text)
+{
+  if (label == nullptr)
+  {
+    return;
+  }
+
+  TextChange *change = nullptr;
+  for (uint32_t i = 0; i < text_count; i++)
+  {
+    if (texts[i].label == label)
+    {
+      change = &texts[i];
+      break;
+    }
+  }
+
+  if (change == nullptr)
+  {
+    if (text_count >= UI_TRANSACTION_MAX_TEXTS)
+    {
+      LOG_ERROR("UiTransaction: too many label changes");
+      return;
+    }
+    change = &texts[text_count++];
+    change->label = label;
+  }
+  snprintf(change->text, sizeof(change->text), "%s", text);
+}
+
+void UiTransaction::setIcon(lv_obj_t *widget, int condition_code, bool daytime)
+{
+  icon_widget = widget;
+  icon_code = condition_code;
+  icon_daytime = daytime;
+}
+
+uint32_t UiTransaction::commit()
+{
+  if (!open)
+  {
+    return 0;
+  }
+
+  TRACE_SCOPE("ui_commit");
+  uint32_t applied = 0;
+  uint32_t skipped = 0;
+
+  for (uint32_t i = 0; i < text_count; i++)
+  {
+    // lv_label_set_text() invalidates even when the text is the same
+    if (strcmp(lv_label_get_text(texts[i].label), texts[i].text) == 0)
+    {
+      skipped++;
+      continue;
+    }
+    lv_label_set_text(texts[i].label, texts[i].text);
+    applied++;
+  }
+
+  if (icon_widget != nullptr)
+  {
+    if (icon_widget == shown_icon_widget && icon_code == shown_icon_code && icon_daytime == shown_icon_daytime)
+    {
+      skipped++;
+    }
+    else
+    {
+      WeatherIcons::updateWeatherIcon(icon_widget, icon_code, icon_daytime);
+      shown_icon_widget = icon_widget;
+      shown_icon_code = icon_code;
+      shown_icon_daytime = icon_daytime;
+      applied++;
+    }
+  }
+
+  open = false;
+
+  uint32_t blocked_us = micros() - begin_us;
+  stats.commits++;
+  stats.applied += applied;
+  stats.skipped += skipped;
+  stats.last_blocked_us = blocked_us;
+  stats.total_blocked_us += blocked_us;
+  if (blocked_us > stats.max_blocked_us)
+  {
+    stats.max_blocked_us = blocked_us;
+  }
+
+  DEBUG_LOGF("UI commit: %lu changes, %lu unchanged, blocked %lu us\n",
+             (unsigned long)applied, (unsigned long)skipped, (unsigned long)blocked_us);
+  return applied;
+}
@@ -0,0 +1,79 @@
+#ifndef UI_TRANSACTION_H
+#define UI_TRANSACTION_H
+
+#include <stdint.h>
+
+// Third-party libraries
+#include <lvgl.h>
+
+// Maximum number of staged label texts and their length
+#define UI_TRANSACTION_MAX_TEXTS 12
+#define UI_TRANSACTION_TEXT_LEN 48
+
+// Batched UI update
+// Setters between begin() and commit() only record the new value. commit()
+// applies the ones that differ from what is shown, all at once, so an update
+// invalidates each changed object once and is drawn in a single refresh on
+// the next lv_timer_handler() instead of being rendered synchronously.
+// The time from begin() to the end of commit() is what the caller was
+// blocked by the update and is kept in the stats.
+class UiTransaction
+{
+public:
+  struct Stats
+  {
+    uint32_t commits;
+    uint32_t applied; // Changes that reached LVGL
+    uint32_t skipped; // Staged values equal to what was shown
+    uint32_t last_blocked_us;
+    uint32_t max_blocked_us;
+    uint64_t total_blocked_us;
+  };
+
+  UiTransaction();
+
+  void begin();
+
+  // Stage a label text (copied; a later call for the same label replaces it)
+  void setText(lv_obj_t *label, const char *text);
+
+  // Stage the weather icon shown in `widget`
+  void setIcon(lv_obj_t *widget, int condition_code, bool daytime);
+
+  // Apply the staged changes, returns how many were applied
+  uint32_t commit();
+
+  bool isOpen() const { return open; }
+
+  // The icon was changed outside a transaction, apply the next one again
+  void forgetIcon() { shown_icon_widget = nullptr; }
+
+  const Stats &getStats() const { return stats; }
+  void resetStats();
+
+private:
+  struct TextChange
+  {
+    lv_obj_t *label;
+    char text[UI_TRANSACTION_TEXT_LEN];
+  };
+
+  TextChange texts[UI_TRANSACTION_MAX_TEXTS];
+  uint32_t text_count;
+
+  // Staged icon (widget nullptr: none)
+  lv_obj_t *icon_widget;
+  int icon_code;
+  bool icon_daytime;
+
+  // Icon last applied, setting the same source again reloads the image
+  lv_obj_t *shown_icon_widget;
+  int shown_icon_code;
+  bool shown_icon_daytime;
+
+  unsigned long begin_us;
+  bool open;
+  Stats stats;
+};
+
+#endif // UI_TRANSACTION_H
@@ -3,8 +3,41 @@
 #include "label_icons.h"
 #include "../debug.h"
 #include "../config.h"
+#include "trace.h"
+#include "generated/weather_fonts.h"
+#include "generated/weather_icon_images.h"
+#include "../lvgl/lvgl_glyph_cache.h"
+#include <string.h>
 #include <time.h>
 
+// Background of the upper card, under the weather icon. resources/compile_icons.py
+// reads it to composite the opaque icons (ICON_SOURCE_OPAQUE) on the same color.
+#define MAIN_CARD_BG_COLOR 0x29006b
+static_assert(WEATHER_ICON_OPAQUE_BG == MAIN_CARD_BG_COLOR,
+              "Opaque icons are for another card color, run resources/compile_icons.py");
+
+// Weather icon box of each layout. The icon set of that size is drawn, so
+// nothing is scaled; resources/compile_icons.py compiles these sets into
+// flash (sizes: 32, 48, 64, 96).
+#define ICON_SIZE_HORIZONTAL 64
+#define ICON_SIZE_VERTICAL 64
+
+static constexpr int icon_flash_sizes[] = {WEATHER_ICON_FLASH_SIZES};
+
+static constexpr bool icon_size_in_flash(int size)
+{
+  for (int flash_size : icon_flash_sizes)
+  {
+    if (flash_size == size)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+static_assert(icon_size_in_flash(ICON_SIZE_HORIZONTAL) && icon_size_in_flash(ICON_SIZE_VERTICAL),
+              "Icon set of a layout size not in flash, run resources/compile_icons.py");
+
 WeatherUI::WeatherUI(WeatherAPI *api) : weather_api(api)
 {
   weather_screen = nullptr;
@@ -40,10 +73,17 @@ void WeatherUI::createWeatherScreen()
   // Create refresh timestamp label at bottom (below lower card)
   refresh_time_label = lv_label_create(weather_container);
   lv_label_set_text(refresh_time_label, "Refreshed: --");
-  lv_obj_set_style_text_font(refresh_time_label, &lv_font_montserrat_16, LV_PART_MAIN);
+  lv_obj_set_style_text_font(refresh_time_label, &weather_font_16, LV_PART_MAIN);
   lv_obj_set_style_text_color(refresh_time_label, lv_color_hex(0x888888), LV_PART_MAIN);
   lv_obj_align(refresh_time_label, LV_ALIGN_BOTTOM_MID, 0, -5);
 #endif
+
+  // Screen, container and both cards never change after creation
+  static_layer.setRoot(weather_screen);
+  static_layer.addLayer(weather_container);
+  static_layer.addLayer(main_card);
+  static_layer.addLayer(info_card);
+  static_layer.setEnabled(UI_STATIC_LAYER_CACHE);
 }
 
 void WeatherUI::createScreenBase()
@@ -73,7 +113,7 @@ void WeatherUI::createTitleLabel()
   // In horizontal mode, title is inside the upper card - hide this one
   lv_obj_add_flag(title_label, LV_OBJ_FLAG_HIDDEN);
 #else
-  lv_obj_set_style_text_font(title_label, &lv_font_montserrat_16, LV_PART_MAIN);
+  lv_obj_set_style_text_font(title_label, &weather_font_16, LV_PART_MAIN);
   lv_obj_set_style_text_color(title_label, lv_color_hex(0x1976d2), LV_PART_MAIN);
   lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 10);
 #endif
@@ -92,7 +132,7 @@ void WeatherUI::createUpperCard()
   lv_obj_set_size(main_card, LV_HOR_RES - 20, 165);
   lv_obj_align(main_card, LV_ALIGN_TOP_MID, 0, 35);
 #endif
-  lv_obj_set_style_bg_color(main_card, lv_color_hex(0x29006b), LV_PART_MAIN); // Match icon background
+  lv_obj_set_style_bg_color(main_card, lv_color_hex(MAIN_CARD_BG_COLOR), LV_PART_MAIN);
   lv_obj_set_style_border_width(main_card, 0, LV_PART_MAIN);
   lv_obj_set_style_radius(main_card, 15, LV_PART_MAIN);
   lv_obj_set_style_pad_all(main_card, 8, LV_PART_MAIN);
@@ -105,7 +145,7 @@ void WeatherUI::createUpperCard()
   // Weather status label inside upper card (horizontal only)
   card_title_label = lv_label_create(main_card);
   lv_label_set_text(card_title_label, "Weather");
-  lv_obj_set_style_text_font(card_title_label, &lv_font_montserrat_16, LV_PART_MAIN);
+  lv_obj_set_style_text_font(card_title_label, &weather_font_16, LV_PART_MAIN);
   lv_obj_set_style_text_color(card_title_label, lv_color_hex(0xe3f2fd), LV_PART_MAIN);
   lv_obj_align(card_title_label, LV_ALIGN_TOP_LEFT, 5, 2);
 
@@ -120,14 +160,14 @@ void WeatherUI::createUpperCard()
   // Weather icon - top of upper card (vertical) or left side (horizontal)
   weather_icon_img = lv_obj_create(main_card);
 #if DISPLAY_HORIZONTAL
-  lv_obj_set_size(weather_icon_img, 64, 64);
+  lv_obj_set_size(weather_icon_img, ICON_SIZE_HORIZONTAL, ICON_SIZE_HORIZONTAL);
   lv_obj_set_style_bg_opa(weather_icon_img, LV_OPA_TRANSP, 0);
   lv_obj_set_style_border_width(weather_icon_img, 0, 0);
   lv_obj_set_style_pad_all(weather_icon_img, 0, 0);
   lv_obj_clear_flag(weather_icon_img, LV_OBJ_FLAG_SCROLLABLE);
   lv_obj_align(weather_icon_img, LV_ALIGN_LEFT_MID, 5, 10);
 #else
-  lv_obj_set_size(weather_icon_img, 64, 64);
+  lv_obj_set_size(weather_icon_img, ICON_SIZE_VERTICAL, ICON_SIZE_VERTICAL);
   lv_obj_set_style_bg_opa(weather_icon_img, LV_OPA_TRANSP, 0);
   lv_obj_set_style_border_width(weather_icon_img, 0, 0);
   lv_obj_set_style_pad_all(weather_icon_img, 0, 0);
@@ -138,11 +178,11 @@ void WeatherUI::createUpperCard()
   temperature_label = lv_label_create(main_card);
   lv_label_set_text(temperature_label, "--°");
 #if DISPLAY_HORIZONTAL
-  lv_obj_set_style_text_font(temperature_label, &lv_font_montserrat_48, LV_PART_MAIN);
+  lv_obj_set_style_text_font(temperature_label, lvgl_glyph_cache_font(&weather_font_48), LV_PART_MAIN);
   lv_obj_set_style_text_color(temperature_label, lv_color_hex(0xffffff), LV_PART_MAIN);
   lv_obj_align(temperature_label, LV_ALIGN_CENTER, 10, 10);
 #else
-  lv_obj_set_style_text_font(temperature_label, &lv_font_montserrat_48, LV_PART_MAIN);
+  lv_obj_set_style_text_font(temperature_label, lvgl_glyph_cache_font(&weather_font_48), LV_PART_MAIN);
   lv_obj_set_style_text_color(temperature_label, lv_color_hex(0xffffff), LV_PART_MAIN);
   lv_obj_align(temperature_label, LV_ALIGN_CENTER, 0, 15);
 #endif
@@ -151,11 +191,11 @@ void WeatherUI::createUpperCard()
   temp_low_label = lv_label_create(main_card);
   lv_label_set_text(temp_low_label, "-- - --°");
 #if DISPLAY_HORIZONTAL
-  lv_obj_set_style_text_font(temp_low_label, &lv_font_montserrat_24, LV_PART_MAIN);
+  lv_obj_set_style_text_font(temp_low_label, lvgl_glyph_cache_font(&weather_font_24), LV_PART_MAIN);
   lv_obj_set_style_text_color(temp_low_label, lv_color_hex(0xb39ddb), LV_PART_MAIN); // Dimmed purple
   lv_obj_align(temp_low_label, LV_ALIGN_BOTTOM_RIGHT, -10, -5);
 #else
-  lv_obj_set_style_text_font(temp_low_label, &lv_font_montserrat_24, LV_PART_MAIN);
+  lv_obj_set_style_text_font(temp_low_label, lvgl_glyph_cache_font(&weather_font_24), LV_PART_MAIN);
   lv_obj_set_style_text_color(temp_low_label, lv_color_hex(0xe3f2fd), LV_PART_MAIN);
   lv_obj_align(temp_low_label, LV_ALIGN_BOTTOM_MID, 0, -8);
 #endif
@@ -205,7 +245,7 @@ void WeatherUI::createLowerCard()
   // AQI value
   aqi_info_label = lv_label_create(info_card);
   lv_label_set_text(aqi_info_label, "--");
-  lv_obj_set_style_text_font(aqi_info_label, &lv_font_montserrat_24, LV_PART_MAIN);
+  lv_obj_set_style_text_font(aqi_info_label, lvgl_glyph_cache_font(&weather_font_24), LV_PART_MAIN);
   lv_obj_set_style_text_color(aqi_info_label, lv_color_hex(0xffffff), LV_PART_MAIN);
   lv_obj_align(aqi_info_label, LV_ALIGN_LEFT_MID, 58, 0);
 
@@ -223,7 +263,7 @@ void WeatherUI::createLowerCard()
   // Humidity value with %
   humidity_info_label = lv_label_create(info_card);
   lv_label_set_text(humidity_info_label, "--%");
-  lv_obj_set_style_text_font(humidity_info_label, &lv_font_montserrat_24, LV_PART_MAIN);
+  lv_obj_set_style_text_font(humidity_info_label, lvgl_glyph_cache_font(&weather_font_24), LV_PART_MAIN);
   lv_obj_set_style_text_color(humidity_info_label, lv_color_hex(0xffffff), LV_PART_MAIN);
   lv_obj_align(humidity_info_label, LV_ALIGN_RIGHT_MID, 0, 0);
 
@@ -237,7 +277,7 @@ void WeatherUI::createLowerCard()
   aqi_icon_img = lv_label_create(info_card);
   lv_label_set_text(aqi_icon_img, AIR_QUALITY_ICON_SYMBOL);
   lv_obj_set_style_text_color(aqi_icon_img, lv_color_hex(0xffffff), LV_PART_MAIN);
-  lv_obj_set_style_text_font(aqi_icon_img, &lv_font_montserrat_16, LV_PART_MAIN);
+  lv_obj_set_style_text_font(aqi_icon_img, &weather_font_16, LV_PART_MAIN);
   lv_obj_align(aqi_icon_img, LV_ALIGN_TOP_LEFT, 5, 10);
 
   // AQI unit label (smaller)
@@ -250,7 +290,7 @@ void WeatherUI::createLowerCard()
   // AQI value in lower card
   aqi_info_label = lv_label_create(info_card);
   lv_label_set_text(aqi_info_label, "--");
-  lv_obj_set_style_text_font(aqi_info_label, &lv_font_montserrat_26, LV_PART_MAIN);
+  lv_obj_set_style_text_font(aqi_info_label, lvgl_glyph_cache_font(&weather_font_26), LV_PART_MAIN);
   lv_obj_set_style_text_color(aqi_info_label, lv_color_hex(0xffffff), LV_PART_MAIN);
   lv_obj_set_style_text_align(aqi_info_label, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
   lv_obj_align(aqi_info_label, LV_ALIGN_TOP_RIGHT, -56, 4);
@@ -259,20 +299,20 @@ void WeatherUI::createLowerCard()
   humidity_icon_img = lv_label_create(info_card);
   lv_label_set_text(humidity_icon_img, HUMIDITY_ICON_SYMBOL);
   lv_obj_set_style_text_color(humidity_icon_img, lv_color_hex(0xffffff), LV_PART_MAIN);
-  lv_obj_set_style_text_font(humidity_icon_img, &lv_font_montserrat_16, LV_PART_MAIN);
+  lv_obj_set_style_text_font(humidity_icon_img, &weather_font_16, LV_PART_MAIN);
   lv_obj_align(humidity_icon_img, LV_ALIGN_TOP_LEFT, 5, 44);
 
   // Humidity unit label (smaller, right-aligned)
   humidity_unit_label = lv_label_create(info_card);
   lv_label_set_text(humidity_unit_label, "%");
-  lv_obj_set_style_text_font(humidity_unit_label, &lv_font_montserrat_16, LV_PART_MAIN);
+  lv_obj_set_style_text_font(humidity_unit_label, &weather_font_16, LV_PART_MAIN);
   lv_obj_set_style_text_color(humidity_unit_label, lv_color_hex(0xe8f5e9), LV_PART_MAIN);
   lv_obj_align_to(humidity_unit_label, humidity_icon_img, LV_ALIGN_BOTTOM_LEFT, 80, 4);
 
   // Humidity value in lower card
   humidity_info_label = lv_label_create(info_card);
   lv_label_set_text(humidity_info_label, "--");
-  lv_obj_set_style_text_font(humidity_info_label, &lv_font_montserrat_26, LV_PART_MAIN);
+  lv_obj_set_style_text_font(humidity_info_label, lvgl_glyph_cache_font(&weather_font_26), LV_PART_MAIN);
   lv_obj_set_style_text_color(humidity_info_label, lv_color_hex(0xffffff), LV_PART_MAIN);
   lv_obj_set_style_text_align(humidity_info_label, LV_TEXT_ALIGN_RIGHT, LV_PART_MAIN);
   lv_obj_align(humidity_info_label, LV_ALIGN_TOP_RIGHT, -56, 36);
@@ -281,6 +321,7 @@ void WeatherUI::createLowerCard()
 
 void WeatherUI::updateWeatherDisplay()
 {
+  TRACE_SCOPE("ui_update");
   DEBUG_LOG("Updating weather display...");
 
   if (!weather_api || !weather_container)
@@ -289,25 +330,29 @@ void WeatherUI::updateWeatherDisplay()
     return;
   }
 
+  // Collect every change, then apply them together; they are drawn in one
+  // refresh on the next lv_timer_handler()
+  update.begin();
+
+  // Rebuild the cached background first if the layout or theme changed
+  static_layer.prepare();
+
   WeatherData weather = weather_api->getCurrentWeather();
 
   if (weather.valid)
   {
     // Update weather state title
     const char *stateName = WeatherIcons::getConditionDisplayName(weather.condition_code);
-    lv_label_set_text(title_label, stateName);
+    update.setText(title_label, stateName);
 #if DISPLAY_HORIZONTAL
     // Also update card title in horizontal mode
-    if (card_title_label)
-    {
-      lv_label_set_text(card_title_label, stateName);
-    }
+    update.setText(card_title_label, stateName);
 #endif
 
     // Update weather icon with day/night variant
     if (weather_icon_img)
     {
-      WeatherIcons::updateWeatherIcon(weather_icon_img, weather.condition_code, isDaytime());
+      update.setIcon(weather_icon_img, weather.condition_code, isDaytime());
     }
 
     // Update all display sections
@@ -319,20 +364,19 @@ void WeatherUI::updateWeatherDisplay()
   else
   {
     // Show error state
-    lv_label_set_text(title_label, "Weather");
+    update.setText(title_label, "Weather");
 #if DISPLAY_HORIZONTAL
-    if (card_title_label)
-    {
-      lv_label_set_text(card_title_label, "Weather");
-    }
-    lv_label_set_text(humidity_info_label, "--%");
+    update.setText(card_title_label, "Weather");
+    update.setText(humidity_info_label, "--%");
 #else
-    lv_label_set_text(humidity_info_label, "--");
+    update.setText(humidity_info_label, "--");
 #endif
-    lv_label_set_text(temperature_label, "--°");
-    lv_label_set_text(aqi_info_label, "--");
-    lv_label_set_text(refresh_time_label, LV_SYMBOL_LOOP "  --");
+    update.setText(temperature_label, "--°");
+    update.setText(aqi_info_label, "--");
+    update.setText(refresh_time_label, LV_SYMBOL_LOOP "  --");
   }
+
+  update.commit();
 }
 
 // Helper method: Check if current time is daytime (6 AM - 6 PM)
@@ -350,12 +394,12 @@ void WeatherUI::updateTemperatureDisplay(const WeatherData &weather)
 {
   // Update current temperature (rounded)
   String temp_str = String((int)round(weather.temperature)) + "°";
-  lv_label_set_text(temperature_label, temp_str.c_str());
+  update.setText(temperature_label, temp_str.c_str());
 
   // Update low/high temperature range in "X - Y°" format (rounded)
   String temp_range = String((int)round(weather.temp_low)) + " - " +
                       String((int)round(weather.temp_high)) + "°";
-  lv_label_set_text(temp_low_label, temp_range.c_str());
+  update.setText(temp_low_label, temp_range.c_str());
 }
 
 // Helper method: Update humidity display
@@ -367,14 +411,14 @@ void WeatherUI::updateHumidityDisplay(const WeatherData &weather)
 #else
   String humidity_str = String(weather.humidity);
 #endif
-  lv_label_set_text(humidity_info_label, humidity_str.c_str());
+  update.setText(humidity_info_label, humidity_str.c_str());
 }
 
 // Helper method: Update air quality display
 void WeatherUI::updateAirQualityDisplay()
 {
   String aqi_str = weather_api->getAirQualityString();
-  lv_label_set_text(aqi_info_label, aqi_str.c_str());
+  update.setText(aqi_info_label, aqi_str.c_str());
 }
 
 // Helper method: Update timestamp display
@@ -383,15 +427,9 @@ void WeatherUI::updateTimestampDisplay()
   time_t fetch_time = weather_api->getLastUpdateTime();
   DEBUG_LOGF("Fetch time: %lu\n", (unsigned long)fetch_time);
 
-  static char time_buf[32];
+  char time_buf[32];
   formatTimestamp(time_buf, sizeof(time_buf), fetch_time);
-
-  lv_label_set_text(refresh_time_label, time_buf);
-
-  // Force LVGL to refresh the label
-  lv_obj_invalidate(refresh_time_label);
-  delay(10);
-  lv_refr_now(NULL);
+  update.setText(refresh_time_label, time_buf);
 }
 
 // Helper method: Format timestamp as "HH:MM Mon DD"
@@ -420,6 +458,7 @@ void WeatherUI::showWeatherScreen()
   if (weather_screen)
   {
     lv_scr_load(weather_screen);
+    static_layer.prepare();
   }
 }
 
@@ -427,3 +466,214 @@ lv_obj_t *WeatherUI::getWeatherScreen()
 {
   return weather_screen;
 }
+
+StaticLayerCache &WeatherUI::getStaticLayerCache()
+{
+  return static_layer;
+}
+
+const UiTransaction::Stats &WeatherUI::getUpdateStats() const
+{
+  return update.getStats();
+}
+
+bool WeatherUI::benchmarkIcons(uint32_t switches)
+{
+  WeatherIcons::benchmarkSources(weather_icon_img, switches);
+  bool codecs_ok = WeatherIcons::benchmarkCodecs();
+  bool opaque_ok = WeatherIcons::benchmarkOpaque(weather_icon_img, switches);
+  bool sets_ok = WeatherIcons::checkIconSets(weather_icon_img, switches);
+  update.forgetIcon();
+  updateWeatherDisplay();
+  return codecs_ok && opaque_ok && sets_ok;
+}
+
+// Next code point of UTF-8 `*text`, 0 at the end
+static uint32_t next_letter(const char **text)
+{
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(*text);
+  uint32_t letter = p[0];
+  uint32_t length = 1;
+  if (letter >= 0xF0 && p[1] && p[2] && p[3])
+  {
+    letter = (letter & 0x07) << 18 | (p[1] & 0x3F) << 12 | (p[2] & 0x3F) << 6 | (p[3] & 0x3F);
+    length = 4;
+  }
+  else if (letter >= 0xE0 && p[1] && p[2])
+  {
+    letter = (letter & 0x0F) << 12 | (p[1] & 0x3F) << 6 | (p[2] & 0x3F);
+    length = 3;
+  }
+  else if (letter >= 0xC0 && p[1])
+  {
+    letter = (letter & 0x1F) << 6 | (p[1] & 0x3F);
+    length = 2;
+  }
+  *text += letter != 0 ? length : 0;
+  return letter;
+}
+
+// Whether the label's font has a glyph for every character of `text`
+static bool font_covers(lv_obj_t *label, const char *text, const char *name)
+{
+  if (label == nullptr)
+  {
+    return true;
+  }
+
+  const lv_font_t *font = lv_obj_get_style_text_font(label, LV_PART_MAIN);
+  const char *p = text;
+  uint32_t letter;
+  while ((letter = next_letter(&p)) != 0)
+  {
+    lv_font_glyph_dsc_t glyph;
+    memset(&glyph, 0, sizeof(glyph));
+    if (!font->get_glyph_dsc(font, &glyph, letter, 0))
+    {
+      LOG_ERRORF("Fonts: %s has no glyph U+%04lX for \"%s\"\n", name, (unsigned long)letter, text);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool WeatherUI::benchmarkLabels(uint32_t updates)
+{
+  // What updateWeatherDisplay() writes, through the same methods
+  bool ok = true;
+  WeatherData weather = WeatherData();
+  weather.valid = true;
+  for (int t = -60; t <= 60 && ok; t++)
+  {
+    weather.temperature = t;
+    weather.temp_low = t;
+    weather.temp_high = -t;
+    weather.humidity = t < 0 ? -t : t;
+    update.begin();
+    updateTemperatureDisplay(weather);
+    updateHumidityDisplay(weather);
+    update.commit();
+    ok = font_covers(temperature_label, lv_label_get_text(temperature_label), "temperature") &&
+         font_covers(temp_low_label, lv_label_get_text(temp_low_label), "temperature range") &&
+         font_covers(humidity_info_label, lv_label_get_text(humidity_info_label), "humidity");
+  }
+
+  char text[32];
+  for (int value = 0; value <= 999 && ok; value++)
+  {
+    snprintf(text, sizeof(text), "%d", value);
+    ok = font_covers(aqi_info_label, text, "PM2.5");
+  }
+  for (int month = 0; month < 12 && ok; month++)
+  {
+    formatTimestamp(text, sizeof(text), (time_t)month * 31 * 24 * 3600);
+    ok = font_covers(refresh_time_label, text, "refresh time");
+  }
+
+#if DISPLAY_HORIZONTAL
+  lv_obj_t *condition_label = card_title_label;
+#else
+  lv_obj_t *condition_label = title_label;
+#endif
+  // Placeholders without data
+  ok = ok && font_covers(condition_label, "Weather", "condition") &&
+       font_covers(condition_label, WeatherIcons::getConditionDisplayName(0), "condition") &&
+       font_covers(temperature_label, "--°", "temperature") &&
+       font_covers(temp_low_label, "-- - --°", "temperature range") &&
+       font_covers(aqi_info_label, "--", "PM2.5") &&
+#if DISPLAY_HORIZONTAL
+       font_covers(humidity_info_label, "--%", "humidity") &&
+#else
+       font_covers(humidity_info_label, "--", "humidity") &&
+#endif
+       font_covers(refresh_time_label, LV_SYMBOL_LOOP "  --", "refresh time");
+  for (int i = 0; i < WeatherIcons::getConditionCount() && ok; i++)
+  {
+    ok = font_covers(condition_label, WeatherIcons::getConditionDisplayName(WeatherIcons::getConditionCode(i)),
+                     "condition");
+  }
+  if (!ok)
+  {
+    updateWeatherDisplay();
+    return false;
+  }
+  LOG_INFOF("Fonts: subsets %lu B instead of %lu B, %lu B of flash saved\n",
+            (unsigned long)WEATHER_FONTS_SUBSET_BYTES, (unsigned long)WEATHER_FONTS_FULL_BYTES,
+            (unsigned long)(WEATHER_FONTS_FULL_BYTES - WEATHER_FONTS_SUBSET_BYTES));
+
+  if (updates == 0)
+  {
+    updateWeatherDisplay();
+    return true;
+  }
+
+  struct NumberLabel
+  {
+    const char *name;
+    lv_obj_t *label;
+  };
+  const NumberLabel labels[] = {
+    {"temperature", temperature_label},
+    {"range", temp_low_label},
+    {"humidity", humidity_info_label},
+    {"pm2.5", aqi_info_label},
+  };
+
+  uint32_t saved_budget = lvgl_glyph_cache_get_budget();
+  for (const NumberLabel &number : labels)
+  {
+    uint32_t avg_us[2] = {0, 0};
+    uint32_t lv_used[2] = {0, 0}; // LVGL heap after the pass
+    for (int cached = 0; cached < 2; cached++)
+    {
+      lvgl_glyph_cache_set_budget(cached ? saved_budget : 0);
+      lvgl_glyph_cache_reset_stats();
+
+      uint32_t total_us = 0;
+      for (uint32_t i = 0; i < updates; i++)
+      {
+        // Every update changes the text, all digits come up
+        int value = (int)(i * 7 % 50) - 10;
+        if (number.label == temperature_label)
+        {
+          snprintf(text, sizeof(text), "%d°", value);
+        }
+        else if (number.label == temp_low_label)
+        {
+          snprintf(text, sizeof(text), "%d - %d°", value, value + 8);
+        }
+        else
+        {
+          snprintf(text, sizeof(text), "%d", value + 10);
+        }
+
+        unsigned long start = micros();
+        lv_label_set_text(number.label, text);
+        lv_refr_now(NULL);
+        total_us += micros() - start;
+      }
+      avg_us[cached] = total_us / updates;
+      lv_mem_monitor_t mon;
+      lv_mem_monitor(&mon);
+      lv_used[cached] = mon.total_size - mon.free_size;
+    }
+
+    const GlyphCacheStats &stats = lvgl_glyph_cache_get_stats();
+    long lv_delta = (long)lv_used[1] - (long)lv_used[0];
+    LOG_INFOF("Label %-11s: %lu updates, avg %5lu us, glyph cache %5lu us (%lu hits, %lu misses, %lu B PSRAM, "
+              "LVGL heap %+ld B)\n",
+              number.name, (unsigned long)updates, (unsigned long)avg_us[0], (unsigned long)avg_us[1],
+              (unsigned long)stats.hits, (unsigned long)stats.misses, (unsigned long)stats.bytes, lv_delta);
+    // The bitmaps must stay out of the heap widgets and decoders share
+    if (stats.bytes > 0 && lv_delta >= (long)stats.bytes)
+    {
+      LOG_ERRORF("Glyph cache: %lu B held, LVGL heap grew %ld B\n", (unsigned long)stats.bytes, lv_delta);
+      lvgl_glyph_cache_set_budget(saved_budget);
+      return false;
+    }
+  }
+  lvgl_glyph_cache_set_budget(saved_budget);
+
+  updateWeatherDisplay();
+  return true;
+}
@@ -6,6 +6,8 @@
 
 // Project headers
 #include "../weather/weather_api.h"
+#include "static_layer_cache.h"
+#include "ui_transaction.h"
 #include "weather_icons.h"
 
 class WeatherUI
@@ -32,6 +34,12 @@ private:
 
   WeatherAPI *weather_api;
 
+  // Cached background, cards and shadows
+  StaticLayerCache static_layer;
+
+  // Changes of the current updateWeatherDisplay() call
+  UiTransaction update;
+
   // Private helper methods for UI creation
   void createScreenBase();
   void createTitleLabel();
@@ -60,6 +68,24 @@ public:
 
   // Get weather screen object
   lv_obj_t *getWeatherScreen();
+
+  // Static background layer cache (enable/disable, stats)
+  StaticLayerCache &getStaticLayerCache();
+
+  // Update commits and time spent blocked in updateWeatherDisplay()
+  const UiTransaction::Stats &getUpdateStats() const;
+
+  // Compare icon switch latency and heap peak per icon source, the PNG and
+  // QOI codecs and alpha vs opaque icon draws, check the icon sets, then
+  // redraw; false if a decoder's pixels differ from LODEPNG's, the opaque
+  // icons from the card, or an icon set is incomplete
+  bool benchmarkIcons(uint32_t switches);
+
+  // Check that every text the labels can show has its glyphs in the label's
+  // subset font, then time `updates` changes of each number label (set text
+  // + render) without and with the glyph cache; false if a glyph is missing
+  // or the cached bitmaps take LVGL heap
+  bool benchmarkLabels(uint32_t updates);
 };
 
 #endif // UI_WEATHER_H
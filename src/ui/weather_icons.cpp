@@ -2,122 +2,337 @@
 #include <Arduino.h>
 #include <LittleFS.h>
 #include <lvgl.h>
+#include "trace.h"
+#include "../config.h"
+#include "../debug.h"
+#include "generated/weather_icon_images.h"
+#include "../lvgl/lvgl_png_stream.h"
+#include "../lvgl/lvgl_qoi.h"
 
-// WeatherAPI.com condition code to PNG file mapping
-// Maps weather conditions to day/night PNG icons (converted from SVG)
-// clang-format off
-const WeatherIcons::WeatherCondition WeatherIcons::weatherConditionMap[] = {
-    // Code  Description                Day Icon         Night Icon
-    {1000,  "Sunny",                   "day_1_1.png",   "night_1_1.png"},   // Sunny/Clear
-    {1003,  "Partly cloudy",           "day_1_2.png",   "night_1_2.png"},   // Partly cloudy
-    {1006,  "Cloudy",                  "day_1_3.png",   "night_1_3.png"},   // Cloudy
-    {1009,  "Overcast",                "day_1_3.png",   "night_1_3.png"},   // Overcast
-    {1030,  "Mist",                    "day_1_4.png",   "night_1_4.png"},   // Mist
-    {1063,  "Patchy rain possible",    "day_1_5.png",   "night_1_5.png"},   // Patchy rain possible
-    {1066,  "Patchy snow possible",    "day_1_5.png",   "night_1_5.png"},   // Patchy snow possible
-    {1069,  "Patchy sleet possible",   "day_1_6.png",   "night_1_6.png"},   // Patchy sleet possible
-    {1072,  "Patchy freezing drizzle", "day_1_7.png",   "night_1_7.png"},   // Patchy freezing drizzle
-    {1087,  "Thundery outbreaks",      "day_1_8.png",   "night_1_8.png"},   // Thundery outbreaks
-    {1114,  "Blowing snow",            "day_2_1.png",   "night_2_1.png"},   // Blowing snow
-    {1117,  "Blizzard",                "day_2_2.png",   "night_2_2.png"},   // Blizzard
-    {1135,  "Fog",                     "day_2_3.png",   "night_2_3.png"},   // Fog
-    {1147,  "Freezing fog",            "day_2_4.png",   "night_2_4.png"},   // Freezing fog
-    {1150,  "Patchy light drizzle",    "day_2_5.png",   "night_2_5.png"},   // Patchy light drizzle
-    {1153,  "Light drizzle",           "day_2_5.png",   "night_2_5.png"},   // Light drizzle
-    {1168,  "Freezing drizzle",        "day_2_6.png",   "night_2_6.png"},   // Freezing drizzle
-    {1171,  "Heavy freezing drizzle",  "day_2_7.png",   "night_2_7.png"},   // Heavy freezing drizzle
-    {1180,  "Patchy light rain",       "day_2_8.png",   "night_2_8.png"},   // Patchy light rain
-    {1183,  "Light rain",              "day_3_1.png",   "night_3_1.png"},   // Light rain
-    {1186,  "Moderate rain at times",  "day_3_2.png",   "night_3_2.png"},   // Moderate rain at times
-    {1189,  "Moderate rain",           "day_3_2.png",   "night_3_2.png"},   // Moderate rain
-    {1192,  "Heavy rain at times",     "day_3_3.png",   "night_3_3.png"},   // Heavy rain at times
-    {1195,  "Heavy rain",              "day_3_3.png",   "night_3_3.png"},   // Heavy rain
-    {1198,  "Light freezing rain",     "day_3_4.png",   "night_3_4.png"},   // Light freezing rain
-    {1201,  "Heavy freezing rain",     "day_3_4.png",   "night_3_4.png"},   // Heavy freezing rain
-    {1204,  "Light sleet",             "day_3_5.png",   "night_3_5.png"},   // Light sleet
-    {1207,  "Heavy sleet",             "day_3_5.png",   "night_3_5.png"},   // Heavy sleet
-    {1210,  "Patchy light snow",       "day_2_8.png",   "night_2_8.png"},   // Patchy light snow
-    {1213,  "Light snow",              "day_3_6.png",   "night_3_6.png"},   // Light snow
-    {1216,  "Patchy moderate snow",    "day_3_6.png",   "night_3_6.png"},   // Patchy moderate snow
-    {1219,  "Moderate snow",           "day_3_7.png",   "night_3_7.png"},   // Moderate snow
-    {1222,  "Patchy heavy snow",       "day_3_8.png",   "night_3_8.png"},   // Patchy heavy snow
-    {1225,  "Heavy snow",              "day_3_8.png",   "night_3_8.png"},   // Heavy snow
-    {1237,  "Ice pellets",             "day_4_1.png",   "night_4_1.png"},   // Ice pellets
-    {1240,  "Light rain shower",       "day_4_2.png",   "night_4_2.png"},   // Light rain shower
-    {1243,  "Heavy rain shower",       "day_4_3.png",   "night_4_3.png"},   // Heavy rain shower
-    {1246,  "Torrential rain shower",  "day_4_3.png",   "night_4_3.png"},   // Torrential rain shower
-    {1249,  "Light sleet shower",      "day_4_4.png",   "night_4_4.png"},   // Light sleet showers
-    {1252,  "Heavy sleet shower",      "day_4_4.png",   "night_4_4.png"},   // Heavy sleet showers
-    {1255,  "Light snow shower",       "day_4_5.png",   "night_4_5.png"},   // Light snow showers
-    {1258,  "Heavy snow shower",       "day_4_6.png",   "night_4_6.png"},   // Heavy snow showers
-    {1261,  "Light ice pellet shower", "day_4_7.png",   "night_4_7.png"},   // Light ice pellet showers
-    {1264,  "Heavy ice pellet shower", "day_4_7.png",   "night_4_7.png"},   // Heavy ice pellet showers
-    {1273,  "Light rain with thunder", "day_4_8.png",   "night_4_8.png"},   // Light rain with thunder
-    {1276,  "Heavy rain with thunder", "day_4_8.png",   "night_4_8.png"},   // Heavy rain with thunder
-    {1279,  "Light snow with thunder", "day_4_8.png",   "night_4_8.png"},   // Light snow with thunder
-    {1282,  "Heavy snow with thunder", "day_4_8.png",   "night_4_8.png"},   // Heavy snow with thunder
+// Drive prefix of the icon file paths, skipped by getPNGPath()
+#define ICON_DRIVE "S:"
+#define ICON_PATH(name, ext) ICON_DRIVE "/icons/" #name ext
+
+// WeatherAPI.com condition code to day/night icon mapping
+// Rows are generated from resources/weather_conditions.csv together with the
+// compiled images (resources/compile_icons.py, run before each build)
+#define WEATHER_ICON(name) \
+  {ICON_PATH(name, ".png"), ICON_PATH(name, ".bin"), ICON_PATH(name, ".qoi"), &weather_icon_##name, \
+   &weather_icon_opaque_##name, WEATHER_ICON_INDEX_##name}
+constexpr WeatherIcons::WeatherCondition WeatherIcons::weatherConditionMap[] = {
+#include "generated/weather_conditions.inc"
 };
-// clang-format on
+#undef WEATHER_ICON
 
 const int WeatherIcons::NUM_CONDITIONS = sizeof(weatherConditionMap) / sizeof(weatherConditionMap[0]);
 
+int WeatherIcons::iconSource = ICON_SOURCE;
+IconCache WeatherIcons::iconCache(ICON_CACHE_BYTES);
+
+// WeatherAPI.com condition codes, the range of the dense index
+#define CONDITION_CODE_MIN 1000
+#define CONDITION_CODE_MAX 1282
+#define CONDITION_NONE 0xFF
+
+// Map row per code in CONDITION_CODE_MIN..MAX, CONDITION_NONE for gaps
+struct ConditionIndex
+{
+  uint8_t row[CONDITION_CODE_MAX - CONDITION_CODE_MIN + 1];
+};
+
+template <typename Row, size_t N>
+constexpr bool codes_ascending(const Row (&rows)[N])
+{
+  for (size_t i = 1; i < N; i++)
+  {
+    if (rows[i].conditionCode <= rows[i - 1].conditionCode)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Row, size_t N>
+constexpr bool codes_in_range(const Row (&rows)[N])
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    if (rows[i].conditionCode < CONDITION_CODE_MIN || rows[i].conditionCode > CONDITION_CODE_MAX)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Row, size_t N>
+constexpr ConditionIndex build_condition_index(const Row (&rows)[N])
+{
+  ConditionIndex index = {};
+  for (size_t code = 0; code < sizeof(index.row); code++)
+  {
+    index.row[code] = CONDITION_NONE;
+  }
+  for (size_t i = 0; i < N; i++)
+  {
+    index.row[rows[i].conditionCode - CONDITION_CODE_MIN] = static_cast<uint8_t>(i);
+  }
+  return index;
+}
+
+int WeatherIcons::findConditionIndex(int conditionCode)
+{
+  // A duplicate code would silently shadow a row; a bad CSV fails the build
+  static_assert(codes_ascending(weatherConditionMap), "condition codes must be unique and ascending");
+  static_assert(codes_in_range(weatherConditionMap), "condition code outside 1000..1282");
+  static_assert(sizeof(weatherConditionMap) / sizeof(weatherConditionMap[0]) < CONDITION_NONE,
+                "too many conditions for a uint8_t index");
+
+  // Built by the compiler, 283 B in flash
+  static constexpr ConditionIndex index = build_condition_index(weatherConditionMap);
+
+  if (conditionCode < CONDITION_CODE_MIN || conditionCode > CONDITION_CODE_MAX)
+  {
+    return -1;
+  }
+
+  uint8_t row = index.row[conditionCode - CONDITION_CODE_MIN];
+  return row == CONDITION_NONE ? -1 : row;
+}
+
+// Condition entry by code, the first one (sunny) if the code is unknown
+const WeatherIcons::WeatherCondition &WeatherIcons::findCondition(int conditionCode)
+{
+  int row = findConditionIndex(conditionCode);
+  return weatherConditionMap[row < 0 ? 0 : row];
+}
+
 // Get PNG file path by condition code
-String WeatherIcons::getPNGPath(int conditionCode, bool isDaytime)
+const char *WeatherIcons::getPNGPath(int conditionCode, bool isDaytime)
+{
+  const WeatherCondition &condition = findCondition(conditionCode);
+  const char *path = isDaytime ? condition.day.png_path : condition.night.png_path;
+  return path + sizeof(ICON_DRIVE) - 1;
+}
+
+void WeatherIcons::setIconSource(int source)
+{
+  iconSource = source;
+}
+
+int WeatherIcons::getIconSource()
+{
+  return iconSource;
+}
+
+IconCache &WeatherIcons::getIconCache()
+{
+  return iconCache;
+}
+
+int WeatherIcons::getConditionCount()
+{
+  return NUM_CONDITIONS;
+}
+
+int WeatherIcons::getConditionCode(int index)
+{
+  return weatherConditionMap[index].conditionCode;
+}
+
+const char *WeatherIcons::getIconSourceName(int source)
+{
+  switch (source)
+  {
+  case ICON_SOURCE_PNG:
+    return "png";
+  case ICON_SOURCE_BIN:
+    return "bin";
+  case ICON_SOURCE_COMPILED:
+    return "compiled";
+  case ICON_SOURCE_ATLAS:
+    return "atlas";
+  case ICON_SOURCE_ASSETS:
+    return "assets";
+  case ICON_SOURCE_QOI:
+    return "qoi";
+  case ICON_SOURCE_OPAQUE:
+    return "opaque";
+  default:
+    return "unknown";
+  }
+}
+
+// One load or map attempt per atlas source
+IconAtlas *WeatherIcons::getAtlas(int source)
+{
+  static IconAtlas *loaded = nullptr;
+  static IconAtlas *mapped = nullptr;
+  static bool load_attempted = false;
+  static bool map_attempted = false;
+
+  if (source == ICON_SOURCE_ATLAS)
+  {
+    if (!load_attempted)
+    {
+      load_attempted = true;
+      loaded = lvgl_fs_atlas_load(ICON_ATLAS_PATH, ICON_ATLAS_DRIVE);
+    }
+    return loaded;
+  }
+  if (source == ICON_SOURCE_ASSETS)
+  {
+    if (!map_attempted)
+    {
+      map_attempted = true;
+      mapped = lvgl_fs_atlas_map(ICON_ASSETS_PARTITION, ICON_ASSETS_DRIVE);
+    }
+    return mapped;
+  }
+  return nullptr;
+}
+
+// Icon set of `size` compiled into flash, nullptr if there is none
+static const weather_icon_set_t *find_icon_set(int size)
 {
-  // Search for the condition code in our mapping
-  for (int i = 0; i < NUM_CONDITIONS; i++)
+  for (int i = 0; i < WEATHER_ICON_SET_COUNT; i++)
   {
-    if (weatherConditionMap[i].conditionCode == conditionCode)
+    if (weather_icon_sets[i].size == size && weather_icon_sets[i].images != nullptr)
     {
-      const char *filename = isDaytime ? weatherConditionMap[i].dayIcon : weatherConditionMap[i].nightIcon;
-      return String("/icons/") + filename;
+      return &weather_icon_sets[i];
     }
   }
+  return nullptr;
+}
 
-  // Default to sunny icon if condition not found
-  return isDaytime ? "/icons/day_1_1.png" : "/icons/night_1_1.png";
+int WeatherIcons::getIconSize(lv_obj_t *iconWidget)
+{
+  if (iconSource != ICON_SOURCE_COMPILED && iconSource != ICON_SOURCE_OPAQUE)
+  {
+    return WEATHER_ICON_SIZE;
+  }
+
+  // The box as the layout sets it, so no layout pass is needed
+  int32_t w = lv_obj_get_style_width(iconWidget, LV_PART_MAIN);
+  int32_t h = lv_obj_get_style_height(iconWidget, LV_PART_MAIN);
+  if (!LV_COORD_IS_PX(w) || !LV_COORD_IS_PX(h))
+  {
+    return WEATHER_ICON_SIZE;
+  }
+  w -= lv_obj_get_style_pad_left(iconWidget, LV_PART_MAIN) + lv_obj_get_style_pad_right(iconWidget, LV_PART_MAIN);
+  h -= lv_obj_get_style_pad_top(iconWidget, LV_PART_MAIN) + lv_obj_get_style_pad_bottom(iconWidget, LV_PART_MAIN);
+  int32_t box = w < h ? w : h;
+
+  // Sets are ordered smallest first
+  int size = 0;
+  for (int i = 0; i < WEATHER_ICON_SET_COUNT; i++)
+  {
+    const weather_icon_set_t &set = weather_icon_sets[i];
+    if (set.images != nullptr && (size == 0 || set.size <= box))
+    {
+      size = set.size;
+    }
+  }
+  return size;
 }
 
-// Get condition description by code
-const char *WeatherIcons::getConditionDisplayName(int conditionCode)
+// lv_image_set_src() argument: descriptor in flash or over an atlas entry,
+// cached decoded image in PSRAM, or "S:/icons/<name>.<ext>"
+const void *WeatherIcons::getIconSrc(int conditionCode, bool isDaytime, int size)
 {
-  // Search for the condition code in our mapping
-  for (int i = 0; i < NUM_CONDITIONS; i++)
+  const WeatherCondition &condition = findCondition(conditionCode);
+  const Icon &icon = isDaytime ? condition.day : condition.night;
+
+  const weather_icon_set_t *set = size != WEATHER_ICON_SIZE ? find_icon_set(size) : nullptr;
+  if (iconSource == ICON_SOURCE_COMPILED)
   {
-    if (weatherConditionMap[i].conditionCode == conditionCode)
+    return set != nullptr ? set->images[icon.index] : icon.image;
+  }
+  if (iconSource == ICON_SOURCE_OPAQUE)
+  {
+    return set != nullptr ? set->opaque[icon.index] : icon.opaque;
+  }
+
+  // File paths are literals in flash; the atlas path is built into a static
+  // buffer, as LVGL needs the string to remain valid after the function returns
+  static char atlas_buffers[5][16]; // Support up to 5 concurrent images
+  static int buffer_index = 0;
+
+  const char *path = icon.png_path;
+  if (iconSource == ICON_SOURCE_BIN)
+  {
+    path = icon.bin_path;
+  }
+  else if (iconSource == ICON_SOURCE_QOI)
+  {
+    path = icon.qoi_path;
+  }
+  IconAtlas *atlas = getAtlas(iconSource);
+  const IconAtlasEntry *entry = lvgl_fs_atlas_entry(atlas, icon.index);
+  if (entry != nullptr)
+  {
+    // Undecoded entries are drawn in place, without a copy
+    if (entry->format == ICON_ATLAS_FORMAT_BIN)
     {
-      return weatherConditionMap[i].description;
+      return lvgl_fs_atlas_image(atlas, icon.index);
     }
+
+    // Cycle through buffers
+    buffer_index = (buffer_index + 1) % 5;
+    lvgl_fs_atlas_src(atlas, icon.index, atlas_buffers[buffer_index], sizeof(atlas_buffers[buffer_index]));
+    path = atlas_buffers[buffer_index];
   }
 
-  return "Unknown";
+  // Decoded once, then drawn from PSRAM; the PNG files stand in for a missing atlas
+  const lv_image_dsc_t *cached = iconCache.get(path);
+  if (cached != nullptr)
+  {
+    return cached;
+  }
+  return path;
 }
 
-// Update weather icon widget with PNG (using LODEPNG decoder)
-void WeatherIcons::updateWeatherIcon(lv_obj_t *iconWidget, int conditionCode, bool isDaytime)
+// Get condition description by code
+const char *WeatherIcons::getConditionDisplayName(int conditionCode)
 {
-  if (iconWidget == nullptr)
+  int row = findConditionIndex(conditionCode);
+  if (row >= 0)
   {
-    return;
+    return weatherConditionMap[row].description;
   }
 
-  // Get the PNG file path for this condition
-  String pngPath = getPNGPath(conditionCode, isDaytime);
+  return "Unknown";
+}
 
-  // Look for existing image child, or create new one
-  lv_obj_t *img = nullptr;
+// Image child of an icon widget, nullptr if none
+static lv_obj_t *find_image(lv_obj_t *iconWidget)
+{
   uint32_t child_count = lv_obj_get_child_count(iconWidget);
-
-  // Try to find existing image object
   for (uint32_t i = 0; i < child_count; i++)
   {
     lv_obj_t *child = lv_obj_get_child(iconWidget, i);
     if (lv_obj_check_type(child, &lv_image_class))
     {
-      img = child;
-      break;
+      return child;
     }
   }
+  return nullptr;
+}
+
+// Update weather icon widget from the configured icon source
+void WeatherIcons::updateWeatherIcon(lv_obj_t *iconWidget, int conditionCode, bool isDaytime)
+{
+  if (iconWidget == nullptr)
+  {
+    return;
+  }
+
+  // Only sets the source; files are decoded at render time (LVGL decoder spans)
+  TRACE_SCOPE("icon_load");
+
+  // Look for existing image child, or create new one
+  lv_obj_t *img = find_image(iconWidget);
 
   // Create new image if none exists
   if (img == nullptr)
@@ -133,24 +348,472 @@ void WeatherIcons::updateWeatherIcon(lv_obj_t *iconWidget, int conditionCode, bo
       return;
     }
 
-    // Initial setup for new image
-    lv_obj_set_size(img, 64, 64);
+    // Initial setup for new image; sized to its source, which is drawn
+    // unscaled (getIconSize picks the set for the box)
     lv_obj_center(img);
     lv_obj_clear_flag(img, LV_OBJ_FLAG_HIDDEN);
   }
 
-  // Use static buffer to ensure path persists in memory
-  // LVGL needs the string to remain valid after the function returns
-  static char path_buffers[5][64]; // Support up to 5 concurrent images
-  static int buffer_index = 0;
+  // Set the image source (PNG via LODEPNG, QOI via lvgl_qoi, .bin and compiled via LVGL's bin decoder)
+  lv_image_set_src(img, getIconSrc(conditionCode, isDaytime, getIconSize(iconWidget)));
+}
+
+// LVGL's heap only keeps an all-time maximum. Allocate the difference to the
+// current usage, so that any later growth of the maximum is the peak of the
+// measured work. Returns nullptr if the heap is too fragmented.
+static void *raise_heap_to_max(uint32_t *max_used)
+{
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  size_t used = mon.total_size - mon.free_size;
+  void *ballast = mon.max_used > used ? lv_malloc(mon.max_used - used) : lv_malloc(1);
+
+  lv_mem_monitor(&mon);
+  *max_used = mon.max_used;
+  return ballast;
+}
+
+static bool icon_file_exists(const char *path)
+{
+  lv_fs_file_t file;
+  if (lv_fs_open(&file, path, LV_FS_MODE_RD) != LV_FS_RES_OK)
+  {
+    return false;
+  }
+  lv_fs_close(&file);
+  return true;
+}
+
+void WeatherIcons::benchmarkSources(lv_obj_t *iconWidget, uint32_t switches)
+{
+  if (iconWidget == nullptr || switches == 0)
+  {
+    return;
+  }
+
+  int saved_source = iconSource;
+
+  for (int source = ICON_SOURCE_PNG; source <= ICON_SOURCE_OPAQUE; source++)
+  {
+    if (source == ICON_SOURCE_BIN && !icon_file_exists("S:/icons/day_1_1.bin"))
+    {
+      LOG_INFO("Icons bin     : skipped, no .bin files (resources/compile_icons.py --bin)");
+      continue;
+    }
+    if (source == ICON_SOURCE_ATLAS && getAtlas(source) == nullptr)
+    {
+      LOG_INFO("Icons atlas   : skipped, no " ICON_ATLAS_PATH " (resources/compile_icons.py)");
+      continue;
+    }
+    if (source == ICON_SOURCE_QOI && !icon_file_exists("S:/icons/day_1_1.qoi"))
+    {
+      LOG_INFO("Icons qoi     : skipped, no .qoi files (resources/compile_icons.py, then uploadfs)");
+      continue;
+    }
+    if (source == ICON_SOURCE_ASSETS && getAtlas(source) == nullptr)
+    {
+      LOG_INFO("Icons assets  : skipped, no " ICON_ASSETS_PARTITION " partition image (pio run --target upload)");
+      continue;
+    }
+
+    iconSource = source;
+    lv_refr_now(NULL);
+
+    uint32_t max_before = 0;
+    void *ballast = raise_heap_to_max(&max_before);
+
+    uint32_t total_us = 0;
+    uint32_t max_us = 0;
+    for (uint32_t i = 0; i < switches; i++)
+    {
+      // Alternate day/night so every switch changes the image
+      const WeatherCondition &condition = weatherConditionMap[i % NUM_CONDITIONS];
+      unsigned long start = micros();
+      updateWeatherIcon(iconWidget, condition.conditionCode, (i & 1) == 0);
+      lv_refr_now(NULL);
+      uint32_t elapsed = micros() - start;
+
+      total_us += elapsed;
+      if (elapsed > max_us)
+      {
+        max_us = elapsed;
+      }
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    if (ballast != nullptr)
+    {
+      lv_free(ballast);
+      LOG_INFOF("Icons %-8s: %lu switches, avg %lu us, max %lu us, heap peak +%lu B\n",
+                getIconSourceName(source), (unsigned long)switches, (unsigned long)(total_us / switches),
+                (unsigned long)max_us, (unsigned long)(mon.max_used - max_before));
+    }
+    else
+    {
+      LOG_INFOF("Icons %-8s: %lu switches, avg %lu us, max %lu us, heap peak n/a\n",
+                getIconSourceName(source), (unsigned long)switches, (unsigned long)(total_us / switches),
+                (unsigned long)max_us);
+    }
+  }
+
+  iconSource = saved_source;
+}
+
+// Decode `path` into `out` (ARGB8888, `size` bytes) and add the decoder's
+// heap use besides a full-size output image to `*working`. Streamed images
+// are read strip by strip; the time excludes copying full images out.
+static bool decode_timed(const char *path, uint8_t *out, uint32_t size, uint32_t *us, uint32_t *working)
+{
+  lvgl_png_stream_release();
+  uint32_t max_before = 0;
+  void *ballast = raise_heap_to_max(&max_before);
+
+  lv_image_decoder_dsc_t dsc;
+  unsigned long start = micros();
+  bool opened = lv_image_decoder_open(&dsc, path, NULL) == LV_RESULT_OK;
+  uint32_t row_bytes = opened ? dsc.header.w * 4 : 0;
+  bool ok = opened && dsc.header.cf == LV_COLOR_FORMAT_ARGB8888 && row_bytes * dsc.header.h == size;
+  if (ok && dsc.decoded == nullptr)
+  {
+    ok = lvgl_png_stream_read(&dsc, out, row_bytes);
+  }
+  *us = micros() - start;
+
+  uint32_t output = 0;
+  if (ok && dsc.decoded != nullptr)
+  {
+    output = dsc.decoded->data_size;
+    for (uint32_t y = 0; y < dsc.header.h; y++)
+    {
+      memcpy(out + y * row_bytes, dsc.decoded->data + y * dsc.decoded->header.stride, row_bytes);
+    }
+  }
+
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  if (opened)
+  {
+    lv_image_decoder_close(&dsc);
+  }
+  lv_free(ballast);
+
+  uint32_t peak = mon.max_used - max_before;
+  if (ok && ballast != nullptr && peak > output && peak - output > *working)
+  {
+    *working = peak - output;
+  }
+  return ok;
+}
+
+static uint32_t icon_file_size(const char *path)
+{
+  lv_fs_file_t file;
+  uint32_t size = 0;
+  if (lv_fs_open(&file, path, LV_FS_MODE_RD) == LV_FS_RES_OK)
+  {
+    lv_fs_seek(&file, 0, LV_FS_SEEK_END);
+    lv_fs_tell(&file, &size);
+    lv_fs_close(&file);
+  }
+  return size;
+}
+
+// Totals of one codec over all icons
+struct CodecRun
+{
+  const char *name;
+  const char *ext;
+  bool stream; // PNG decoded by lvgl_png_stream instead of LODEPNG
+  uint32_t bytes;
+  uint32_t us;
+  uint32_t max_us;
+  uint32_t working;
+};
+
+bool WeatherIcons::benchmarkCodecs()
+{
+  char path[ICON_CACHE_PATH_LEN];
+  CodecRun runs[] = {
+    {"png", "png", false, 0, 0, 0, 0},
+    {"png-stream", "png", true, 0, 0, 0, 0},
+    {"qoi", "qoi", false, 0, 0, 0, 0},
+  };
+  uint32_t count = sizeof(runs) / sizeof(runs[0]);
+
+  if (!icon_file_exists("S:/icons/day_1_1.qoi"))
+  {
+    LOG_INFO("Codec qoi: skipped, no .qoi files (resources/compile_icons.py, then uploadfs)");
+    count--;
+  }
+
+  bool stream_enabled = lvgl_png_stream_get_enabled();
+  bool ok = true;
+  for (uint32_t i = 0; i < WEATHER_ICON_COUNT && ok; i++)
+  {
+    snprintf(path, sizeof(path), ICON_DRIVE "/icons/%s.png", weather_icon_names[i]);
+    lv_image_header_t header;
+    if (lv_image_decoder_get_info(path, &header) != LV_RESULT_OK)
+    {
+      LOG_ERRORF("Codecs: %s not found\n", path);
+      ok = false;
+      break;
+    }
 
-  // Cycle through buffers
-  buffer_index = (buffer_index + 1) % 5;
+    // LODEPNG output is the reference; buffers are allocated before the
+    // heap is measured
+    uint32_t size = header.w * header.h * 4;
+    uint8_t *reference = static_cast<uint8_t *>(lv_malloc(size));
+    uint8_t *pixels = static_cast<uint8_t *>(lv_malloc(size));
+    for (uint32_t r = 0; r < count && ok && reference != nullptr && pixels != nullptr; r++)
+    {
+      CodecRun &run = runs[r];
+      snprintf(path, sizeof(path), ICON_DRIVE "/icons/%s.%s", weather_icon_names[i], run.ext);
+      run.bytes += icon_file_size(path);
+
+      lvgl_png_stream_set_enabled(run.stream);
+      uint32_t us = 0;
+      ok = decode_timed(path, r == 0 ? reference : pixels, size, &us, &run.working);
+      if (!ok)
+      {
+        LOG_ERRORF("Codec %s: %s not decoded\n", run.name, path);
+      }
+      else if (r > 0 && memcmp(reference, pixels, size) != 0)
+      {
+        LOG_ERRORF("Codec %s: %s differs from LODEPNG\n", run.name, path);
+        ok = false;
+      }
+      run.us += us;
+      run.max_us = us > run.max_us ? us : run.max_us;
+    }
+    if (reference == nullptr || pixels == nullptr)
+    {
+      LOG_ERROR("Codecs: out of memory");
+      ok = false;
+    }
+    lv_free(pixels);
+    lv_free(reference);
+  }
+  lvgl_png_stream_set_enabled(stream_enabled);
+
+  if (!ok)
+  {
+    return false;
+  }
+
+  for (uint32_t r = 0; r < count; r++)
+  {
+    const CodecRun &run = runs[r];
+    LOG_INFOF("Codec %-10s: %lu icons, %6lu B, decode avg %5lu us, max %5lu us, working heap %6lu B%s\n", run.name,
+              (unsigned long)WEATHER_ICON_COUNT, (unsigned long)run.bytes,
+              (unsigned long)(run.us / WEATHER_ICON_COUNT), (unsigned long)run.max_us, (unsigned long)run.working,
+              r == 0 ? "" : ", pixels identical");
+  }
+  LOG_INFOF("Codec qoi decoder besides the output: %u B on the stack\n", (unsigned)QOI_WORKING_BYTES);
+  return true;
+}
+
+// Largest difference of the 5/6/5-bit channels of two RGB565 pixels
+static uint32_t rgb565_diff(uint16_t a, uint16_t b)
+{
+  int dr = abs((a >> 11) - (b >> 11));
+  int dg = abs(((a >> 5) & 0x3F) - ((b >> 5) & 0x3F));
+  int db = abs((a & 0x1F) - (b & 0x1F));
+  int d = dr > dg ? dr : dg;
+  return d > db ? d : db;
+}
+
+// Average time of `draws` redraws of the icon widget
+static uint32_t redraw_timed(lv_obj_t *iconWidget, uint32_t draws)
+{
+  uint32_t total_us = 0;
+  for (uint32_t i = 0; i < draws; i++)
+  {
+    unsigned long start = micros();
+    lv_obj_invalidate(iconWidget);
+    lv_refr_now(NULL);
+    total_us += micros() - start;
+  }
+  return total_us / draws;
+}
+
+bool WeatherIcons::benchmarkOpaque(lv_obj_t *iconWidget, uint32_t draws)
+{
+  // LVGL's own blend of the alpha icons on the card color is the reference
+  lv_draw_buf_t *buf = lv_draw_buf_create(WEATHER_ICON_SIZE, WEATHER_ICON_SIZE, LV_COLOR_FORMAT_RGB565, LV_STRIDE_AUTO);
+  lv_obj_t *canvas = buf != nullptr ? lv_canvas_create(lv_layer_top()) : nullptr;
+  if (canvas == nullptr)
+  {
+    LOG_ERROR("Opaque icons: out of memory");
+    lv_draw_buf_destroy(buf);
+    return false;
+  }
+  lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+  lv_canvas_set_draw_buf(canvas, buf);
+
+  const lv_area_t area = {0, 0, WEATHER_ICON_SIZE - 1, WEATHER_ICON_SIZE - 1};
+  uint32_t blend_us[2] = {0, 0};
+  uint32_t exact = 0;
+  uint32_t max_diff = 0;
+  for (uint32_t i = 0; i < WEATHER_ICON_COUNT; i++)
+  {
+    const lv_image_dsc_t *opaque = weather_icon_opaque_images[i];
+    // Alpha last, so the canvas holds its blend for the comparison
+    for (int variant = 1; variant >= 0; variant--)
+    {
+      lv_canvas_fill_bg(canvas, lv_color_hex(WEATHER_ICON_OPAQUE_BG), LV_OPA_COVER);
+      lv_layer_t layer;
+      lv_canvas_init_layer(canvas, &layer);
+      lv_draw_image_dsc_t dsc;
+      lv_draw_image_dsc_init(&dsc);
+      dsc.src = variant == 0 ? weather_icon_images[i] : opaque;
+
+      unsigned long start = micros();
+      lv_draw_image(&layer, &dsc, &area);
+      lv_canvas_finish_layer(canvas, &layer);
+      blend_us[variant] += micros() - start;
+    }
+
+    for (uint32_t y = 0; y < WEATHER_ICON_SIZE; y++)
+    {
+      const uint16_t *drawn = reinterpret_cast<const uint16_t *>(buf->data + y * buf->header.stride);
+      const uint16_t *stored = reinterpret_cast<const uint16_t *>(opaque->data + y * opaque->header.stride);
+      for (uint32_t x = 0; x < WEATHER_ICON_SIZE; x++)
+      {
+        uint32_t diff = rgb565_diff(drawn[x], stored[x]);
+        exact += diff == 0;
+        max_diff = diff > max_diff ? diff : max_diff;
+      }
+    }
+  }
+  lv_obj_delete(canvas);
+  lv_draw_buf_destroy(buf);
 
-  // Build path with filesystem prefix
-  snprintf(path_buffers[buffer_index], sizeof(path_buffers[buffer_index]),
-           "S:%s", pngPath.c_str());
+  uint32_t pixels = WEATHER_ICON_COUNT * WEATHER_ICON_SIZE * WEATHER_ICON_SIZE;
+  LOG_INFOF("Opaque icons: %lu of %lu pixels as LVGL blends them on 0x%06x, max diff %lu LSB\n",
+            (unsigned long)exact, (unsigned long)pixels, (unsigned)WEATHER_ICON_OPAQUE_BG, (unsigned long)max_diff);
+  // One step of rounding is invisible; more means the tool's blend is wrong
+  if (max_diff > 1)
+  {
+    LOG_ERROR("Opaque icons differ from the alpha icons on the card");
+    return false;
+  }
+
+  // Redraws of the icon area on screen: card background from the static
+  // layer (or redrawn) plus the icon
+  uint32_t redraw_us[2] = {0, 0};
+  int saved_source = iconSource;
+  if (iconWidget != nullptr && draws > 0)
+  {
+    const int sources[2] = {ICON_SOURCE_COMPILED, ICON_SOURCE_OPAQUE};
+    for (int variant = 0; variant < 2; variant++)
+    {
+      iconSource = sources[variant];
+      updateWeatherIcon(iconWidget, weatherConditionMap[0].conditionCode, true);
+      lv_refr_now(NULL);
+      redraw_us[variant] = redraw_timed(iconWidget, draws);
+    }
+    iconSource = saved_source;
+  }
+
+  const char *names[2] = {"alpha", "opaque"};
+  for (int variant = 0; variant < 2; variant++)
+  {
+    LOG_INFOF("Icon draw %-6s: blend avg %4lu us over %lu icons, redraw avg %5lu us over %lu draws\n",
+              names[variant], (unsigned long)(blend_us[variant] / WEATHER_ICON_COUNT),
+              (unsigned long)WEATHER_ICON_COUNT, (unsigned long)redraw_us[variant], (unsigned long)draws);
+  }
+  return true;
+}
+
+bool WeatherIcons::checkIconSets(lv_obj_t *iconWidget, uint32_t draws)
+{
+  bool ok = true;
+  uint32_t checked = 0;
+  for (int s = 0; s < WEATHER_ICON_SET_COUNT; s++)
+  {
+    const weather_icon_set_t &set = weather_icon_sets[s];
+    if (set.images == nullptr)
+    {
+      if (WEATHER_ICON_ALL_SETS)
+      {
+        LOG_ERRORF("Icon set %u: not compiled\n", (unsigned)set.size);
+        ok = false;
+      }
+      else
+      {
+        LOG_INFOF("Icon set %u: skipped, not in flash (WEATHER_ICON_ALL_SETS)\n", (unsigned)set.size);
+      }
+      continue;
+    }
+
+    for (int i = 0; i < NUM_CONDITIONS; i++)
+    {
+      const WeatherCondition &condition = weatherConditionMap[i];
+      const Icon *icons[2] = {&condition.day, &condition.night};
+      for (const Icon *icon : icons)
+      {
+        const lv_image_dsc_t *images[2] = {set.images[icon->index], set.opaque[icon->index]};
+        for (const lv_image_dsc_t *image : images)
+        {
+          checked++;
+          if (image == nullptr || image->header.w != set.size || image->header.h != set.size)
+          {
+            LOG_ERRORF("Icon set %u: condition %d has no %ux%u %s\n", (unsigned)set.size, condition.conditionCode,
+                       (unsigned)set.size, (unsigned)set.size, weather_icon_names[icon->index]);
+            ok = false;
+          }
+        }
+      }
+    }
+  }
+  LOG_INFOF("Icon sets: %lu images checked for %d conditions, %s\n", (unsigned long)checked, NUM_CONDITIONS,
+            ok ? "all present" : "some missing");
+  if (!ok || iconWidget == nullptr || draws == 0)
+  {
+    return ok;
+  }
+
+  // Each set in a box of its size, from both flash sources
+  int saved_source = iconSource;
+  int32_t saved_w = lv_obj_get_style_width(iconWidget, LV_PART_MAIN);
+  int32_t saved_h = lv_obj_get_style_height(iconWidget, LV_PART_MAIN);
+  const int sources[2] = {ICON_SOURCE_COMPILED, ICON_SOURCE_OPAQUE};
+  for (int s = 0; s < WEATHER_ICON_SET_COUNT && ok; s++)
+  {
+    const weather_icon_set_t &set = weather_icon_sets[s];
+    if (set.images == nullptr)
+    {
+      continue;
+    }
+
+    lv_obj_set_size(iconWidget, set.size, set.size);
+    uint32_t redraw_us[2] = {0, 0};
+    for (int variant = 0; variant < 2 && ok; variant++)
+    {
+      iconSource = sources[variant];
+      updateWeatherIcon(iconWidget, weatherConditionMap[0].conditionCode, true);
+      lv_refr_now(NULL);
+
+      lv_obj_t *img = find_image(iconWidget);
+      if (getIconSize(iconWidget) != set.size || img == nullptr || lv_image_get_src_width(img) != set.size ||
+          lv_obj_get_width(img) != set.size || lv_image_get_scale(img) != LV_SCALE_NONE)
+      {
+        LOG_ERRORF("Icon set %u: %s icon not drawn at its size\n", (unsigned)set.size,
+                   getIconSourceName(iconSource));
+        ok = false;
+        break;
+      }
+      redraw_us[variant] = redraw_timed(iconWidget, draws);
+    }
+    if (ok)
+    {
+      LOG_INFOF("Icon set %2u: redraw avg %5lu us alpha, %5lu us opaque over %lu draws\n", (unsigned)set.size,
+                (unsigned long)redraw_us[0], (unsigned long)redraw_us[1], (unsigned long)draws);
+    }
+  }
 
-  // Set the image source (LVGL will decode PNG automatically via LODEPNG)
-  lv_image_set_src(img, path_buffers[buffer_index]);
+  lv_obj_set_size(iconWidget, saved_w, saved_h);
+  iconSource = saved_source;
+  return ok;
 }
@@ -2,15 +2,39 @@
 #define WEATHER_ICONS_H
 
 #include <lvgl.h>
-#include <WString.h>
 
-// Weather icons utility class for PNG weather icons
-// WeatherAPI.com integration with LVGL PNG rendering via LODEPNG
+// Project headers
+#include "icon_cache.h"
+#include "../lvgl/lvgl_fs_atlas.h"
+
+// Weather icons utility class
+// WeatherAPI.com condition codes to day/night icons; the map is generated
+// from resources/weather_conditions.csv
 class WeatherIcons
 {
 public:
-  // Get PNG file path for a weather condition code
-  static String getPNGPath(int conditionCode, bool isDaytime = true);
+  // Get PNG file path for a weather condition code ("/icons/<name>.png",
+  // stored in flash)
+  static const char *getPNGPath(int conditionCode, bool isDaytime = true);
+
+  // Where updateWeatherIcon() takes the images from (default ICON_SOURCE)
+  static void setIconSource(int source);
+  static int getIconSource();
+  static const char *getIconSourceName(int source);
+
+  // Atlas of ICON_SOURCE_ATLAS or ICON_SOURCE_ASSETS, loaded or mapped on
+  // first use; nullptr if unavailable or not an atlas source
+  static IconAtlas *getAtlas(int source);
+
+  // Decoded images of the file sources (budget ICON_CACHE_BYTES)
+  static IconCache &getIconCache();
+
+  // Conditions in the map, for iterating over all icons
+  static int getConditionCount();
+  static int getConditionCode(int index);
+
+  // Row of `conditionCode` in the map, -1 if unknown (constant time)
+  static int findConditionIndex(int conditionCode);
 
   // Get display name for weather condition code
   static const char *getConditionDisplayName(int conditionCode);
@@ -18,18 +42,59 @@ public:
   // Update existing weather icon widget with PNG image
   static void updateWeatherIcon(lv_obj_t *iconWidget, int conditionCode, bool isDaytime = true);
 
+  // Icon size updateWeatherIcon() draws in `iconWidget`: the largest set in
+  // flash that fits the widget's content box (the smallest if none does), or
+  // WEATHER_ICON_SIZE for the file and atlas sources, which hold only that set
+  static int getIconSize(lv_obj_t *iconWidget);
+
+  // Time `switches` icon changes (set source + render) per icon source and
+  // log latency and LVGL heap peak; restores the source, not the icon
+  static void benchmarkSources(lv_obj_t *iconWidget, uint32_t switches);
+
+  // Decode every icon from data/icons as PNG (LODEPNG and streamed) and as
+  // QOI: log file size, decode time and decoder heap besides a full-size
+  // output per codec; false if an image differs from LODEPNG's
+  static bool benchmarkCodecs();
+
+  // Check that every opaque icon matches its alpha icon drawn by LVGL on the
+  // card color, then time the blend of each variant and `draws` redraws of
+  // `iconWidget`; false on a mismatch
+  static bool benchmarkOpaque(lv_obj_t *iconWidget, uint32_t draws);
+
+  // Check that every condition has its day and night icon in every set at
+  // the set's size, then draw each set in a box of its size and check that
+  // it is shown unscaled, logging `draws` redraws; restores the widget size
+  // and source, not the icon. Sets left out of flash are skipped unless
+  // WEATHER_ICON_ALL_SETS. False on a missing or mis-sized icon.
+  static bool checkIconSets(lv_obj_t *iconWidget, uint32_t draws);
+
 private:
   // Internal mapping structure
+  struct Icon
+  {
+    const char *png_path; // "S:/icons/<name>.png"
+    const char *bin_path; // "S:/icons/<name>.bin"
+    const char *qoi_path; // "S:/icons/<name>.qoi"
+    const lv_image_dsc_t *image;  // RGB565A8
+    const lv_image_dsc_t *opaque; // RGB565 on the card color
+    uint16_t index; // WEATHER_ICON_INDEX_*: in the atlas and the icon sets
+  };
+
   struct WeatherCondition
   {
     int conditionCode;
     const char *description;
-    const char *dayIcon;
-    const char *nightIcon;
+    Icon day;
+    Icon night;
   };
 
   static const WeatherCondition weatherConditionMap[];
   static const int NUM_CONDITIONS;
+  static int iconSource;
+  static IconCache iconCache;
+
+  static const WeatherCondition &findCondition(int conditionCode);
+  static const void *getIconSrc(int conditionCode, bool isDaytime, int size);
 };
 
 #endif // WEATHER_ICONS_H
@@ -0,0 +1,523 @@
+// Own header
+#include "forecast_parser.h"
+
+#include <ctype.h>
+#include <string.h>
+
+// Values and objects the parser looks for
+#define FIELD_TEMPERATURE 0x01
+#define FIELD_HUMIDITY 0x02
+#define FIELD_CONDITION 0x04
+#define FIELD_PM25 0x08
+#define FIELD_US_EPA 0x10
+#define FIELD_TEMP_HIGH 0x20
+#define FIELD_TEMP_LOW 0x40
+#define FIELDS_ALL 0x7F
+#define OBJECT_CURRENT 0x80
+#define OBJECT_TODAY 0x100
+
+#define PATH_ROOT 2166136261u
+
+// Mantissa digits kept; further digits only scale the exponent
+#define MANTISSA_LIMIT 100000000000000000ull
+
+// Number parts: after the sign, a lone leading '0', integer digits, '.',
+// fraction digits, 'e', exponent sign, exponent digits
+#define NUMBER_SIGN 0
+#define NUMBER_ZERO 1
+#define NUMBER_INTEGER 2
+#define NUMBER_POINT 3
+#define NUMBER_FRACTION 4
+#define NUMBER_E 5
+#define NUMBER_EXP_SIGN 6
+#define NUMBER_EXPONENT 7
+
+ForecastParser::ForecastParser(WeatherData &out) : out(out)
+{
+}
+
+bool ForecastParser::feed(const uint8_t *data, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    if (!step(data[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ForecastParser::succeeded() const
+{
+  if (state == INVALID)
+  {
+    return false;
+  }
+  if ((found & FIELDS_ALL) == FIELDS_ALL)
+  {
+    return true;
+  }
+  return state == FINISHED && (found & (OBJECT_CURRENT | OBJECT_TODAY)) == (OBJECT_CURRENT | OBJECT_TODAY);
+}
+
+bool ForecastParser::stoppedEarly() const
+{
+  return state == FINISHED && depth > 0;
+}
+
+const char *ForecastParser::getError() const
+{
+  if (state == INVALID)
+  {
+    return error;
+  }
+  if (succeeded())
+  {
+    return "Ok";
+  }
+  if (state == FINISHED)
+  {
+    return "NoCurrentOrForecast";
+  }
+  return state == EXPECT_VALUE && depth == 0 ? "EmptyInput" : "IncompleteInput";
+}
+
+bool ForecastParser::step(uint8_t c)
+{
+  switch (state)
+  {
+  case IN_STRING:
+    if (hex_left > 0)
+    {
+      if (!isxdigit(c))
+      {
+        return fail("InvalidInput");
+      }
+      unicode = (unicode << 4) | (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+      if (--hex_left == 0 && key_string)
+      {
+        hashUnicode();
+      }
+      return true;
+    }
+    if (c == '"')
+    {
+      if (key_string)
+      {
+        state = EXPECT_COLON;
+      }
+      else
+      {
+        endValue();
+      }
+      return state != FINISHED;
+    }
+    if (c == '\\')
+    {
+      state = IN_STRING_ESCAPE;
+      return true;
+    }
+    if (c < 0x20)
+    {
+      return fail("InvalidInput"); // Control characters must be escaped
+    }
+    if (key_string)
+    {
+      value_path = forecast_hash_char(value_path, c);
+    }
+    return true;
+
+  case IN_STRING_ESCAPE:
+  {
+    // Pairs of escape letter and character; keys are hashed as decoded, as
+    // ArduinoJson compares them
+    static const char escapes[] = "\"\"\\\\//b\bf\fn\nr\rt\t";
+    state = IN_STRING;
+    if (c == 'u')
+    {
+      hex_left = 4;
+      unicode = 0;
+      return true;
+    }
+    const char *escape = c == '\0' ? nullptr : strchr(escapes, c);
+    if (escape == nullptr || (escape - escapes) % 2 != 0)
+    {
+      return fail("InvalidInput");
+    }
+    if (key_string)
+    {
+      value_path = forecast_hash_char(value_path, escape[1]);
+    }
+    return true;
+  }
+
+  case IN_NUMBER:
+    if (number_part == NUMBER_ZERO && c >= '0' && c <= '9')
+    {
+      return fail("InvalidInput"); // Leading zero
+    }
+    if (numberChar(c))
+    {
+      return true;
+    }
+    endNumber();
+    if (state == FINISHED || state == INVALID)
+    {
+      return false;
+    }
+    break; // `c` follows the number
+
+  case IN_LITERAL:
+    if (c != static_cast<uint8_t>(*literal))
+    {
+      return fail("InvalidInput");
+    }
+    if (*++literal == '\0')
+    {
+      endValue();
+    }
+    return state != FINISHED;
+
+  case FINISHED:
+  case INVALID:
+    return false;
+
+  default:
+    break;
+  }
+
+  if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+  {
+    return true;
+  }
+
+  switch (state)
+  {
+  case EXPECT_VALUE:
+    return startValue(c);
+
+  case EXPECT_VALUE_OR_CLOSE:
+    return c == ']' ? close(c) : startValue(c);
+
+  case EXPECT_KEY_OR_CLOSE:
+    if (c == '}')
+    {
+      return close(c);
+    }
+    // Fall through
+  case EXPECT_KEY:
+    if (c != '"')
+    {
+      return fail("InvalidInput");
+    }
+    key_string = true;
+    value_path = forecast_hash_char(path[depth - 1], '.');
+    state = IN_STRING;
+    return true;
+
+  case EXPECT_COLON:
+    if (c != ':')
+    {
+      return fail("InvalidInput");
+    }
+    state = EXPECT_VALUE;
+    return true;
+
+  case EXPECT_COMMA_OR_CLOSE:
+    if (c == ',')
+    {
+      state = (arrays >> (depth - 1)) & 1 ? EXPECT_VALUE : EXPECT_KEY;
+      return true;
+    }
+    return close(c);
+
+  default:
+    return fail("InvalidInput");
+  }
+}
+
+bool ForecastParser::startValue(uint8_t c)
+{
+  key_string = false;
+  if (depth == 0)
+  {
+    value_path = PATH_ROOT;
+  }
+  else if ((arrays >> (depth - 1)) & 1)
+  {
+    value_path = elementPath();
+  }
+
+  switch (c)
+  {
+  case '{':
+    return open(false);
+  case '[':
+    return open(true);
+  case '"':
+    state = IN_STRING;
+    return true;
+  case 't':
+    literal = "rue";
+    state = IN_LITERAL;
+    return true;
+  case 'f':
+    literal = "alse";
+    state = IN_LITERAL;
+    return true;
+  case 'n':
+    literal = "ull";
+    state = IN_LITERAL;
+    return true;
+  default:
+    break;
+  }
+
+  if (c != '-' && (c < '0' || c > '9'))
+  {
+    return fail("InvalidInput");
+  }
+  mantissa = 0;
+  exponent = 0;
+  exp_value = 0;
+  exp_negative = false;
+  negative = c == '-';
+  number_part = NUMBER_SIGN;
+  state = IN_NUMBER;
+  if (!negative)
+  {
+    numberChar(c);
+  }
+  return true;
+}
+
+void ForecastParser::hashUnicode()
+{
+  // UTF-8, as ArduinoJson decodes \u escapes; surrogates are hashed as they
+  // come, no key looked for has any
+  if (unicode < 0x80)
+  {
+    value_path = forecast_hash_char(value_path, unicode);
+    return;
+  }
+  if (unicode < 0x800)
+  {
+    value_path = forecast_hash_char(value_path, 0xC0 | (unicode >> 6));
+  }
+  else
+  {
+    value_path = forecast_hash_char(value_path, 0xE0 | (unicode >> 12));
+    value_path = forecast_hash_char(value_path, 0x80 | ((unicode >> 6) & 0x3F));
+  }
+  value_path = forecast_hash_char(value_path, 0x80 | (unicode & 0x3F));
+}
+
+bool ForecastParser::open(bool array)
+{
+  if (depth == FORECAST_PARSER_MAX_DEPTH)
+  {
+    return fail("TooDeep");
+  }
+  if (!array)
+  {
+    if (value_path == forecast_path_hash("current"))
+    {
+      found |= OBJECT_CURRENT;
+    }
+    else if (value_path == forecast_path_hash("forecast.forecastday.0.day"))
+    {
+      found |= OBJECT_TODAY;
+    }
+  }
+
+  path[depth] = value_path;
+  element[depth] = 0;
+  arrays = array ? arrays | (1u << depth) : arrays & ~(1u << depth);
+  depth++;
+  state = array ? EXPECT_VALUE_OR_CLOSE : EXPECT_KEY_OR_CLOSE;
+  return true;
+}
+
+bool ForecastParser::close(uint8_t c)
+{
+  bool array = (arrays >> (depth - 1)) & 1;
+  if (c != (array ? ']' : '}'))
+  {
+    return fail("InvalidInput");
+  }
+  depth--;
+  endValue();
+  return state != FINISHED;
+}
+
+bool ForecastParser::numberChar(uint8_t c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    uint8_t digit = c - '0';
+    if (number_part >= NUMBER_E)
+    {
+      number_part = NUMBER_EXPONENT;
+      exp_value = exp_value < 1000 ? exp_value * 10 + digit : exp_value;
+      return true;
+    }
+    if (number_part >= NUMBER_POINT)
+    {
+      number_part = NUMBER_FRACTION;
+      exponent--;
+    }
+    else
+    {
+      number_part = number_part == NUMBER_SIGN && digit == 0 ? NUMBER_ZERO : NUMBER_INTEGER;
+    }
+    if (mantissa < MANTISSA_LIMIT)
+    {
+      mantissa = mantissa * 10 + digit;
+    }
+    else
+    {
+      exponent++;
+    }
+    return true;
+  }
+
+  if (c == '.' && (number_part == NUMBER_ZERO || number_part == NUMBER_INTEGER))
+  {
+    number_part = NUMBER_POINT;
+    return true;
+  }
+  if ((c == 'e' || c == 'E') && (number_part == NUMBER_ZERO || number_part == NUMBER_INTEGER || number_part == NUMBER_FRACTION))
+  {
+    number_part = NUMBER_E;
+    return true;
+  }
+  if ((c == '+' || c == '-') && number_part == NUMBER_E)
+  {
+    number_part = NUMBER_EXP_SIGN;
+    exp_negative = c == '-';
+    return true;
+  }
+  return false;
+}
+
+void ForecastParser::endNumber()
+{
+  if (number_part != NUMBER_ZERO && number_part != NUMBER_INTEGER && number_part != NUMBER_FRACTION &&
+      number_part != NUMBER_EXPONENT)
+  {
+    fail("InvalidInput");
+    return;
+  }
+
+  // Only the values looked for are converted; the hashes are distinct, or
+  // the case labels would not compile
+  uint16_t field;
+  switch (value_path)
+  {
+  case forecast_path_hash("current.temp_c"):
+    field = FIELD_TEMPERATURE;
+    break;
+  case forecast_path_hash("current.humidity"):
+    field = FIELD_HUMIDITY;
+    break;
+  case forecast_path_hash("current.condition.code"):
+    field = FIELD_CONDITION;
+    break;
+  case forecast_path_hash("current.air_quality.pm2_5"):
+    field = FIELD_PM25;
+    break;
+  case forecast_path_hash("current.air_quality.us-epa-index"):
+    field = FIELD_US_EPA;
+    break;
+  case forecast_path_hash("forecast.forecastday.0.day.maxtemp_c"):
+    field = FIELD_TEMP_HIGH;
+    break;
+  case forecast_path_hash("forecast.forecastday.0.day.mintemp_c"):
+    field = FIELD_TEMP_LOW;
+    break;
+  default:
+    endValue();
+    return;
+  }
+
+  // One multiplication or division by an exact power of ten rounds like
+  // strtod for the short decimals of the response
+  static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  int e = exponent + (exp_negative ? -exp_value : exp_value);
+  double value = static_cast<double>(mantissa);
+  for (; e > 22; e -= 22)
+  {
+    value *= 1e22;
+  }
+  for (; e < -22; e += 22)
+  {
+    value /= 1e22;
+  }
+  value = e < 0 ? value / powers[-e] : value * powers[e];
+  value = negative ? -value : value;
+
+  // Integers truncated, as ArduinoJson's as<int>() does with decimals
+  switch (field)
+  {
+  case FIELD_TEMPERATURE:
+    out.temperature = static_cast<float>(value);
+    break;
+  case FIELD_HUMIDITY:
+    out.humidity = static_cast<int>(value);
+    break;
+  case FIELD_CONDITION:
+    out.condition_code = static_cast<int>(value);
+    break;
+  case FIELD_PM25:
+    out.air_quality_pm25 = static_cast<int>(value);
+    break;
+  case FIELD_US_EPA:
+    out.air_quality_us_epa = static_cast<int>(value);
+    break;
+  case FIELD_TEMP_HIGH:
+    out.temp_high = static_cast<float>(value);
+    break;
+  default:
+    out.temp_low = static_cast<float>(value);
+    break;
+  }
+  found |= field;
+  endValue();
+}
+
+void ForecastParser::endValue()
+{
+  if (depth == 0 || (found & FIELDS_ALL) == FIELDS_ALL)
+  {
+    state = FINISHED;
+    return;
+  }
+  state = EXPECT_COMMA_OR_CLOSE;
+}
+
+uint32_t ForecastParser::elementPath()
+{
+  uint32_t hash = forecast_hash_char(path[depth - 1], '.');
+  uint16_t index = element[depth - 1]++;
+  char digits[5];
+  int n = 0;
+  do
+  {
+    digits[n++] = static_cast<char>('0' + index % 10);
+    index /= 10;
+  } while (index > 0);
+  while (n > 0)
+  {
+    hash = forecast_hash_char(hash, digits[--n]);
+  }
+  return hash;
+}
+
+bool ForecastParser::fail(const char *reason)
+{
+  state = INVALID;
+  error = reason;
+  return false;
+}
@@ -0,0 +1,116 @@
+#ifndef FORECAST_PARSER_H
+#define FORECAST_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Project headers
+#include "weather_api.h"
+
+// Deepest nesting accepted, as ArduinoJson's default nesting limit
+#define FORECAST_PARSER_MAX_DEPTH 10
+
+// Key paths are FNV-1a hashes of the dotted path from the root, array
+// elements named by their index: "current.air_quality.pm2_5",
+// "forecast.forecastday.0.day.maxtemp_c". The parser hashes the path of every
+// value as it reads the keys; the paths it looks for are hashed at compile time.
+constexpr uint32_t forecast_hash_char(uint32_t hash, char c)
+{
+  return (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+}
+
+constexpr uint32_t forecast_hash_chars(uint32_t hash, const char *s)
+{
+  return *s ? forecast_hash_chars(forecast_hash_char(hash, *s), s + 1) : hash;
+}
+
+// Every segment starts with '.', the root is the FNV offset basis
+constexpr uint32_t forecast_path_hash(const char *path)
+{
+  return forecast_hash_chars(forecast_hash_char(2166136261u, '.'), path);
+}
+
+// Streaming tokenizer for the WeatherAPI.com forecast.json response
+// Reads the body in pieces of any size and writes the values WeatherData
+// takes straight into it, without building a document. Everything else is
+// checked for JSON syntax and skipped. Input ends as soon as all fields are
+// read, so the hourly forecast is not read at all.
+//
+// Fields missing from a complete response stay 0, as ArduinoJson's as<>()
+// gives them; a response without "current" or the first forecast day fails.
+class ForecastParser
+{
+public:
+  // Parse into `out`; only the numeric fields are written
+  explicit ForecastParser(WeatherData &out);
+
+  // Parse the next `len` bytes; false once no more input is needed (all
+  // fields read, the root value closed, or invalid input)
+  bool feed(const uint8_t *data, size_t len);
+
+  // Input ended: the fields were found, or the whole response was read
+  bool succeeded() const;
+
+  // Input ended before the response did, all fields read
+  bool stoppedEarly() const;
+
+  // Reason for failing, in ArduinoJson's terms (valid after the last feed)
+  const char *getError() const;
+
+private:
+  // What the next character may be
+  enum State : uint8_t
+  {
+    EXPECT_VALUE,          // Value (root, after ':' or ',' in an array)
+    EXPECT_VALUE_OR_CLOSE, // After '['
+    EXPECT_KEY,            // After ',' in an object
+    EXPECT_KEY_OR_CLOSE,   // After '{'
+    EXPECT_COLON,          // After a key
+    EXPECT_COMMA_OR_CLOSE, // After a value
+    IN_STRING,
+    IN_STRING_ESCAPE,
+    IN_NUMBER,
+    IN_LITERAL,            // true, false, null
+    FINISHED,              // Root value closed or all fields read
+    INVALID,
+  };
+
+  WeatherData &out;
+  State state = EXPECT_VALUE;
+  const char *error = nullptr;
+
+  // Open objects and arrays: path hash, next element index of arrays
+  uint8_t depth = 0;
+  uint32_t path[FORECAST_PARSER_MAX_DEPTH];
+  uint16_t element[FORECAST_PARSER_MAX_DEPTH];
+  uint16_t arrays = 0; // Bit per depth
+  uint32_t value_path = 0; // Path of the value being read
+  bool key_string = false;
+  uint8_t hex_left = 0; // Digits of a \u escape still to come
+  uint16_t unicode = 0; // Its code unit so far
+
+  // Number being read: mantissa digits, decimal exponent
+  uint64_t mantissa = 0;
+  int16_t exponent = 0;
+  int16_t exp_value = 0;
+  uint8_t number_part = 0;
+  bool negative = false;
+  bool exp_negative = false;
+
+  const char *literal = nullptr; // Rest of the literal being read
+
+  uint16_t found = 0; // FIELD_* bits
+
+  bool step(uint8_t c);
+  bool startValue(uint8_t c);
+  bool open(bool array);
+  bool close(uint8_t c);
+  void hashUnicode();
+  bool numberChar(uint8_t c);
+  void endNumber();
+  void endValue();
+  uint32_t elementPath();
+  bool fail(const char *reason);
+};
+
+#endif // FORECAST_PARSER_H
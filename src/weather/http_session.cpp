@@ -0,0 +1,258 @@
+// Own header
+#include "http_session.h"
+#include "../config.h"
+
+#include <ctype.h>
+
+// Bytes read per call while discarding the rest of a body
+#define DRAIN_CHUNK 256
+
+// Response headers read besides the status line
+static const char *collected_headers[] = {"Transfer-Encoding"};
+
+void HttpBodyStream::reset(Stream *source, int length, bool chunked)
+{
+  this->source = source;
+  this->chunked = chunked;
+  remaining = chunked ? 0 : length;
+  first_chunk = true;
+  complete = !chunked && length == 0;
+}
+
+bool HttpBodyStream::isComplete() const
+{
+  return complete;
+}
+
+int HttpBodyStream::readByte()
+{
+  char c;
+  return source->readBytes(&c, 1) == 1 ? static_cast<uint8_t>(c) : -1;
+}
+
+// Start of the next chunk: "<hex size>[;extensions]\r\n", after the "\r\n"
+// ending the previous one. The last chunk (size 0) and its trailer end the body.
+bool HttpBodyStream::nextChunk()
+{
+  if (!first_chunk && (readByte() != '\r' || readByte() != '\n'))
+  {
+    return false;
+  }
+  first_chunk = false;
+
+  int size = 0;
+  bool digits = false;
+  int c;
+  while ((c = readByte()) >= 0 && isxdigit(c))
+  {
+    size = size * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+    digits = true;
+  }
+  while (c >= 0 && c != '\n')
+  {
+    c = readByte();
+  }
+  if (!digits || c < 0)
+  {
+    return false;
+  }
+
+  if (size == 0)
+  {
+    // Trailer lines up to an empty one
+    int line_length = 0;
+    while ((c = readByte()) >= 0)
+    {
+      if (c == '\n')
+      {
+        if (line_length == 0)
+        {
+          complete = true;
+          return false;
+        }
+        line_length = 0;
+      }
+      else if (c != '\r')
+      {
+        line_length++;
+      }
+    }
+    return false;
+  }
+  remaining = size;
+  return true;
+}
+
+int HttpBodyStream::available()
+{
+  if (source == nullptr || complete)
+  {
+    return 0;
+  }
+  int arrived = source->available();
+  if (remaining < 0)
+  {
+    return arrived;
+  }
+  return arrived < remaining ? arrived : remaining;
+}
+
+int HttpBodyStream::read()
+{
+  char c;
+  return readBytes(&c, 1) == 1 ? static_cast<uint8_t>(c) : -1;
+}
+
+int HttpBodyStream::peek()
+{
+  return source != nullptr && !complete && remaining != 0 ? source->peek() : -1;
+}
+
+size_t HttpBodyStream::readBytes(char *buffer, size_t length)
+{
+  size_t total = 0;
+  while (source != nullptr && !complete && total < length)
+  {
+    if (chunked && remaining == 0 && !nextChunk())
+    {
+      break;
+    }
+
+    size_t want = length - total;
+    if (remaining >= 0 && want > static_cast<size_t>(remaining))
+    {
+      want = remaining;
+    }
+    size_t n = source->readBytes(buffer + total, want);
+    total += n;
+    if (remaining >= 0)
+    {
+      remaining -= static_cast<int>(n);
+      complete = !chunked && remaining == 0;
+    }
+    if (n < want)
+    {
+      break; // Timed out, or the connection closed
+    }
+  }
+  return total;
+}
+
+HttpSession::HttpSession()
+{
+  reuse = WEATHER_HTTP_REUSE;
+  http.setReuse(reuse);
+  http.setTimeout(WEATHER_HTTP_TIMEOUT_MS);
+}
+
+void HttpSession::setReuse(bool reuse)
+{
+  this->reuse = reuse;
+  http.setReuse(reuse);
+  if (!reuse)
+  {
+    close();
+  }
+}
+
+bool HttpSession::getReuse() const
+{
+  return reuse;
+}
+
+int HttpSession::get(const String &url)
+{
+  for (int attempt = 0;; attempt++)
+  {
+    bool reused = http.connected();
+    http.begin(client, url);
+    // HTTP/1.1 for keep-alive; a chunked body is decoded by `body`
+    http.useHTTP10(false);
+    http.collectHeaders(collected_headers, sizeof(collected_headers) / sizeof(collected_headers[0]));
+
+    unsigned long start = micros();
+    int code = http.GET();
+    uint32_t request_us = micros() - start;
+
+    if (code < 0 && reused && attempt == 0)
+    {
+      // Closed by the server between requests
+      stats.retries++;
+      client.stop();
+      continue;
+    }
+    if (code < 0)
+    {
+      close();
+      return code;
+    }
+
+    stats.requests++;
+    stats.last_request_us = request_us;
+    stats.last_reused = reused;
+    if (reused)
+    {
+      stats.reused_us += request_us;
+    }
+    else
+    {
+      stats.connections++;
+      stats.new_us += request_us;
+    }
+
+    bool chunked = http.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+    body.reset(&http.getStream(), chunked ? -1 : http.getSize(), chunked);
+    body_delimited = chunked || http.getSize() >= 0;
+    return code;
+  }
+}
+
+Stream &HttpSession::getBody()
+{
+  return body;
+}
+
+int HttpSession::getSize()
+{
+  return http.getSize();
+}
+
+void HttpSession::end()
+{
+  // Without a length or chunks the body ends when the server closes the
+  // connection, which then cannot be reused anyway
+  if (reuse && body_delimited)
+  {
+    char scratch[DRAIN_CHUNK];
+    size_t n;
+    while (!body.isComplete() && (n = body.readBytes(scratch, sizeof(scratch))) > 0)
+    {
+      stats.drained_bytes += n;
+    }
+  }
+
+  if (reuse && body.isComplete())
+  {
+    http.end(); // Kept open unless the server asked to close it
+  }
+  else
+  {
+    close();
+  }
+}
+
+void HttpSession::close()
+{
+  client.stop();
+  http.end();
+}
+
+const HttpSessionStats &HttpSession::getStats() const
+{
+  return stats;
+}
+
+void HttpSession::resetStats()
+{
+  stats = {};
+}
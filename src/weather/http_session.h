@@ -0,0 +1,94 @@
+#ifndef HTTP_SESSION_H
+#define HTTP_SESSION_H
+
+#include <stdint.h>
+
+// System libraries
+#include <HTTPClient.h>
+#include <WiFi.h>
+
+// Body of one response on the connection's stream: Content-Length bytes,
+// chunked (the chunk framing removed), or up to the connection closing
+class HttpBodyStream : public Stream
+{
+public:
+  // `length` -1 if the response has no Content-Length
+  void reset(Stream *source, int length, bool chunked);
+
+  // Every byte of the body was read, the connection is at the next response
+  bool isComplete() const;
+
+  // Bytes of the body arrived and not read yet
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+  // Waits up to the connection's timeout; short at the end of the body
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+
+private:
+  Stream *source = nullptr;
+  int remaining = 0;        // Bytes left of the body, or of the chunk if chunked
+  bool chunked = false;
+  bool first_chunk = true;
+  bool complete = true;
+
+  bool nextChunk();
+  int readByte();
+};
+
+// Requests since the last resetStats()
+struct HttpSessionStats
+{
+  uint32_t requests;        // Responses received
+  uint32_t connections;     // TCP connections opened for them
+  uint32_t retries;         // Requests resent after a reused connection was found closed
+  uint32_t last_request_us; // Last GET until its response headers
+  bool last_reused;         // Last request went over an open connection
+  uint64_t new_us;          // GET time summed over requests on new connections
+  uint64_t reused_us;       // GET time summed over requests on reused connections
+  uint32_t drained_bytes;   // Body bytes read past the parser so the connection could be reused
+};
+
+// HTTP session kept across requests to one server
+// The connection stays open after a response (HTTP/1.1 keep-alive) and the
+// next GET goes over it, skipping DNS and the TCP handshake. When the server
+// has closed it, the request goes over a new connection instead; one whose
+// close is only noticed when the request fails is resent once.
+class HttpSession
+{
+public:
+  HttpSession();
+
+  // Keep the connection open between requests (default WEATHER_HTTP_REUSE)
+  void setReuse(bool reuse);
+  bool getReuse() const;
+
+  // GET `url`: the status code, negative if no response arrived
+  int get(const String &url);
+
+  // Body of the last response, and its Content-Length (-1 if chunked or unknown)
+  Stream &getBody();
+  int getSize();
+
+  // Done with the response. The rest of the body is read so the connection
+  // can carry the next request; it is closed if that fails or reuse is off.
+  void end();
+
+  // Close the connection
+  void close();
+
+  const HttpSessionStats &getStats() const;
+  void resetStats();
+
+private:
+  WiFiClient client;
+  HTTPClient http;
+  HttpBodyStream body;
+  bool body_delimited = false; // Content-Length or chunked
+  bool reuse;
+  HttpSessionStats stats = {};
+};
+
+#endif // HTTP_SESSION_H
@@ -0,0 +1,60 @@
+// Own header
+#include "json_allocator.h"
+
+#include <stdlib.h>
+
+// Size header in front of every block, padded so the block stays aligned
+union BlockHeader
+{
+  size_t size;
+  max_align_t align;
+};
+
+void *CountingJsonAllocator::allocate(size_t size)
+{
+  BlockHeader *header = static_cast<BlockHeader *>(malloc(sizeof(BlockHeader) + size));
+  if (header == nullptr)
+  {
+    return nullptr;
+  }
+  header->size = size;
+  bytes += size;
+  if (bytes > peak_bytes)
+  {
+    peak_bytes = bytes;
+  }
+  return header + 1;
+}
+
+void CountingJsonAllocator::deallocate(void *ptr)
+{
+  if (ptr == nullptr)
+  {
+    return;
+  }
+  BlockHeader *header = static_cast<BlockHeader *>(ptr) - 1;
+  bytes -= header->size;
+  free(header);
+}
+
+void *CountingJsonAllocator::reallocate(void *ptr, size_t new_size)
+{
+  if (ptr == nullptr)
+  {
+    return allocate(new_size);
+  }
+  BlockHeader *header = static_cast<BlockHeader *>(ptr) - 1;
+  size_t old_size = header->size;
+  header = static_cast<BlockHeader *>(realloc(header, sizeof(BlockHeader) + new_size));
+  if (header == nullptr)
+  {
+    return nullptr;
+  }
+  header->size = new_size;
+  bytes = bytes - old_size + new_size;
+  if (bytes > peak_bytes)
+  {
+    peak_bytes = bytes;
+  }
+  return header + 1;
+}
@@ -0,0 +1,29 @@
+#ifndef JSON_ALLOCATOR_H
+#define JSON_ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Third-party libraries
+#include <ArduinoJson.h>
+
+// ArduinoJson allocator that counts the heap a JsonDocument holds
+// Each block carries its size in a small header, so frees are counted too;
+// the peak is the document's largest footprint since resetPeak().
+class CountingJsonAllocator : public ArduinoJson::Allocator
+{
+public:
+  void *allocate(size_t size) override;
+  void deallocate(void *ptr) override;
+  void *reallocate(void *ptr, size_t new_size) override;
+
+  size_t getBytes() const { return bytes; }
+  size_t getPeakBytes() const { return peak_bytes; }
+  void resetPeak() { peak_bytes = bytes; }
+
+private:
+  size_t bytes = 0;
+  size_t peak_bytes = 0;
+};
+
+#endif // JSON_ALLOCATOR_H
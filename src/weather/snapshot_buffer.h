@@ -0,0 +1,54 @@
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+// Triple buffer handing the latest value from one producer task to one
+// consumer task without locks. The producer fills its own slot and swaps it
+// with the middle one; the consumer swaps its slot with the middle one when a
+// newer value is there. Neither ever waits for the other or touches the
+// other's slot, so a value is never read while it is written, and values the
+// consumer did not take in time are overwritten.
+template <typename T>
+class SnapshotBuffer
+{
+public:
+  // Producer: the slot to fill, then publish()
+  T &writeSlot() { return slots[back]; }
+  void publish()
+  {
+    // Release: the slot's contents before its index
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+  }
+
+  // Consumer: a value was published since the last take()
+  bool pending() const { return (middle.load(std::memory_order_acquire) & FRESH) != 0; }
+
+  // Consumer: switch to the latest published value, false if there is none
+  // newer than read()
+  bool take()
+  {
+    if (!pending())
+    {
+      return false;
+    }
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  // Consumer: the value taken last (value-initialized before the first)
+  const T &read() const { return slots[front]; }
+
+private:
+  static const uint32_t INDEX = 0x3;
+  static const uint32_t FRESH = 0x4; // Middle slot not taken yet
+
+  T slots[3] = {};
+  uint32_t back = 0;                 // Producer's
+  std::atomic<uint32_t> middle{1};
+  uint32_t front = 2;                // Consumer's
+};
+
+#endif // SNAPSHOT_BUFFER_H
@@ -1,25 +1,66 @@
 #include "weather_api.h"
+#include "forecast_parser.h"
+#include "json_allocator.h"
 #include "../debug.h"
+#include "trace.h"
+
+#include <string.h>
 
 WeatherAPI::WeatherAPI()
 {
   current_weather.valid = false;
+  parser = WEATHER_PARSER;
+  buildRequestUrl();
 }
 
 bool WeatherAPI::init()
 {
   current_weather.valid = false;
   last_update = 0;
+  buildRequestUrl();
   return true;
 }
 
+void WeatherAPI::buildRequestUrl()
+{
+  request_url = "";
+  request_url.reserve(weatherapi_config.endpoint.length() + weatherapi_config.api_key.length() +
+                      weatherapi_config.location.length() + 48);
+  request_url += weatherapi_config.endpoint;
+  request_url += "?key=";
+  request_url += weatherapi_config.api_key;
+  request_url += "&q=";
+  request_url += weatherapi_config.location;
+  request_url += "&days=1&aqi=yes&alerts=no";
+}
+
+void WeatherAPI::setEndpoint(const String &endpoint)
+{
+  weatherapi_config.endpoint = endpoint;
+  session.close();
+  buildRequestUrl();
+}
+
+HttpSession &WeatherAPI::getSession()
+{
+  return session;
+}
+
 WeatherData WeatherAPI::getCurrentWeather()
 {
-  return current_weather;
+  snapshots.take();
+  return snapshots.read().weather;
+}
+
+bool WeatherAPI::hasNewWeather() const
+{
+  return snapshots.pending();
 }
 
 bool WeatherAPI::fetchWeatherData()
 {
+  TRACE_SCOPE("fetch");
+
   if (WiFi.status() != WL_CONNECTED)
   {
     return false;
@@ -35,83 +76,340 @@ bool WeatherAPI::fetchWeatherData()
   last_update = millis();
   time(&last_update_time); // Capture the system time when data was fetched
   DEBUG_LOGF("Weather fetched at: %lu\n", (unsigned long)last_update_time);
+
+  WeatherSnapshot &snapshot = snapshots.writeSlot();
+  snapshot.weather = current_weather;
+  snapshot.fetch_time = last_update_time;
+  snapshot.fetches = ++fetches;
+  snapshots.publish();
   return true;
 }
 
-bool WeatherAPI::fetchCurrentAndTodayWeatherAPI()
+// Body bytes taken from the HTTP stream per read; ArduinoJson reads the
+// JSON one byte at a time from them
+#define FORECAST_READ_CHUNK 256
+
+// Next piece of the body: what already arrived, or one byte within the
+// stream's timeout, at most `size` and the `remaining` bytes (-1 if unknown)
+static size_t read_body_chunk(Stream &stream, uint8_t *buf, size_t size, int &remaining)
+{
+  if (remaining == 0)
+  {
+    return 0;
+  }
+  int available = stream.available();
+  size_t want = available > 0 ? static_cast<size_t>(available) : 1;
+  want = want < size ? want : size;
+  if (remaining > 0 && want > static_cast<size_t>(remaining))
+  {
+    want = remaining;
+  }
+
+  size_t len = stream.readBytes(buf, want);
+  if (remaining > 0)
+  {
+    remaining -= static_cast<int>(len);
+  }
+  return len;
+}
+
+// Source ArduinoJson reads the forecast body from (read/readBytes), filled in
+// chunks from the HTTP stream. It follows the JSON structure just far enough
+// to end the input at the "hour" array of the forecast day once "current"
+// has passed: everything WeatherData needs comes before it, and the 24
+// hourly entries are most of the body.
+class ForecastReader
 {
-  HTTPClient http;
-  String url = "http://api.weatherapi.com/v1/forecast.json?key=" +
-               weatherapi_config.api_key +
-               "&q=" + weatherapi_config.location +
-               "&days=1&aqi=yes&alerts=no";
+public:
+  ForecastReader(Stream &stream, int length) : stream(stream), remaining(length) {}
 
-  http.begin(url);
-  int httpResponseCode = http.GET();
+  int read()
+  {
+    if (stopped || (pos == len && !refill()))
+    {
+      return -1;
+    }
+    uint8_t c = chunk[pos++];
+    track(c);
+    return c;
+  }
 
-  if (httpResponseCode != 200)
+  size_t readBytes(char *buffer, size_t length)
   {
-    http.end();
-    return false;
+    size_t n = 0;
+    int c;
+    while (n < length && (c = read()) >= 0)
+    {
+      buffer[n++] = static_cast<char>(c);
+    }
+    return n;
   }
 
-  String payload = http.getString();
-  http.end();
+  bool stoppedEarly() const { return stopped; }
+  uint32_t getBytesRead() const { return bytes_read; }
+
+private:
+  Stream &stream;
+  int remaining; // Body bytes not read yet, -1 if unknown
+  uint8_t chunk[FORECAST_READ_CHUNK];
+  size_t len = 0;
+  size_t pos = 0;
+  uint32_t bytes_read = 0;
+  bool stopped = false;
 
-  JsonDocument doc;
-  DeserializationError error = deserializeJson(doc, payload);
+  int depth = 0;             // Open objects and arrays
+  bool in_string = false;
+  bool escaped = false;
+  bool after_string = false; // A ':' next makes the string a key
+  char key[8];               // Start of the last string
+  size_t key_len = 0;        // sizeof(key) + 1 if longer or escaped
+  bool current_started = false;
+  bool current_done = false;
 
-  if (error)
+  bool refill()
   {
-    return false;
+    len = read_body_chunk(stream, chunk, sizeof(chunk), remaining);
+    pos = 0;
+    bytes_read += len;
+    return len > 0;
   }
 
-  // Parse current weather
-  current_weather.temperature = doc["current"]["temp_c"].as<float>();
-  current_weather.temperature_unit = "°C";
-  current_weather.humidity = doc["current"]["humidity"].as<int>();
+  bool keyIs(const char *name) const
+  {
+    return key_len == strlen(name) && memcmp(key, name, key_len) == 0;
+  }
 
-  // Parse air quality data
-  if (doc["current"]["air_quality"])
+  void track(uint8_t c)
   {
-    current_weather.air_quality_pm25 = doc["current"]["air_quality"]["pm2_5"].as<int>();
-    current_weather.air_quality_us_epa = doc["current"]["air_quality"]["us-epa-index"].as<int>();
+    if (in_string)
+    {
+      if (escaped)
+      {
+        escaped = false;
+      }
+      else if (c == '\\')
+      {
+        escaped = true;
+        key_len = sizeof(key) + 1;
+      }
+      else if (c == '"')
+      {
+        in_string = false;
+        after_string = true;
+      }
+      else if (key_len < sizeof(key))
+      {
+        key[key_len++] = c;
+      }
+      else
+      {
+        key_len = sizeof(key) + 1;
+      }
+      return;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+    {
+      return;
+    }
+    if (c == ':' && after_string)
+    {
+      // Key of the root object: the one after "current" closes it
+      if (depth == 1)
+      {
+        current_done = current_started;
+        current_started = current_started || keyIs("current");
+      }
+      // Key of a forecastday entry
+      else if (depth == 4 && current_done && keyIs("hour"))
+      {
+        stopped = true;
+      }
+    }
+    after_string = false;
+
+    if (c == '"')
+    {
+      in_string = true;
+      key_len = 0;
+    }
+    else if (c == '{' || c == '[')
+    {
+      depth++;
+    }
+    else if (c == '}' || c == ']')
+    {
+      depth--;
+    }
   }
-  else
+};
+
+bool WeatherAPI::fetchCurrentAndTodayWeatherAPI()
+{
+  TRACE_BEGIN("http_get");
+  int httpResponseCode = session.get(request_url);
+
+  if (httpResponseCode != 200)
   {
-    current_weather.air_quality_pm25 = 0;
-    current_weather.air_quality_us_epa = 0;
+    session.end();
+    TRACE_END("http_get");
+    return false;
   }
+  TRACE_END("http_get");
 
-  // Get condition code directly from WeatherAPI.com
-  current_weather.condition_code = doc["current"]["condition"]["code"].as<int>();
+  DEBUG_LOGF("HTTP %s connection, response headers after %lu us\n",
+             session.getStats().last_reused ? "reused" : "new", (unsigned long)session.getStats().last_request_us);
 
-  // Get today's min/max from forecast data
-  JsonObject today_forecast = doc["forecast"]["forecastday"][0]["day"];
-  current_weather.temp_high = today_forecast["maxtemp_c"].as<float>();
-  current_weather.temp_low = today_forecast["mintemp_c"].as<float>();
+  // Includes receiving the body; the rest is read by end() to keep the
+  // connection usable
+  bool parsed = parseForecast(session.getBody(), session.getSize());
+  session.end();
+  return parsed;
+}
 
+bool WeatherAPI::parseForecast(Stream &body, int length)
+{
+  TRACE_SCOPE("parse");
+
+  WeatherData parsed = {};
+  unsigned long start = micros();
+  bool ok = parser == WEATHER_PARSER_SCHEMA ? parseForecastSchema(body, length, parsed)
+                                            : parseForecastJson(body, length, parsed);
+  parse_stats.parse_us = micros() - start;
+  parse_stats.total_bytes = length;
+  if (!ok)
+  {
+    return false;
+  }
+
+  current_weather.temperature = parsed.temperature;
+  current_weather.temperature_unit = "°C";
+  current_weather.humidity = parsed.humidity;
+  current_weather.air_quality_pm25 = parsed.air_quality_pm25;
+  current_weather.air_quality_us_epa = parsed.air_quality_us_epa;
+  current_weather.condition_code = parsed.condition_code;
+  current_weather.temp_high = parsed.temp_high;
+  current_weather.temp_low = parsed.temp_low;
   current_weather.last_updated = String(millis());
 
   DEBUG_LOGF("Temp: %.1f°C, Range: %.1f-%.1f°C, Condition: %d\n",
              current_weather.temperature, current_weather.temp_low,
              current_weather.temp_high, current_weather.condition_code);
+  DEBUG_LOGF("%s parsed %lu of %ld B in %lu us, heap peak %lu B%s\n", getParserName(parser),
+             (unsigned long)parse_stats.body_bytes, (long)parse_stats.total_bytes,
+             (unsigned long)parse_stats.parse_us, (unsigned long)parse_stats.peak_bytes,
+             parse_stats.stopped_early ? ", rest skipped" : "");
+
+  return true;
+}
+
+bool WeatherAPI::parseForecastJson(Stream &body, int length, WeatherData &out)
+{
+  // Only the fields WeatherData needs are kept in the document
+  static JsonDocument filter;
+  if (filter.isNull())
+  {
+    filter["current"]["temp_c"] = true;
+    filter["current"]["humidity"] = true;
+    filter["current"]["condition"]["code"] = true;
+    filter["current"]["air_quality"]["pm2_5"] = true;
+    filter["current"]["air_quality"]["us-epa-index"] = true;
+    filter["forecast"]["forecastday"][0]["day"]["maxtemp_c"] = true;
+    filter["forecast"]["forecastday"][0]["day"]["mintemp_c"] = true;
+  }
+
+  CountingJsonAllocator allocator;
+  JsonDocument doc(&allocator);
+  ForecastReader reader(body, length);
+  DeserializationError error = deserializeJson(doc, reader, DeserializationOption::Filter(filter));
+  parse_stats.body_bytes = reader.getBytesRead();
+  parse_stats.peak_bytes = allocator.getPeakBytes();
+  parse_stats.stopped_early = reader.stoppedEarly();
+
+  // Ended at the hourly forecast, the document holds everything before it
+  if (error && !(error == DeserializationError::IncompleteInput && reader.stoppedEarly()))
+  {
+    LOG_ERRORF("Weather response not parsed: %s\n", error.c_str());
+    return false;
+  }
+
+  JsonObject current = doc["current"];
+  JsonObject today_forecast = doc["forecast"]["forecastday"][0]["day"];
+  if (current.isNull() || today_forecast.isNull())
+  {
+    LOG_ERROR("Weather response without current or forecast data");
+    return false;
+  }
+
+  out.temperature = current["temp_c"].as<float>();
+  out.humidity = current["humidity"].as<int>();
+  // 0 without air quality data
+  out.air_quality_pm25 = current["air_quality"]["pm2_5"].as<int>();
+  out.air_quality_us_epa = current["air_quality"]["us-epa-index"].as<int>();
+  // Condition code directly from WeatherAPI.com
+  out.condition_code = current["condition"]["code"].as<int>();
+  // Today's min/max from forecast data
+  out.temp_high = today_forecast["maxtemp_c"].as<float>();
+  out.temp_low = today_forecast["mintemp_c"].as<float>();
+  return true;
+}
+
+bool WeatherAPI::parseForecastSchema(Stream &body, int length, WeatherData &out)
+{
+  ForecastParser forecast_parser(out);
+  uint8_t chunk[FORECAST_READ_CHUNK];
+  int remaining = length;
+  uint32_t bytes_read = 0;
+  size_t len;
+  while ((len = read_body_chunk(body, chunk, sizeof(chunk), remaining)) > 0)
+  {
+    bytes_read += len;
+    if (!forecast_parser.feed(chunk, len))
+    {
+      break;
+    }
+  }
+  parse_stats.body_bytes = bytes_read;
+  parse_stats.peak_bytes = 0; // Parser state and chunk on the stack
+  parse_stats.stopped_early = forecast_parser.stoppedEarly();
 
+  if (!forecast_parser.succeeded())
+  {
+    LOG_ERRORF("Weather response not parsed: %s\n", forecast_parser.getError());
+    return false;
+  }
   return true;
 }
 
+void WeatherAPI::setParser(int parser)
+{
+  this->parser = parser;
+}
+
+int WeatherAPI::getParser() const
+{
+  return parser;
+}
+
+const char *WeatherAPI::getParserName(int parser)
+{
+  return parser == WEATHER_PARSER_SCHEMA ? "schema" : "ArduinoJson";
+}
+
 String WeatherAPI::getTemperatureString()
 {
-  if (!current_weather.valid)
+  const WeatherData &weather = snapshots.read().weather;
+  if (!weather.valid)
     return "--°";
-  return String(current_weather.temperature, 1) + current_weather.temperature_unit;
+  return String(weather.temperature, 1) + weather.temperature_unit;
 }
 
 String WeatherAPI::getHumidityString()
 {
-  if (!current_weather.valid)
+  const WeatherData &weather = snapshots.read().weather;
+  if (!weather.valid)
     return "--%";
-  return String(current_weather.humidity) + "%";
+  return String(weather.humidity) + "%";
 }
 
 bool WeatherAPI::needsUpdate()
@@ -121,12 +419,18 @@ bool WeatherAPI::needsUpdate()
 
 time_t WeatherAPI::getLastUpdateTime()
 {
-  return last_update_time;
+  return snapshots.read().fetch_time;
+}
+
+const WeatherParseStats &WeatherAPI::getParseStats() const
+{
+  return parse_stats;
 }
 
 String WeatherAPI::getAirQualityString()
 {
-  if (!current_weather.valid || current_weather.air_quality_us_epa == 0)
+  const WeatherData &weather = snapshots.read().weather;
+  if (!weather.valid || weather.air_quality_us_epa == 0)
     return "--";
-  return String(current_weather.air_quality_pm25);
+  return String(weather.air_quality_pm25);
 }
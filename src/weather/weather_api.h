@@ -10,7 +10,9 @@
 #include <lvgl.h>
 
 // Project headers
+#include "http_session.h"
 #include "secrets.h"
+#include "snapshot_buffer.h"
 
 // Weather data structure
 struct WeatherData
@@ -28,9 +30,28 @@ struct WeatherData
   bool valid;              // Data validity flag
 };
 
+// Result of a fetch as handed to the UI
+struct WeatherSnapshot
+{
+  WeatherData weather;
+  time_t fetch_time; // System time of the fetch
+  uint32_t fetches;  // Successful fetches up to this one
+};
+
+// Cost of parsing the last forecast response
+struct WeatherParseStats
+{
+  uint32_t parse_us;    // Reading and parsing the body
+  uint32_t body_bytes;  // Body bytes read
+  int32_t total_bytes;  // Content-Length, -1 if not sent
+  uint32_t peak_bytes;  // Largest heap footprint of the JSON document (0 for the schema parser)
+  bool stopped_early;   // Input ended before the hourly forecast was read
+};
+
 // WeatherAPI.com configuration
 struct WeatherAPIConfig
 {
+  String endpoint = "http://api.weatherapi.com/v1/forecast.json";
   String api_key = WEATHER_API_KEY;
   String location = WEATHER_LOCATION;
   String units = WEATHER_UNITS;
@@ -41,32 +62,69 @@ class WeatherAPI
 {
 private:
   WeatherAPIConfig weatherapi_config;
+  // Written by the fetching task only; the UI reads the published snapshots
   WeatherData current_weather;
   unsigned long last_update = 0;
   time_t last_update_time = 0;                  // System time when data was last fetched
+  uint32_t fetches = 0;
+  SnapshotBuffer<WeatherSnapshot> snapshots;
   const unsigned long update_interval = 600000; // Update every 10 minutes
+  WeatherParseStats parse_stats = {};
+  int parser; // WEATHER_PARSER_*
+  HttpSession session;
+  String request_url; // Built at construction, the same for every fetch
+
+  void buildRequestUrl();
 
   // WeatherAPI.com method - fetches current weather and today's min/max in one call
   bool fetchCurrentAndTodayWeatherAPI();
 
+  // Parse the forecast.json body straight from the HTTP stream into
+  // current_weather (`length` from Content-Length, -1 if unknown)
+  bool parseForecast(Stream &body, int length);
+
+  // Parser backends, writing the numeric fields into `out`
+  bool parseForecastJson(Stream &body, int length, WeatherData &out);
+  bool parseForecastSchema(Stream &body, int length, WeatherData &out);
+
 public:
   WeatherAPI();
 
   // Initialize weather API
   bool init();
 
-  // Fetch weather data from WeatherAPI.com
+  // Fetch weather data from WeatherAPI.com and publish it to the UI. Called
+  // from one task at a time (the fetch task, or loop() without it).
   bool fetchWeatherData();
 
-  // Get current weather data
+  // A fetch was published since the UI last took one (UI task)
+  bool hasNewWeather() const;
+
+  // Server answering the forecast.json requests instead of WeatherAPI.com
+  // (a local server in tests); closes the open connection
+  void setEndpoint(const String &endpoint);
+
+  // Connection kept between fetches, with its timing
+  HttpSession &getSession();
+
+  // Get current weather data (UI task): takes the latest published fetch,
+  // which getLastUpdateTime() and the string getters then read too
   WeatherData getCurrentWeather();
 
   // Get the time when weather data was last fetched
   time_t getLastUpdateTime();
 
-  // Check if data needs updating
+  // Check if data needs updating (fetching task)
   bool needsUpdate();
 
+  // Parse time, bytes read and JSON heap of the last fetched response
+  const WeatherParseStats &getParseStats() const;
+
+  // Backend parsing the responses (default WEATHER_PARSER)
+  void setParser(int parser);
+  int getParser() const;
+  static const char *getParserName(int parser);
+
   // Format temperature string
   String getTemperatureString();
 
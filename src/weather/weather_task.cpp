@@ -0,0 +1,132 @@
+// Own header
+#include "weather_task.h"
+#include "../config.h"
+#include "../debug.h"
+#include "trace.h"
+
+WeatherFetchTask::WeatherFetchTask(WeatherAPI &api) : api(api)
+{
+  check_interval_ms = WEATHER_CHECK_INTERVAL_MS;
+}
+
+WeatherFetchTask::~WeatherFetchTask()
+{
+  stop();
+}
+
+void WeatherFetchTask::onFetched(void (*callback)(void *arg), void *arg)
+{
+  this->callback = callback;
+  callback_arg = arg;
+}
+
+void WeatherFetchTask::setCheckInterval(uint32_t ms)
+{
+  check_interval_ms = ms;
+}
+
+bool WeatherFetchTask::start()
+{
+  running = true;
+#ifdef ESP_PLATFORM
+  ended = false;
+  if (xTaskCreatePinnedToCore(taskMain, "weather", WEATHER_TASK_STACK, this, WEATHER_TASK_PRIORITY, &task,
+                              WEATHER_TASK_CORE) != pdPASS)
+  {
+    task = nullptr;
+    running = false;
+    LOG_ERROR("Weather task not created");
+    return false;
+  }
+#else
+  thread = std::thread(taskMain, this);
+#endif
+  return true;
+}
+
+void WeatherFetchTask::stop()
+{
+  running = false;
+#ifdef ESP_PLATFORM
+  if (task != nullptr)
+  {
+    xTaskNotifyGive(task);
+    while (!ended)
+    {
+      delay(10);
+    }
+    task = nullptr;
+  }
+#else
+  if (thread.joinable())
+  {
+    requestFetch();
+    thread.join();
+  }
+#endif
+}
+
+void WeatherFetchTask::requestFetch()
+{
+#ifdef ESP_PLATFORM
+  if (task != nullptr)
+  {
+    xTaskNotifyGive(task);
+  }
+#else
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    requested = true;
+  }
+  wakeup.notify_one();
+#endif
+}
+
+bool WeatherFetchTask::wait(uint32_t timeout_ms)
+{
+#ifdef ESP_PLATFORM
+  return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) > 0;
+#else
+  std::unique_lock<std::mutex> lock(mutex);
+  wakeup.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return requested; });
+  bool was_requested = requested;
+  requested = false;
+  return was_requested;
+#endif
+}
+
+void WeatherFetchTask::taskMain(void *arg)
+{
+  static_cast<WeatherFetchTask *>(arg)->run();
+#ifdef ESP_PLATFORM
+  static_cast<WeatherFetchTask *>(arg)->ended = true;
+  vTaskDelete(nullptr);
+#endif
+}
+
+void WeatherFetchTask::run()
+{
+  bool due = true; // First fetch right away
+  while (running)
+  {
+    if (due || fetches == 0 || api.needsUpdate())
+    {
+      TRACE_SCOPE("weather_update");
+      DEBUG_LOG("Fetching weather update...");
+      if (api.fetchWeatherData())
+      {
+        fetches++;
+        if (callback != nullptr)
+        {
+          callback(callback_arg);
+        }
+      }
+      else
+      {
+        failures++;
+        LOG_ERROR("Weather fetch failed");
+      }
+    }
+    due = wait(check_interval_ms);
+  }
+}
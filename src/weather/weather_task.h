@@ -0,0 +1,76 @@
+#ifndef WEATHER_TASK_H
+#define WEATHER_TASK_H
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#include <atomic>
+
+// Project headers
+#include "weather_api.h"
+
+// Runs WeatherAPI::fetchWeatherData() on a task of its own (pinned to
+// WEATHER_TASK_CORE; a thread on the host). It fetches once at start(), then
+// whenever needsUpdate() says so, checked every WEATHER_CHECK_INTERVAL_MS, or
+// when asked. Until a fetch succeeds (WiFi down at boot) every check fetches.
+// Results reach the UI through WeatherAPI's snapshots; the callback tells the
+// UI task there is one to take.
+class WeatherFetchTask
+{
+public:
+  explicit WeatherFetchTask(WeatherAPI &api);
+  ~WeatherFetchTask();
+
+  // Called on the fetch task after each successful fetch
+  void onFetched(void (*callback)(void *arg), void *arg);
+
+  // Time between checks (default WEATHER_CHECK_INTERVAL_MS); set before start()
+  void setCheckInterval(uint32_t ms);
+
+  // Start the task; false if it could not be created
+  bool start();
+
+  // Return once the task has ended, after its current fetch
+  void stop();
+
+  // Fetch now instead of at the next check
+  void requestFetch();
+
+  // Fetches since start()
+  uint32_t getFetches() const { return fetches; }
+  uint32_t getFailures() const { return failures; }
+
+private:
+  WeatherAPI &api;
+  void (*callback)(void *arg) = nullptr;
+  void *callback_arg = nullptr;
+  uint32_t check_interval_ms;
+  std::atomic<bool> running{false};
+  std::atomic<uint32_t> fetches{0};
+  std::atomic<uint32_t> failures{0};
+#ifdef ESP_PLATFORM
+  TaskHandle_t task = nullptr;
+  std::atomic<bool> ended{false};
+#else
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool requested = false; // Guarded by mutex
+#endif
+
+  static void taskMain(void *arg);
+  void run();
+
+  // Block until a fetch is requested or `timeout_ms` passed; true if requested
+  bool wait(uint32_t timeout_ms);
+};
+
+#endif // WEATHER_TASK_H
@@ -1,5 +1,6 @@
 // Own header
 #include "wifi_setup.h"
+#include "../idle_scheduler.h"
 
 WiFiSetup::WiFiSetup()
 {
@@ -100,6 +101,15 @@ void WiFiSetup::handleReconnect()
   }
 }
 
+uint32_t WiFiSetup::msUntilRetry()
+{
+  if (isConnected())
+  {
+    return IDLE_NO_DEADLINE;
+  }
+  return idle_ms_until(last_retry, retry_interval + 1);
+}
+
 int WiFiSetup::getRSSI()
 {
   if (isConnected())
@@ -37,6 +37,9 @@ public:
   // Auto-reconnect if disconnected
   void handleReconnect();
 
+  // Milliseconds until handleReconnect() retries (IDLE_NO_DEADLINE while connected)
+  uint32_t msUntilRetry();
+
   // Get signal strength
   int getRSSI();
 